@@ -0,0 +1,138 @@
+#include "ClusteredLighting.h"
+#include "LightManager.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Times a frame of LightManager animation and ClusteredLightBinner::Bin, and checks both against plain scalar
+// versions. Needs nothing but DirectXMath.
+// ClusterBench [light count]...   defaults to 256, 1024 and 4096 lights.
+
+static std::vector<ClusterLight> RandomLights(unsigned int count, unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> pos(-20.0f, 20.0f), height(0.0f, 4.0f), range(0.5f, 3.0f), unit(0.0f, 1.0f);
+	std::vector<ClusterLight> lights(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		ClusterLight& l = lights[i];
+		l.position = XMFLOAT3(pos(rng), height(rng), pos(rng));
+		l.range = range(rng);
+		l.color = XMFLOAT3(unit(rng), unit(rng), unit(rng));
+		l.direction = XMFLOAT3(0.0f, -1.0f, 0.0f);
+		l.spotCos = (i % 4 == 0) ? 0.8f : -1.0f;
+		l.pad = 0.0f;
+	}
+	return lights;
+}
+
+static bool Bench(ClusteredLightBinner& binner, unsigned int count, CXMMATRIX view, const char* name)
+{
+	std::vector<ClusterLight> lights = RandomLights(count, count);
+
+	const int runs = 200;
+	binner.Bin(lights, view);
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < runs; i++)
+		binner.Bin(lights, view);
+	auto end = std::chrono::high_resolution_clock::now();
+	double binMs = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+
+	std::vector<uint32_t> ranges, indices;
+	start = std::chrono::high_resolution_clock::now();
+	binner.BinReference(lights, view, ranges, indices);
+	end = std::chrono::high_resolution_clock::now();
+	double refMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+	bool match = ranges == binner.Ranges() && indices == binner.Indices();
+	printf("%-12s %5u lights: bin %.3f ms, reference %.2f ms, %zu light/cluster pairs, %s\n",
+		name, count, binMs, refMs, indices.size(), match ? "matches" : "MISMATCH");
+	return match;
+}
+
+// Half the lights orbit, like the swarm in the project. Animate, pack and find the dirty runs, as a frame does.
+static bool BenchManager(unsigned int count)
+{
+	std::vector<ClusterLight> start = RandomLights(count, count);
+	LightManager manager;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		LightDesc desc;
+		desc.type = (start[i].spotCos > -1.0f) ? LIGHT_SPOT : LIGHT_POINT;
+		desc.position = start[i].position;
+		desc.direction = start[i].direction;
+		desc.color = start[i].color;
+		desc.range = start[i].range;
+		desc.spotCos = start[i].spotCos;
+		desc.positionSpin = (i & 1) ? 0.0f : 0.5f / (1.0f + (i % 7));
+		manager.Add(desc);
+	}
+	manager.Pack();
+	manager.ClearDirty();
+
+	const int runs = 200;
+	const float dt = 0.016f;
+	std::vector<std::pair<uint32_t, uint32_t>> dirtyRuns;
+	size_t dirtyLights = 0;
+	auto begin = std::chrono::high_resolution_clock::now();
+	for (int f = 0; f < runs; f++)
+	{
+		manager.Animate(dt);
+		manager.Pack();
+		manager.DirtyRuns(dirtyRuns);
+		dirtyLights = manager.DirtyCount();
+		manager.ClearDirty();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	double ms = std::chrono::duration<double, std::milli>(end - begin).count() / runs;
+
+	// Same orbit one light at a time, the SIMD sine and cosine are only approximations so allow a little drift.
+	float worst = 0.0f;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float spin = (i & 1) ? 0.0f : 0.5f / (1.0f + (i % 7));
+		float x = start[i].position.x, z = start[i].position.z;
+		for (int f = 0; f < runs; f++)
+		{
+			float s = sinf(spin * dt), c = cosf(spin * dt);
+			float nx = x * c + z * s;
+			z = z * c - x * s;
+			x = nx;
+		}
+		const ClusterLight& l = manager.Packed()[i];
+		worst = fmaxf(worst, fmaxf(fabsf(l.position.x - x), fabsf(l.position.z - z)));
+	}
+
+	bool match = worst < 1e-3f && dirtyLights == (count + 1) / 2;
+	printf("lights       %5u lights: animate + pack %.3f ms, %zu lights dirty in %zu runs, drift %g, %s\n",
+		count, ms, dirtyLights, dirtyRuns.size(), worst, match ? "matches" : "MISMATCH");
+	return match;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<unsigned int> counts;
+	for (int i = 1; i < argc; i++)
+		counts.push_back((unsigned int)atoi(argv[i]));
+	if (counts.empty())
+		counts = { 256, 1024, 4096 };
+
+	float nearP = 0.01f, farP = 100.0f;
+	XMMATRIX view = XMMatrixTranslation(0.0f, -2.0f, 15.0f);
+	XMMATRIX perspective = XMMatrixPerspectiveFovLH(XM_PIDIV2, 800.0f / 600.0f, nearP, farP);
+	XMMATRIX ortho = XMMatrixOrthographicLH(8, 8, nearP, farP);
+
+	bool ok = true;
+	ClusteredLightBinner binner;
+	for (unsigned int count : counts)
+	{
+		ok &= BenchManager(count);
+		binner.Configure(perspective, nearP, farP);
+		ok &= Bench(binner, count, view, "perspective");
+		binner.Configure(ortho, nearP, farP);
+		ok &= Bench(binner, count, view, "orthographic");
+	}
+	return ok ? 0 : 1;
+}
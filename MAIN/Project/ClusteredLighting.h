@@ -0,0 +1,324 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+
+// A point or spot light the way the pixel shader reads it, three float4s per light (see ClusteredLighting in shaders.fx).
+struct ClusterLight
+{
+	XMFLOAT3 position;	// World space
+	float range;		// Falls off to nothing here, also the radius the light is binned with
+	XMFLOAT3 color;
+	float spotCos;		// Cosine of the cone's half angle, -1 for a point light
+	XMFLOAT3 direction;	// Where a spot light points, world space and normalized
+	float pad;
+};
+
+// What the pixel shader needs to find its cluster, matches ClusterBuffer in shaders.fx.
+struct ClusterConstants
+{
+	XMFLOAT4 scale;		// Tiles in x and y, then the slice scale and bias for log(view z)
+	uint32_t dims[4];	// Tiles in x, y, slices in z, light count
+};
+
+// Cuts a view's frustum into tiles on screen and exponential slices in depth (froxels), then bins lights into them
+// so each pixel only loops over the lights that can reach its cluster.
+// Works on any projection with the usual zeros in it (perspective or orthographic), no device needed.
+class ClusteredLightBinner
+{
+	unsigned int gx = 0, gy = 0, gz = 0;
+	unsigned int rowStride = 0;		// gx rounded up to a SIMD width, the padding clusters are empty boxes
+	float nearZ = 0, farZ = 0;
+	float sliceScale = 0, sliceBias = 0;
+	XMFLOAT4X4 proj;
+
+	// View space cluster bounds, structure of arrays indexed (z * gy + y) * rowStride + x.
+	std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+	// Union of each row of tiles in a slice, so whole rows a light misses are skipped.
+	std::vector<float> rowMin, rowMax;	// xyz per (z * gy + y)
+
+	// Lights moved to view space, structure of arrays padded to a multiple of four.
+	std::vector<float> lx, ly, lz, lr;
+	unsigned int lightCount = 0;
+
+	// Output, ranges holds offset and count per cluster (gx * gy * gz of them, no padding) into indices.
+	std::vector<uint32_t> ranges;
+	std::vector<uint32_t> indices;
+	std::vector<uint32_t> pairs;	// cluster, light as they're found, before sorting by cluster
+
+	static unsigned int Padded(unsigned int n) { return (n + 3) & ~3u; }
+
+	// View space point on the screen at ndc (nx, ny) and view depth z.
+	XMFLOAT3 Unproject(float nx, float ny, float z) const
+	{
+		float w = z * proj.m[2][3] + proj.m[3][3];
+		return XMFLOAT3((nx * w - z * proj.m[2][0] - proj.m[3][0]) / proj.m[0][0],
+			(ny * w - z * proj.m[2][1] - proj.m[3][1]) / proj.m[1][1], z);
+	}
+
+	void BuildClusters()
+	{
+		// Padding clusters keep an inside out box no sphere can reach.
+		const float big = 1e30f;
+		unsigned int count = rowStride * gy * gz;
+		minX.assign(count, big); minY.assign(count, big); minZ.assign(count, big);
+		maxX.assign(count, -big); maxY.assign(count, -big); maxZ.assign(count, -big);
+		rowMin.assign(gy * gz * 3, big);
+		rowMax.assign(gy * gz * 3, -big);
+
+		for (unsigned int z = 0; z < gz; z++)
+		{
+			float depth[2] = { SliceDepth(z), SliceDepth(z + 1) };
+			for (unsigned int y = 0; y < gy; y++)
+			{
+				// Screen y goes down, ndc y goes up.
+				float ny[2] = { 1.0f - 2.0f * (y + 1) / gy, 1.0f - 2.0f * y / gy };
+				unsigned int row = z * gy + y;
+				for (unsigned int x = 0; x < gx; x++)
+				{
+					float nx[2] = { -1.0f + 2.0f * x / gx, -1.0f + 2.0f * (x + 1) / gx };
+					unsigned int c = row * rowStride + x;
+					for (int corner = 0; corner < 8; corner++)
+					{
+						XMFLOAT3 p = Unproject(nx[corner & 1], ny[(corner >> 1) & 1], depth[corner >> 2]);
+						minX[c] = fminf(minX[c], p.x); maxX[c] = fmaxf(maxX[c], p.x);
+						minY[c] = fminf(minY[c], p.y); maxY[c] = fmaxf(maxY[c], p.y);
+						minZ[c] = fminf(minZ[c], p.z); maxZ[c] = fmaxf(maxZ[c], p.z);
+					}
+					rowMin[row * 3 + 0] = fminf(rowMin[row * 3 + 0], minX[c]); rowMax[row * 3 + 0] = fmaxf(rowMax[row * 3 + 0], maxX[c]);
+					rowMin[row * 3 + 1] = fminf(rowMin[row * 3 + 1], minY[c]); rowMax[row * 3 + 1] = fmaxf(rowMax[row * 3 + 1], maxY[c]);
+					rowMin[row * 3 + 2] = fminf(rowMin[row * 3 + 2], minZ[c]); rowMax[row * 3 + 2] = fmaxf(rowMax[row * 3 + 2], maxZ[c]);
+				}
+			}
+		}
+	}
+
+	// Squared distance from the light to the box, the same sums in the same order as the SIMD path.
+	static bool SphereTouchesBox(float cx, float cy, float cz, float r,
+		float x0, float y0, float z0, float x1, float y1, float z1)
+	{
+		float dx = fmaxf(fmaxf(x0 - cx, cx - x1), 0.0f);
+		float dy = fmaxf(fmaxf(y0 - cy, cy - y1), 0.0f);
+		float dz = fmaxf(fmaxf(z0 - cz, cz - z1), 0.0f);
+		float d = dx * dx;
+		d = dy * dy + d;
+		d = dz * dz + d;
+		return d <= r * r;
+	}
+
+	// Light position times view, written out so the reference matches the SIMD transform exactly.
+	static void ToView(const XMFLOAT4X4& v, const XMFLOAT3& p, float& x, float& y, float& z)
+	{
+		x = p.z * v.m[2][0] + v.m[3][0]; x = p.y * v.m[1][0] + x; x = p.x * v.m[0][0] + x;
+		y = p.z * v.m[2][1] + v.m[3][1]; y = p.y * v.m[1][1] + y; y = p.x * v.m[0][1] + y;
+		z = p.z * v.m[2][2] + v.m[3][2]; z = p.y * v.m[1][2] + z; z = p.x * v.m[0][2] + z;
+	}
+
+	// Four lights at a time into view space.
+	void TransformLights(const std::vector<ClusterLight>& lights, const XMFLOAT4X4& v)
+	{
+		lightCount = (unsigned int)lights.size();
+		unsigned int size = Padded(lightCount);
+		lx.resize(size); ly.resize(size); lz.resize(size); lr.resize(size);
+
+		XMVECTOR m[4][3];
+		for (int r = 0; r < 4; r++)
+			for (int c = 0; c < 3; c++)
+				m[r][c] = XMVectorReplicate(v.m[r][c]);
+
+		for (unsigned int i = 0; i < size; i += 4)
+		{
+			const ClusterLight* l[4];
+			for (unsigned int k = 0; k < 4; k++)
+				l[k] = &lights[(i + k < lightCount) ? i + k : lightCount - 1];
+			XMVECTOR px = XMVectorSet(l[0]->position.x, l[1]->position.x, l[2]->position.x, l[3]->position.x);
+			XMVECTOR py = XMVectorSet(l[0]->position.y, l[1]->position.y, l[2]->position.y, l[3]->position.y);
+			XMVECTOR pz = XMVectorSet(l[0]->position.z, l[1]->position.z, l[2]->position.z, l[3]->position.z);
+			XMVECTOR out[3];
+			for (int c = 0; c < 3; c++)
+			{
+				out[c] = XMVectorMultiplyAdd(pz, m[2][c], m[3][c]);
+				out[c] = XMVectorMultiplyAdd(py, m[1][c], out[c]);
+				out[c] = XMVectorMultiplyAdd(px, m[0][c], out[c]);
+			}
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&lx[i]), out[0]);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&ly[i]), out[1]);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&lz[i]), out[2]);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&lr[i]), XMVectorSet(l[0]->range, l[1]->range, l[2]->range, l[3]->range));
+		}
+	}
+
+	// Slice holding view depth z, same formula as the pixel shader.
+	int SliceOf(float z) const
+	{
+		return (int)floorf(logf(z) * sliceScale + sliceBias);
+	}
+
+	// One light against four clusters of a row, true in the lanes it touches.
+	static XMVECTOR TouchesFour(FXMVECTOR cx, FXMVECTOR cy, FXMVECTOR cz, GXMVECTOR rr, const float* x0, const float* y0, const float* z0,
+		const float* x1, const float* y1, const float* z1)
+	{
+		XMVECTOR zero = XMVectorZero();
+		XMVECTOR dx = XMVectorMax(XMVectorMax(XMVectorSubtract(XMLoadFloat4((const XMFLOAT4*)x0), cx), XMVectorSubtract(cx, XMLoadFloat4((const XMFLOAT4*)x1))), zero);
+		XMVECTOR dy = XMVectorMax(XMVectorMax(XMVectorSubtract(XMLoadFloat4((const XMFLOAT4*)y0), cy), XMVectorSubtract(cy, XMLoadFloat4((const XMFLOAT4*)y1))), zero);
+		XMVECTOR dz = XMVectorMax(XMVectorMax(XMVectorSubtract(XMLoadFloat4((const XMFLOAT4*)z0), cz), XMVectorSubtract(cz, XMLoadFloat4((const XMFLOAT4*)z1))), zero);
+		XMVECTOR d = XMVectorMultiply(dx, dx);
+		d = XMVectorMultiplyAdd(dy, dy, d);
+		d = XMVectorMultiplyAdd(dz, dz, d);
+		return XMVectorLessOrEqual(d, rr);
+	}
+
+	// Offsets from the per cluster counts, then lights into their cluster's run. Pairs come light by light,
+	// so every cluster's list ends up in light order.
+	void Compact()
+	{
+		unsigned int clusters = gx * gy * gz;
+		ranges.assign(clusters * 2, 0);
+		for (size_t p = 0; p < pairs.size(); p += 2)
+			ranges[pairs[p] * 2 + 1]++;
+		uint32_t offset = 0;
+		for (unsigned int c = 0; c < clusters; c++)
+		{
+			ranges[c * 2] = offset;
+			offset += ranges[c * 2 + 1];
+			ranges[c * 2 + 1] = 0;
+		}
+		indices.resize(offset);
+		for (size_t p = 0; p < pairs.size(); p += 2)
+		{
+			uint32_t* range = &ranges[pairs[p] * 2];
+			indices[range[0] + range[1]++] = pairs[p + 1];
+		}
+	}
+
+public:
+	// Tiles across the screen and slices between the near and far planes. Only rebuilds the clusters when something changed.
+	// Tiles split ndc evenly, so the viewport's size and place don't matter.
+	void Configure(CXMMATRIX projection, float nearPlane, float farPlane, unsigned int tilesX = 16, unsigned int tilesY = 9, unsigned int slices = 24)
+	{
+		XMFLOAT4X4 p;
+		XMStoreFloat4x4(&p, projection);
+		if (tilesX == gx && tilesY == gy && slices == gz && nearPlane == nearZ && farPlane == farZ && memcmp(&p, &proj, sizeof(p)) == 0)
+			return;
+
+		proj = p;
+		gx = tilesX; gy = tilesY; gz = slices;
+		rowStride = Padded(gx);
+		nearZ = nearPlane; farZ = farPlane;
+		// slice = log(z / near) / log(far / near) * slices
+		sliceScale = gz / logf(farZ / nearZ);
+		sliceBias = -logf(nearZ) * sliceScale;
+		BuildClusters();
+	}
+
+	float SliceDepth(unsigned int slice) const
+	{
+		return nearZ * powf(farZ / nearZ, (float)slice / gz);
+	}
+
+	// Bins every light into the clusters its sphere touches. Spot lights use their whole range sphere.
+	void Bin(const std::vector<ClusterLight>& lights, CXMMATRIX view)
+	{
+		pairs.clear();
+		if (lights.empty())
+		{
+			lightCount = 0;
+			Compact();
+			return;
+		}
+
+		XMFLOAT4X4 v;
+		XMStoreFloat4x4(&v, view);
+		TransformLights(lights, v);
+
+		for (unsigned int i = 0; i < lightCount; i++)
+		{
+			float cx = lx[i], cy = ly[i], cz = lz[i], r = lr[i];
+			if (cz + r < nearZ || cz - r > farZ)
+				continue;
+			// One slice of slack either way for log's rounding, the exact test below sorts it out.
+			int z0 = SliceOf(fminf(fmaxf(cz - r, nearZ), farZ)) - 1, z1 = SliceOf(fmaxf(fminf(cz + r, farZ), nearZ)) + 1;
+			z0 = z0 < 0 ? 0 : z0;
+			z1 = z1 >= (int)gz ? (int)gz - 1 : z1;
+
+			XMVECTOR vx = XMVectorReplicate(cx), vy = XMVectorReplicate(cy), vz = XMVectorReplicate(cz);
+			XMVECTOR rr = XMVectorReplicate(r * r);
+			for (int z = z0; z <= z1; z++)
+			{
+				// Every cluster in a slice has the same depth range, the row and cluster tests can only add to this.
+				unsigned int first = z * gy * 3;
+				float dz = fmaxf(fmaxf(rowMin[first + 2] - cz, cz - rowMax[first + 2]), 0.0f);
+				if (dz * dz > r * r)
+					continue;
+
+				for (unsigned int y = 0; y < gy; y++)
+				{
+					unsigned int row = z * gy + y;
+					if (!SphereTouchesBox(cx, cy, cz, r, rowMin[row * 3], rowMin[row * 3 + 1], rowMin[row * 3 + 2],
+						rowMax[row * 3], rowMax[row * 3 + 1], rowMax[row * 3 + 2]))
+						continue;
+
+					unsigned int base = row * rowStride;
+					for (unsigned int x = 0; x < gx; x += 4)
+					{
+						unsigned int c = base + x;
+						uint32_t mask[4];
+						XMStoreInt4(mask, TouchesFour(vx, vy, vz, rr, &minX[c], &minY[c], &minZ[c], &maxX[c], &maxY[c], &maxZ[c]));
+						for (unsigned int k = 0; k < 4 && x + k < gx; k++)
+						{
+							if (mask[k])
+							{
+								pairs.push_back(row * gx + x + k);
+								pairs.push_back(i);
+							}
+						}
+					}
+				}
+			}
+		}
+		Compact();
+	}
+
+	// Every light against every cluster, one at a time. Slow on purpose, it's what Bin has to agree with.
+	void BinReference(const std::vector<ClusterLight>& lights, CXMMATRIX view, std::vector<uint32_t>& outRanges, std::vector<uint32_t>& outIndices) const
+	{
+		XMFLOAT4X4 v;
+		XMStoreFloat4x4(&v, view);
+		std::vector<float> x(lights.size()), y(lights.size()), z(lights.size());
+		for (size_t i = 0; i < lights.size(); i++)
+			ToView(v, lights[i].position, x[i], y[i], z[i]);
+
+		outRanges.assign(gx * gy * gz * 2, 0);
+		outIndices.clear();
+		for (unsigned int row = 0; row < gy * gz; row++)
+		{
+			for (unsigned int col = 0; col < gx; col++)
+			{
+				unsigned int c = row * rowStride + col, cluster = row * gx + col;
+				outRanges[cluster * 2] = (uint32_t)outIndices.size();
+				for (size_t i = 0; i < lights.size(); i++)
+				{
+					if (SphereTouchesBox(x[i], y[i], z[i], lights[i].range, minX[c], minY[c], minZ[c], maxX[c], maxY[c], maxZ[c]))
+						outIndices.push_back((uint32_t)i);
+				}
+				outRanges[cluster * 2 + 1] = (uint32_t)outIndices.size() - outRanges[cluster * 2];
+			}
+		}
+	}
+
+	ClusterConstants Constants() const
+	{
+		ClusterConstants cc;
+		cc.scale = XMFLOAT4((float)gx, (float)gy, sliceScale, sliceBias);
+		cc.dims[0] = gx; cc.dims[1] = gy; cc.dims[2] = gz; cc.dims[3] = lightCount;
+		return cc;
+	}
+
+	const std::vector<uint32_t>& Ranges() const { return ranges; }
+	const std::vector<uint32_t>& Indices() const { return indices; }
+	unsigned int ClusterCount() const { return gx * gy * gz; }
+};
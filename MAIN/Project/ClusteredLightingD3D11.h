@@ -0,0 +1,133 @@
+#pragma once
+#include "defines.h"
+#include "ClusteredLighting.h"
+#include <wrl/client.h>
+
+// GPU copies of the lights and the binner's output. Typed buffers rather than structured ones so the ps_4_0
+// permutations can read them. Everything grows by doubling, nothing is recreated per frame.
+// The binner output is rewritten every view so it's dynamic, the lights only get their changed runs copied in.
+class D3D11ClusterBuffers
+{
+	struct DynamicBuffer
+	{
+		Microsoft::WRL::ComPtr<ID3D11Buffer>				buffer = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	srv = nullptr;
+		UINT												capacity = 0;	// Elements
+	};
+
+	DynamicBuffer										lights, ranges, indices;	// lights is the only default usage one
+	Microsoft::WRL::ComPtr<ID3D11Buffer>				constants = nullptr;
+
+	// Makes sure there's room for count elements, then copies them in.
+	static bool Upload(ID3D11Device* dev, ID3D11DeviceContext* con, DynamicBuffer& b, const void* data, UINT count, DXGI_FORMAT format, UINT elementSize)
+	{
+		if (count > b.capacity || b.buffer == nullptr)
+		{
+			UINT capacity = b.capacity ? b.capacity : 64;
+			while (capacity < count)
+				capacity *= 2;
+
+			D3D11_BUFFER_DESC bd = {};
+			bd.Usage = D3D11_USAGE_DYNAMIC;
+			bd.ByteWidth = capacity * elementSize;
+			bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+			bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			b.buffer.Reset();
+			b.srv.Reset();
+			if (FAILED(dev->CreateBuffer(&bd, nullptr, b.buffer.GetAddressOf())))
+				return false;
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC sd = {};
+			sd.Format = format;
+			sd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+			sd.Buffer.FirstElement = 0;
+			sd.Buffer.NumElements = capacity;
+			if (FAILED(dev->CreateShaderResourceView(b.buffer.Get(), &sd, b.srv.GetAddressOf())))
+				return false;
+			b.capacity = capacity;
+		}
+
+		if (count == 0)
+			return true;
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		if (FAILED(con->Map(b.buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+			return false;
+		memcpy(mapped.pData, data, count * elementSize);
+		con->Unmap(b.buffer.Get(), 0);
+		return true;
+	}
+
+public:
+	bool Create(ID3D11Device* dev)
+	{
+		D3D11_BUFFER_DESC bd = {};
+		bd.Usage = D3D11_USAGE_DEFAULT;
+		bd.ByteWidth = sizeof(ClusterConstants);
+		bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		return SUCCEEDED(dev->CreateBuffer(&bd, nullptr, constants.GetAddressOf()));
+	}
+
+	// Once a frame, every view reads the same world space lights. Only the (first, count) runs of list are copied,
+	// unless the buffer had to grow, then all of it is.
+	bool UploadLights(ID3D11Device* dev, ID3D11DeviceContext* con, const std::vector<ClusterLight>& list,
+		const std::vector<std::pair<uint32_t, uint32_t>>& runs)
+	{
+		static_assert(sizeof(ClusterLight) == 3 * sizeof(XMFLOAT4), "shaders.fx reads three float4s per light");
+		UINT count = (UINT)list.size() * 3;
+		if (count > lights.capacity || lights.buffer == nullptr)
+		{
+			UINT capacity = lights.capacity ? lights.capacity : 64 * 3;
+			while (capacity < count)
+				capacity *= 2;
+
+			D3D11_BUFFER_DESC bd = {};
+			bd.Usage = D3D11_USAGE_DEFAULT;
+			bd.ByteWidth = capacity * sizeof(XMFLOAT4);
+			bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+			lights.buffer.Reset();
+			lights.srv.Reset();
+			if (FAILED(dev->CreateBuffer(&bd, nullptr, lights.buffer.GetAddressOf())))
+				return false;
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC sd = {};
+			sd.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+			sd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+			sd.Buffer.FirstElement = 0;
+			sd.Buffer.NumElements = capacity;
+			if (FAILED(dev->CreateShaderResourceView(lights.buffer.Get(), &sd, lights.srv.GetAddressOf())))
+				return false;
+			lights.capacity = capacity;
+
+			if (!list.empty())
+			{
+				D3D11_BOX box = { 0, 0, 0, (UINT)(list.size() * sizeof(ClusterLight)), 1, 1 };
+				con->UpdateSubresource(lights.buffer.Get(), 0, &box, list.data(), 0, 0);
+			}
+			return true;
+		}
+
+		for (const std::pair<uint32_t, uint32_t>& run : runs)
+		{
+			D3D11_BOX box = { (UINT)(run.first * sizeof(ClusterLight)), 0, 0, (UINT)((run.first + run.second) * sizeof(ClusterLight)), 1, 1 };
+			con->UpdateSubresource(lights.buffer.Get(), 0, &box, &list[run.first], 0, 0);
+		}
+		return true;
+	}
+
+	// Once a view, after binner.Bin for that view's camera.
+	bool UploadClusters(ID3D11Device* dev, ID3D11DeviceContext* con, const ClusteredLightBinner& binner)
+	{
+		ClusterConstants cc = binner.Constants();
+		con->UpdateSubresource(constants.Get(), 0, nullptr, &cc, 0, 0);
+		return Upload(dev, con, ranges, binner.Ranges().data(), binner.ClusterCount(), DXGI_FORMAT_R32G32_UINT, 2 * sizeof(uint32_t)) &&
+			Upload(dev, con, indices, binner.Indices().data(), (UINT)binner.Indices().size(), DXGI_FORMAT_R32_UINT, sizeof(uint32_t));
+	}
+
+	// t3 - t5 and b2 for the pixel shader, see ClusterBuffer in shaders.fx.
+	void Bind(ID3D11DeviceContext* con)
+	{
+		ID3D11ShaderResourceView* const srvs[] = { lights.srv.Get(), ranges.srv.Get(), indices.srv.Get() };
+		con->PSSetShaderResources(3, ARRAYSIZE(srvs), srvs);
+		con->PSSetConstantBuffers(2, 1, constants.GetAddressOf());
+	}
+};
@@ -0,0 +1,129 @@
+#include "CommandStream.h"
+#include "Culling.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+// Records a frame of thousands of objects into CommandStreams on 1, 2, 4... threads, the way the shadow maps
+// are recorded, and plays them into NullCommandBackend in order. Every thread count has to give the exact same
+// commands as one thread. Needs nothing but DirectXMath.
+// CommandBench [object count] [objects per job]   defaults to 20000 objects, 256 per job.
+
+struct BenchObject
+{
+	XMFLOAT4X4 world;
+	CullSphere bounds;
+	PipelineId pipeline;
+};
+
+struct BenchConstants
+{
+	XMMATRIX world;
+	XMMATRIX worldViewProjection;
+};
+
+static std::vector<BenchObject> RandomObjects(unsigned int count)
+{
+	std::mt19937 rng(count);
+	std::uniform_real_distribution<float> pos(-100.0f, 100.0f), angle(0.0f, XM_2PI), scale(0.2f, 2.0f);
+	std::vector<BenchObject> objects(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		XMFLOAT3 at(pos(rng), 0.0f, pos(rng));
+		float s = scale(rng);
+		XMStoreFloat4x4(&objects[i].world, XMMatrixScaling(s, s, s) * XMMatrixRotationY(angle(rng)) * XMMatrixTranslation(at.x, at.y, at.z));
+		objects[i].bounds.center = at;
+		objects[i].bounds.radius = 1.5f * s;
+		objects[i].pipeline = (i / 64) % 4;	// Runs of objects share a pipeline, like instances of one mesh
+	}
+	return objects;
+}
+
+// Cull, then record every visible object in [first, first + count).
+static void RecordJob(const std::vector<BenchObject>& objects, const Frustum& frustum, CXMMATRIX viewProjection,
+	unsigned int first, unsigned int count, CommandStream& stream)
+{
+	PipelineId bound = PIPELINE_INVALID;
+	stream.SetViewport(0.0f, 0.0f, 800.0f, 600.0f);
+	for (unsigned int i = first; i < first + count; i++)
+	{
+		const BenchObject& o = objects[i];
+		if (!frustum.TestSphere(o.bounds))
+			continue;
+		if (o.pipeline != bound)
+		{
+			stream.SetPipeline(o.pipeline);
+			bound = o.pipeline;
+		}
+		XMMATRIX world = XMLoadFloat4x4(&o.world);
+		BenchConstants cb;
+		cb.world = XMMatrixTranspose(world);
+		cb.worldViewProjection = XMMatrixTranspose(world * viewProjection);
+		stream.SetConstants(&cb, sizeof(cb));
+		stream.DrawIndexed(2532, 1, 0, 0, 0);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int count = (argc > 1) ? (unsigned int)atoi(argv[1]) : 20000;
+	unsigned int jobSize = (argc > 2) ? (unsigned int)atoi(argv[2]) : 256;
+	if (jobSize == 0)
+		jobSize = 256;
+
+	std::vector<BenchObject> objects = RandomObjects(count);
+	XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 20.0f, -60.0f, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, 800.0f / 600.0f, 0.1f, 500.0f);
+	XMMATRIX viewProjection = view * projection;
+	Frustum frustum = Frustum::FromViewProjection(view, projection);
+	unsigned int jobs = (count + jobSize - 1) / jobSize;
+
+	// At least up to 4 threads so the ordering gets checked on small machines too.
+	unsigned int hardware = std::thread::hardware_concurrency();
+	std::vector<unsigned int> threadCounts;
+	for (unsigned int t = 1; t < std::max(hardware, 5u); t *= 2)
+		threadCounts.push_back(t);
+	if (hardware > threadCounts.back())
+		threadCounts.push_back(hardware);
+
+	bool ok = true;
+	uint64_t expected = 0;
+	double oneThreadMs = 0.0;
+	std::vector<CommandStream> streams;
+	for (unsigned int threads : threadCounts)
+	{
+		const int runs = 50;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < runs; r++)
+		{
+			RecordCommands(streams, jobs, threads, [&](unsigned int job, CommandStream& stream)
+				{
+					unsigned int first = job * jobSize;
+					RecordJob(objects, frustum, viewProjection, first, std::min(jobSize, count - first), stream);
+				});
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / runs;
+
+		NullCommandBackend backend;
+		size_t bytes = 0;
+		for (unsigned int j = 0; j < jobs; j++)
+		{
+			ReplayCommands(streams[j], backend);
+			bytes += streams[j].Bytes();
+		}
+		if (threads == 1)
+		{
+			expected = backend.hash;
+			oneThreadMs = ms;
+		}
+		bool match = backend.hash == expected;
+		ok &= match;
+		printf("%2u threads  %u objects in %u jobs: record %.3f ms (%.2fx), %u draws, %u commands, %.1f KB, %s\n",
+			threads, count, jobs, ms, oneThreadMs / ms, backend.draws, backend.commands, bytes / 1024.0, match ? "matches" : "MISMATCH");
+	}
+	return ok ? 0 : 1;
+}
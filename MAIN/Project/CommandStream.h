@@ -0,0 +1,175 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "ParallelFor.h"
+#include "PipelineState.h"
+
+// What a recorded command does, see CommandStream.
+enum CommandType : uint32_t
+{
+	CMD_PIPELINE,		// A PipelineId from the frame's PipelineCache
+	CMD_VIEWPORT,		// x, y, width, height
+	CMD_CONSTANTS,		// Bytes for the constant buffer the backend writes into
+	CMD_DRAW_INDEXED,	// DrawIndexedArgs
+};
+
+struct DrawIndexedArgs
+{
+	uint32_t indexCount;
+	uint32_t instanceCount;
+	uint32_t startIndex;
+	int32_t baseVertex;
+	uint32_t startInstance;
+};
+
+// Draw commands recorded without touching any graphics API, so any thread can fill one. Each command is its type
+// followed by its arguments, packed into words back to back; constants are copied in, padded to whole words.
+class CommandStream
+{
+	std::vector<uint32_t> words;
+	unsigned int draws = 0;
+
+	void Push(const void* data, uint32_t bytes)
+	{
+		size_t at = words.size();
+		words.resize(at + (bytes + 3) / 4, 0);
+		memcpy(&words[at], data, bytes);
+	}
+
+public:
+	// Keeps the memory, streams are refilled every frame.
+	void Clear()
+	{
+		words.clear();
+		draws = 0;
+	}
+
+	void SetPipeline(PipelineId id)
+	{
+		words.push_back(CMD_PIPELINE);
+		words.push_back(id);
+	}
+
+	void SetViewport(float x, float y, float width, float height)
+	{
+		const float rect[4] = { x, y, width, height };
+		words.push_back(CMD_VIEWPORT);
+		Push(rect, sizeof(rect));
+	}
+
+	void SetConstants(const void* data, uint32_t bytes)
+	{
+		words.push_back(CMD_CONSTANTS);
+		words.push_back(bytes);
+		Push(data, bytes);
+	}
+
+	void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+	{
+		const DrawIndexedArgs args = { indexCount, instanceCount, startIndex, baseVertex, startInstance };
+		words.push_back(CMD_DRAW_INDEXED);
+		Push(&args, sizeof(args));
+		draws++;
+	}
+
+	bool Empty() const { return words.empty(); }
+	unsigned int Draws() const { return draws; }
+	size_t Bytes() const { return words.size() * sizeof(uint32_t); }
+	const std::vector<uint32_t>& Words() const { return words; }
+};
+
+// Where a stream's commands end up: a D3D11 context (CommandStreamD3D11.h), or nowhere for testing.
+class CommandBackend
+{
+public:
+	virtual ~CommandBackend() {}
+	virtual void SetPipeline(PipelineId id) = 0;
+	virtual void SetViewport(const float rect[4]) = 0;
+	virtual void SetConstants(const void* data, uint32_t bytes) = 0;
+	virtual void DrawIndexed(const DrawIndexedArgs& args) = 0;
+};
+
+// Plays the stream's commands into backend in the order they were recorded.
+inline void ReplayCommands(const CommandStream& stream, CommandBackend& backend)
+{
+	const std::vector<uint32_t>& words = stream.Words();
+	size_t at = 0;
+	while (at < words.size())
+	{
+		switch (words[at++])
+		{
+		case CMD_PIPELINE:
+			backend.SetPipeline(words[at++]);
+			break;
+		case CMD_VIEWPORT:
+		{
+			float rect[4];
+			memcpy(rect, &words[at], sizeof(rect));
+			backend.SetViewport(rect);
+			at += 4;
+			break;
+		}
+		case CMD_CONSTANTS:
+		{
+			uint32_t bytes = words[at++];
+			backend.SetConstants(&words[at], bytes);
+			at += (bytes + 3) / 4;
+			break;
+		}
+		case CMD_DRAW_INDEXED:
+		{
+			DrawIndexedArgs args;
+			memcpy(&args, &words[at], sizeof(args));
+			backend.DrawIndexed(args);
+			at += (sizeof(args) + 3) / 4;
+			break;
+		}
+		default:
+			return;		// Can't tell where the next command starts
+		}
+	}
+}
+
+// Draws nothing, just counts and hashes every command in order, so two recordings can be compared without a GPU.
+class NullCommandBackend : public CommandBackend
+{
+public:
+	uint64_t hash = 14695981039346656037ull;	// HashBytes of nothing
+	unsigned int commands = 0;
+	unsigned int draws = 0;
+	unsigned int triangles = 0;		// Assuming triangle lists
+
+	void SetPipeline(PipelineId id) override { Add(CMD_PIPELINE, &id, sizeof(id)); }
+	void SetViewport(const float rect[4]) override { Add(CMD_VIEWPORT, rect, 4 * sizeof(float)); }
+	void SetConstants(const void* data, uint32_t bytes) override { Add(CMD_CONSTANTS, data, bytes); }
+	void DrawIndexed(const DrawIndexedArgs& args) override
+	{
+		Add(CMD_DRAW_INDEXED, &args, sizeof(args));
+		draws++;
+		triangles += args.indexCount / 3 * args.instanceCount;
+	}
+
+private:
+	void Add(CommandType type, const void* data, size_t bytes)
+	{
+		hash = HashBytes(&type, sizeof(type), hash);
+		hash = HashBytes(data, bytes, hash);
+		commands++;
+	}
+};
+
+// Fills streams[0, jobs) on threads workers (0 is every hardware thread), record(job, stream) for each job into
+// a stream of its own. Jobs must only read shared state; anything like a PipelineCache lookup that adds to it
+// has to happen before. Running the streams in order afterwards gives the same result as recording on one thread.
+template <typename Fn>
+void RecordCommands(std::vector<CommandStream>& streams, unsigned int jobs, unsigned int threads, Fn record)
+{
+	if (streams.size() < jobs)
+		streams.resize(jobs);
+	ParallelFor(threads, jobs, 1, [&](unsigned int job)
+		{
+			streams[job].Clear();
+			record(job, streams[job]);
+		});
+}
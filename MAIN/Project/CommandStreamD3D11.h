@@ -0,0 +1,121 @@
+#pragma once
+#include "defines.h"
+#include "CommandStream.h"
+#include "PipelineStateD3D11.h"
+#include <algorithm>
+#include <wrl/client.h>
+
+// Plays streams onto a D3D11 context, immediate or deferred. Pipelines are looked up in cache, which mustn't
+// grow while other threads are replaying, and constants all go into one constant buffer.
+class D3D11CommandBackend : public CommandBackend
+{
+	ID3D11DeviceContext* con = nullptr;
+	const PipelineCache* cache = nullptr;
+	ID3D11Buffer* constants = nullptr;
+	PipelineStateTracker state;
+
+public:
+	void Begin(ID3D11DeviceContext* context, const PipelineCache& pipelines, ID3D11Buffer* constantBuffer)
+	{
+		con = context;
+		cache = &pipelines;
+		constants = constantBuffer;
+		state.Invalidate();
+	}
+
+	void SetPipeline(PipelineId id) override
+	{
+		ApplyPipeline(con, cache->Desc(id), state.Bind(*cache, id));
+	}
+
+	void SetViewport(const float rect[4]) override
+	{
+		D3D11_VIEWPORT viewport = { rect[0], rect[1], rect[2], rect[3], 0.0f, 1.0f };
+		con->RSSetViewports(1, &viewport);
+	}
+
+	void SetConstants(const void* data, uint32_t bytes) override
+	{
+		con->UpdateSubresource(constants, 0, nullptr, data, 0, 0);
+	}
+
+	void DrawIndexed(const DrawIndexedArgs& args) override
+	{
+		con->DrawIndexedInstanced(args.indexCount, args.instanceCount, args.startIndex, args.baseVertex, args.startInstance);
+	}
+};
+
+// Turns streams into command lists on worker threads, one deferred context and one list per worker, each worker
+// taking a contiguous range of the streams; the lists then run in worker order on the immediate context, which keeps
+// the streams' order. Deferred contexts start out with nothing bound, so setup(con) binds whatever the streams take
+// for granted (targets, vertex buffers, constant buffer slots) at the top of every list. With parallel off, fewer
+// than minDraws draws, or no deferred contexts on the device, the streams play straight onto the immediate context.
+class D3D11CommandLists
+{
+	std::vector<Microsoft::WRL::ComPtr<ID3D11DeviceContext>>	deferred;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11CommandList>>		lists;
+	std::vector<D3D11CommandBackend>							backends;
+	bool														unsupported = false;
+
+	bool Reserve(ID3D11Device* dev, unsigned int count)
+	{
+		while (!unsupported && deferred.size() < count)
+		{
+			Microsoft::WRL::ComPtr<ID3D11DeviceContext> con;
+			if (FAILED(dev->CreateDeferredContext(0, con.GetAddressOf())))
+				unsupported = true;		// e.g. a single threaded device
+			else
+				deferred.push_back(con);
+		}
+		lists.resize(deferred.size());
+		backends.resize(deferred.size());
+		return !unsupported;
+	}
+
+public:
+	bool parallel = true;
+	unsigned int minDraws = 256;	// A list costs more to make and run than this many draws on the immediate context
+
+	// Runs streams[0, count) on threads workers (0 is every hardware thread). The immediate context's state is put
+	// back afterwards.
+	template <typename Setup>
+	void Execute(ID3D11Device* dev, ID3D11DeviceContext* immediate, const std::vector<CommandStream>& streams, unsigned int count,
+		const PipelineCache& cache, ID3D11Buffer* constantBuffer, unsigned int threads, Setup setup)
+	{
+		unsigned int draws = 0;
+		for (unsigned int i = 0; i < count; i++)
+			draws += streams[i].Draws();
+		unsigned int workers = threads ? threads : std::thread::hardware_concurrency();
+		workers = std::max(1u, std::min(workers, count));
+
+		if (!parallel || workers < 2 || draws < minDraws || !Reserve(dev, workers))
+		{
+			D3D11CommandBackend backend;
+			backend.Begin(immediate, cache, constantBuffer);
+			setup(immediate);
+			for (unsigned int i = 0; i < count; i++)
+				ReplayCommands(streams[i], backend);
+			return;
+		}
+
+		ParallelFor(workers, workers, 1, [&](unsigned int w)
+			{
+				unsigned int first = count * w / workers, last = count * (w + 1) / workers;
+				ID3D11DeviceContext* con = deferred[w].Get();
+				setup(con);
+				backends[w].Begin(con, cache, constantBuffer);
+				for (unsigned int i = first; i < last; i++)
+					ReplayCommands(streams[i], backends[w]);
+				lists[w].Reset();
+				con->FinishCommandList(FALSE, lists[w].GetAddressOf());
+			});
+
+		for (unsigned int w = 0; w < workers; w++)
+		{
+			if (lists[w] != nullptr)
+				immediate->ExecuteCommandList(lists[w].Get(), TRUE);
+		}
+	}
+
+	bool Supported() const { return !unsupported; }
+};
@@ -0,0 +1,137 @@
+#include "Culling.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Times FrustumCuller on 100k+ spheres and boxes against a perspective and an orthographic frustum, and checks
+// every result against the one at a time Frustum::TestSphere/TestAABB, including counts that leave the last
+// batch of eight partly padding. Needs nothing but DirectXMath.
+// CullBench [object count]   defaults to 100003, so the last batch is three objects and five padding lanes.
+
+// Objects are scattered around the origin, which both frustums see, so a padding lane wrongly reported as visible shows up.
+static void Fill(FrustumCuller& culler, std::vector<CullSphere>& spheres, std::vector<CullAABB>& boxes, unsigned int count)
+{
+	std::mt19937 rng(count);
+	std::uniform_real_distribution<float> pos(-150.0f, 150.0f), size(0.1f, 4.0f);
+	culler.Clear();
+	spheres.resize(count);
+	boxes.resize(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		spheres[i].center = XMFLOAT3(pos(rng), 0.2f * pos(rng), pos(rng));
+		spheres[i].radius = size(rng);
+		boxes[i].center = XMFLOAT3(pos(rng), 0.2f * pos(rng), pos(rng));
+		boxes[i].extents = XMFLOAT3(size(rng), size(rng), size(rng));
+		culler.AddSphere(spheres[i]);
+		culler.AddAABB(boxes[i]);
+	}
+}
+
+// test(i, margin) is the scalar answer with the object grown by margin. The SIMD path adds the plane terms in a
+// different order, so an object touching a plane to within rounding may go either way; that isn't a mismatch.
+template <typename Test>
+static bool Matches(const std::vector<unsigned int>& visible, unsigned int count, Test test)
+{
+	const float rounding = 1e-3f;
+	size_t at = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		bool expected = test(i, 0.0f);
+		bool reported = at < visible.size() && visible[at] == i;
+		if (expected != reported && test(i, -rounding) == test(i, rounding))
+			return false;
+		at += reported ? 1 : 0;
+	}
+	return at == visible.size();	// Nothing past count, so no padding lanes
+}
+
+static bool Check(const FrustumCuller& culler, const std::vector<CullSphere>& spheres, const std::vector<CullAABB>& boxes,
+	const Frustum& frustum, const char* name, bool timed)
+{
+	unsigned int count = (unsigned int)spheres.size();
+	std::vector<unsigned int> visibleSpheres, visibleBoxes;
+	culler.CullSpheres(frustum, visibleSpheres);
+	culler.CullAABBs(frustum, visibleBoxes);
+	bool sphereMatch = Matches(visibleSpheres, count, [&](unsigned int i, float margin)
+		{
+			CullSphere s = spheres[i];
+			s.radius += margin;
+			return frustum.TestSphere(s);
+		});
+	bool boxMatch = Matches(visibleBoxes, count, [&](unsigned int i, float margin)
+		{
+			CullAABB b = boxes[i];
+			b.extents = XMFLOAT3(b.extents.x + margin, b.extents.y + margin, b.extents.z + margin);
+			return frustum.TestAABB(b);
+		});
+	if (!timed)
+		return sphereMatch && boxMatch;
+
+	const int runs = 50;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < runs; r++)
+		culler.CullSpheres(frustum, visibleSpheres);
+	double soaSphereMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / runs;
+	start = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < runs; r++)
+		culler.CullAABBs(frustum, visibleBoxes);
+	double soaBoxMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / runs;
+
+	std::vector<unsigned int> scalar;
+	start = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < runs; r++)
+	{
+		scalar.clear();
+		for (unsigned int i = 0; i < count; i++)
+		{
+			if (frustum.TestSphere(spheres[i]))
+				scalar.push_back(i);
+		}
+	}
+	double scalarSphereMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / runs;
+	start = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < runs; r++)
+	{
+		scalar.clear();
+		for (unsigned int i = 0; i < count; i++)
+		{
+			if (frustum.TestAABB(boxes[i]))
+				scalar.push_back(i);
+		}
+	}
+	double scalarBoxMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / runs;
+
+	printf("%-12s %u spheres: %.3f ms (scalar %.3f ms, %.2fx), %zu visible, %s\n", name, count, soaSphereMs, scalarSphereMs,
+		scalarSphereMs / soaSphereMs, visibleSpheres.size(), sphereMatch ? "matches" : "MISMATCH");
+	printf("%-12s %u boxes:   %.3f ms (scalar %.3f ms, %.2fx), %zu visible, %s\n", name, count, soaBoxMs, scalarBoxMs,
+		scalarBoxMs / soaBoxMs, visibleBoxes.size(), boxMatch ? "matches" : "MISMATCH");
+	return sphereMatch && boxMatch;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int count = (argc > 1) ? (unsigned int)atoi(argv[1]) : 100003;
+
+	XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 20.0f, -60.0f, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	Frustum perspective = Frustum::FromViewProjection(view, XMMatrixPerspectiveFovLH(XM_PIDIV4, 800.0f / 600.0f, 0.1f, 200.0f));
+	Frustum orthographic = Frustum::FromViewProjection(view, XMMatrixOrthographicLH(120.0f, 90.0f, 0.1f, 200.0f));
+
+	FrustumCuller culler;
+	std::vector<CullSphere> spheres;
+	std::vector<CullAABB> boxes;
+	Fill(culler, spheres, boxes, count);
+	bool ok = Check(culler, spheres, boxes, perspective, "perspective", true);
+	ok &= Check(culler, spheres, boxes, orthographic, "orthographic", true);
+
+	// Every way the last batch can end, from a single lane to a full eight.
+	bool tails = true;
+	for (unsigned int small = 1; small <= 17; small++)
+	{
+		Fill(culler, spheres, boxes, small);
+		tails &= Check(culler, spheres, boxes, perspective, "", false) && Check(culler, spheres, boxes, orthographic, "", false);
+	}
+	printf("tails        1 to 17 objects: %s\n", tails ? "match" : "MISMATCH");
+	return ok && tails ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+using namespace DirectX;
+
+// Bounding sphere in world space, used for visibility tests.
+struct CullSphere
+{
+	XMFLOAT3 center;
+	float radius;
+};
+
+// Axis aligned bounding box stored as a center and half extents.
+struct CullAABB
+{
+	XMFLOAT3 center;
+	XMFLOAT3 extents;
+};
+
+// Six inward facing planes (left, right, bottom, top, near, far) of a view.
+struct Frustum
+{
+	XMFLOAT4 planes[6];
+
+	// Pulls the planes out of view * projection (Gribb/Hartmann).
+	// Works for both the perspective and orthographic projections since it only relies on clip space.
+	static Frustum FromViewProjection(FXMMATRIX view, CXMMATRIX projection)
+	{
+		// Rows of the transposed matrix are the columns of view * projection.
+		XMMATRIX m = XMMatrixTranspose(XMMatrixMultiply(view, projection));
+
+		Frustum f;
+		XMStoreFloat4(&f.planes[0], XMPlaneNormalize(XMVectorAdd(m.r[3], m.r[0])));		// Left
+		XMStoreFloat4(&f.planes[1], XMPlaneNormalize(XMVectorSubtract(m.r[3], m.r[0])));	// Right
+		XMStoreFloat4(&f.planes[2], XMPlaneNormalize(XMVectorAdd(m.r[3], m.r[1])));		// Bottom
+		XMStoreFloat4(&f.planes[3], XMPlaneNormalize(XMVectorSubtract(m.r[3], m.r[1])));	// Top
+		XMStoreFloat4(&f.planes[4], XMPlaneNormalize(m.r[2]));								// Near (D3D clip space z starts at 0)
+		XMStoreFloat4(&f.planes[5], XMPlaneNormalize(XMVectorSubtract(m.r[3], m.r[2])));	// Far
+		return f;
+	}
+
+	// Single sphere test, for the odd one-off object.
+	bool TestSphere(const CullSphere& s) const
+	{
+		XMVECTOR c = XMVectorSetW(XMLoadFloat3(&s.center), 1.0f);
+		for (int i = 0; i < 6; i++)
+		{
+			if (XMVectorGetX(XMPlaneDotCoord(XMLoadFloat4(&planes[i]), c)) < -s.radius)
+				return false;
+		}
+		return true;
+	}
+
+	// Single box test, uses the projected radius of the box onto each plane normal.
+	bool TestAABB(const CullAABB& b) const
+	{
+		XMVECTOR c = XMVectorSetW(XMLoadFloat3(&b.center), 1.0f);
+		XMVECTOR e = XMLoadFloat3(&b.extents);
+		for (int i = 0; i < 6; i++)
+		{
+			XMVECTOR p = XMLoadFloat4(&planes[i]);
+			float r = XMVectorGetX(XMVector3Dot(e, XMVectorAbs(p)));
+			if (XMVectorGetX(XMPlaneDotCoord(p, c)) < -r)
+				return false;
+		}
+		return true;
+	}
+};
+
+// Holds bounds in structure-of-arrays form so a frustum can be tested against four objects per instruction.
+// Objects are processed in batches of eight (two independent SIMD chains) and the arrays are padded to match.
+class FrustumCuller
+{
+	static const unsigned int batch = 8;
+
+	// Spheres
+	std::vector<float> sx, sy, sz, sr;
+	unsigned int sphereCount = 0;
+
+	// Boxes
+	std::vector<float> bx, by, bz, ex, ey, ez;
+	unsigned int boxCount = 0;
+
+	static unsigned int Padded(unsigned int n) { return (n + batch - 1) & ~(batch - 1); }
+
+	// Writes the indices of every lane that is not outside into the visible list.
+	static void Emit(FXMVECTOR outside, unsigned int base, unsigned int count, std::vector<unsigned int>& visible)
+	{
+		uint32_t mask[4];
+		XMStoreInt4(mask, outside);
+		for (unsigned int l = 0; l < 4 && base + l < count; l++)
+		{
+			if (mask[l] == 0)
+				visible.push_back(base + l);
+		}
+	}
+
+	// Sphere is outside if it's behind any plane by more than its radius.
+	static XMVECTOR SphereOutside(const XMVECTOR* px, const XMVECTOR* py, const XMVECTOR* pz, const XMVECTOR* pw,
+		FXMVECTOR x, FXMVECTOR y, FXMVECTOR z, GXMVECTOR r)
+	{
+		XMVECTOR negR = XMVectorNegate(r);
+		XMVECTOR outside = XMVectorFalseInt();
+		for (int p = 0; p < 6; p++)
+		{
+			XMVECTOR d = XMVectorMultiplyAdd(px[p], x, pw[p]);
+			d = XMVectorMultiplyAdd(py[p], y, d);
+			d = XMVectorMultiplyAdd(pz[p], z, d);
+			outside = XMVectorOrInt(outside, XMVectorLess(d, negR));
+		}
+		return outside;
+	}
+
+	// Box is outside if the center is behind a plane by more than the extents projected onto that plane's normal.
+	static XMVECTOR BoxOutside(const XMVECTOR* px, const XMVECTOR* py, const XMVECTOR* pz, const XMVECTOR* pw,
+		FXMVECTOR x, FXMVECTOR y, FXMVECTOR z, GXMVECTOR hx, HXMVECTOR hy, HXMVECTOR hz)
+	{
+		XMVECTOR outside = XMVectorFalseInt();
+		for (int p = 0; p < 6; p++)
+		{
+			XMVECTOR d = XMVectorMultiplyAdd(px[p], x, pw[p]);
+			d = XMVectorMultiplyAdd(py[p], y, d);
+			d = XMVectorMultiplyAdd(pz[p], z, d);
+			XMVECTOR r = XMVectorMultiply(XMVectorAbs(px[p]), hx);
+			r = XMVectorMultiplyAdd(XMVectorAbs(py[p]), hy, r);
+			r = XMVectorMultiplyAdd(XMVectorAbs(pz[p]), hz, r);
+			outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(d, r), XMVectorZero()));
+		}
+		return outside;
+	}
+
+	static XMVECTOR Load4(const std::vector<float>& v, unsigned int i)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&v[i]));
+	}
+
+	// Splat every plane component once per cull rather than once per batch.
+	static void SplatPlanes(const Frustum& f, XMVECTOR* px, XMVECTOR* py, XMVECTOR* pz, XMVECTOR* pw)
+	{
+		for (int p = 0; p < 6; p++)
+		{
+			XMVECTOR plane = XMLoadFloat4(&f.planes[p]);
+			px[p] = XMVectorSplatX(plane);
+			py[p] = XMVectorSplatY(plane);
+			pz[p] = XMVectorSplatZ(plane);
+			pw[p] = XMVectorSplatW(plane);
+		}
+	}
+
+public:
+	void Clear()
+	{
+		sphereCount = boxCount = 0;
+		sx.clear(); sy.clear(); sz.clear(); sr.clear();
+		bx.clear(); by.clear(); bz.clear(); ex.clear(); ey.clear(); ez.clear();
+	}
+
+	// Returns the index the sphere will be reported as.
+	unsigned int AddSphere(const CullSphere& s)
+	{
+		unsigned int i = sphereCount++;
+		unsigned int size = Padded(sphereCount);
+		sx.resize(size, 0.0f); sy.resize(size, 0.0f); sz.resize(size, 0.0f); sr.resize(size, 0.0f);
+		SetSphere(i, s);
+		return i;
+	}
+
+	void SetSphere(unsigned int i, const CullSphere& s)
+	{
+		sx[i] = s.center.x;
+		sy[i] = s.center.y;
+		sz[i] = s.center.z;
+		sr[i] = s.radius;
+	}
+
+	// Returns the index the box will be reported as.
+	unsigned int AddAABB(const CullAABB& b)
+	{
+		unsigned int i = boxCount++;
+		unsigned int size = Padded(boxCount);
+		bx.resize(size, 0.0f); by.resize(size, 0.0f); bz.resize(size, 0.0f);
+		ex.resize(size, 0.0f); ey.resize(size, 0.0f); ez.resize(size, 0.0f);
+		SetAABB(i, b);
+		return i;
+	}
+
+	void SetAABB(unsigned int i, const CullAABB& b)
+	{
+		bx[i] = b.center.x;
+		by[i] = b.center.y;
+		bz[i] = b.center.z;
+		ex[i] = b.extents.x;
+		ey[i] = b.extents.y;
+		ez[i] = b.extents.z;
+	}
+
+	unsigned int SphereCount() const { return sphereCount; }
+	unsigned int AABBCount() const { return boxCount; }
+
+	// Fills visible with the indices of every sphere that intersects the frustum.
+	void CullSpheres(const Frustum& f, std::vector<unsigned int>& visible) const
+	{
+		visible.clear();
+		XMVECTOR px[6], py[6], pz[6], pw[6];
+		SplatPlanes(f, px, py, pz, pw);
+
+		for (unsigned int i = 0; i < sphereCount; i += batch)
+		{
+			// Two independent chains of four so the planes' latency overlaps.
+			XMVECTOR outA = SphereOutside(px, py, pz, pw, Load4(sx, i), Load4(sy, i), Load4(sz, i), Load4(sr, i));
+			XMVECTOR outB = SphereOutside(px, py, pz, pw, Load4(sx, i + 4), Load4(sy, i + 4), Load4(sz, i + 4), Load4(sr, i + 4));
+			Emit(outA, i, sphereCount, visible);
+			Emit(outB, i + 4, sphereCount, visible);
+		}
+	}
+
+	// Fills visible with the indices of every box that intersects the frustum.
+	void CullAABBs(const Frustum& f, std::vector<unsigned int>& visible) const
+	{
+		visible.clear();
+		XMVECTOR px[6], py[6], pz[6], pw[6];
+		SplatPlanes(f, px, py, pz, pw);
+
+		for (unsigned int i = 0; i < boxCount; i += batch)
+		{
+			XMVECTOR outA = BoxOutside(px, py, pz, pw, Load4(bx, i), Load4(by, i), Load4(bz, i),
+				Load4(ex, i), Load4(ey, i), Load4(ez, i));
+			XMVECTOR outB = BoxOutside(px, py, pz, pw, Load4(bx, i + 4), Load4(by, i + 4), Load4(bz, i + 4),
+				Load4(ex, i + 4), Load4(ey, i + 4), Load4(ez, i + 4));
+			Emit(outA, i, boxCount, visible);
+			Emit(outB, i + 4, boxCount, visible);
+		}
+	}
+};
@@ -0,0 +1,156 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cfloat>
+#include <vector>
+
+using namespace DirectX;
+
+// Overdraw numbers for one view, in counter pixels.
+struct OverdrawStats
+{
+	unsigned int coveredPixels = 0;		// Pixels touched by at least one fragment
+	unsigned int fragments = 0;			// Every fragment rasterized (depth complexity)
+	unsigned int shadedNoPrepass = 0;	// Fragments passing a LESS test in submission order
+	unsigned int shadedPrepass = 0;		// Fragments passing an EQUAL test after a depth pre-pass
+
+	float DepthComplexity() const { return coveredPixels ? fragments / (float)coveredPixels : 0.0f; }
+	float Overdraw() const { return coveredPixels ? shadedNoPrepass / (float)coveredPixels : 0.0f; }
+};
+
+// CPU rasterizer that only counts. Triangles are fed in the order the GPU would draw them and the
+// counter works at a reduced resolution, which is plenty for ratios.
+class DepthComplexityCounter
+{
+	unsigned int width = 0, height = 0;
+	std::vector<unsigned int> count;
+	std::vector<float> depth;
+	std::vector<XMFLOAT3> screen;	// x, y in counter pixels, z in 0..1
+	OverdrawStats stats;			// Running totals since the last Clear
+
+	static float Edge(const XMFLOAT3& a, const XMFLOAT3& b, float x, float y)
+	{
+		return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+	}
+
+	// Calls fn(index, z) for every pixel center the triangle covers.
+	template <typename Fn>
+	void Raster(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c, Fn fn)
+	{
+		float area = Edge(a, b, c.x, c.y);
+		if (area == 0.0f)
+			return;
+
+		float minX = a.x < b.x ? (a.x < c.x ? a.x : c.x) : (b.x < c.x ? b.x : c.x);
+		float maxX = a.x > b.x ? (a.x > c.x ? a.x : c.x) : (b.x > c.x ? b.x : c.x);
+		float minY = a.y < b.y ? (a.y < c.y ? a.y : c.y) : (b.y < c.y ? b.y : c.y);
+		float maxY = a.y > b.y ? (a.y > c.y ? a.y : c.y) : (b.y > c.y ? b.y : c.y);
+		int x0 = minX < 0 ? 0 : (int)minX;
+		int y0 = minY < 0 ? 0 : (int)minY;
+		int x1 = maxX > width - 1 ? (int)width - 1 : (int)maxX;
+		int y1 = maxY > height - 1 ? (int)height - 1 : (int)maxY;
+
+		// Both windings are counted, the mesh isn't drawn with back face culling in mind.
+		float inv = 1.0f / area;
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
+			{
+				float px = x + 0.5f, py = y + 0.5f;
+				float w0 = Edge(b, c, px, py) * inv;
+				float w1 = Edge(c, a, px, py) * inv;
+				float w2 = Edge(a, b, px, py) * inv;
+				if (w0 < 0 || w1 < 0 || w2 < 0)
+					continue;
+				fn(y * width + x, w0 * a.z + w1 * b.z + w2 * c.z);
+			}
+		}
+	}
+
+public:
+	void Resize(unsigned int _width, unsigned int _height)
+	{
+		width = _width;
+		height = _height;
+		count.assign(width * height, 0);
+		depth.assign(width * height, FLT_MAX);
+	}
+
+	// Starts a new count, call AddMesh for everything drawn and then Stats.
+	void Clear()
+	{
+		for (unsigned int& c : count)
+			c = 0;
+		for (float& d : depth)
+			d = FLT_MAX;
+		stats = OverdrawStats();
+	}
+
+	// Counts the indexed triangles as transformed by worldViewProj. Triangles touching the near plane are skipped.
+	// Call once per instance, in draw order, to accumulate.
+	void AddMesh(const XMFLOAT4* positions, unsigned int positionStride, unsigned int vertexCount,
+		const unsigned int* indices, unsigned int indexCount, FXMMATRIX worldViewProj)
+	{
+		screen.resize(vertexCount);
+		std::vector<bool> valid(vertexCount);
+		const char* base = reinterpret_cast<const char*>(positions);
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			const XMFLOAT4* p = reinterpret_cast<const XMFLOAT4*>(base + i * positionStride);
+			XMVECTOR clip = XMVector4Transform(XMLoadFloat4(p), worldViewProj);
+			float w = XMVectorGetW(clip);
+			valid[i] = w > 0.0f;
+			if (!valid[i])
+				continue;
+			screen[i].x = (XMVectorGetX(clip) / w * 0.5f + 0.5f) * width;
+			screen[i].y = (0.5f - XMVectorGetY(clip) / w * 0.5f) * height;
+			screen[i].z = XMVectorGetZ(clip) / w;
+		}
+
+		// Every fragment, and the ones that would pass a LESS test in draw order.
+		for (unsigned int t = 0; t + 2 < indexCount; t += 3)
+		{
+			unsigned int i0 = indices[t], i1 = indices[t + 1], i2 = indices[t + 2];
+			if (!valid[i0] || !valid[i1] || !valid[i2])
+				continue;
+			Raster(screen[i0], screen[i1], screen[i2], [&](unsigned int pixel, float z)
+			{
+				if (z < 0.0f || z > 1.0f)
+					return;
+				stats.fragments++;
+				count[pixel]++;
+				if (z < depth[pixel])
+				{
+					depth[pixel] = z;
+					stats.shadedNoPrepass++;
+				}
+			});
+		}
+	}
+
+	// Totals for everything added since the last Clear.
+	OverdrawStats Stats() const
+	{
+		// With a pre-pass only the front-most fragment of each pixel gets shaded.
+		OverdrawStats result = stats;
+		result.coveredPixels = 0;
+		for (unsigned int c : count)
+		{
+			if (c > 0)
+				result.coveredPixels++;
+		}
+		result.shadedPrepass = result.coveredPixels;
+		return result;
+	}
+
+	// Single mesh shortcut: Clear, AddMesh, Stats.
+	OverdrawStats Count(const XMFLOAT4* positions, unsigned int positionStride, unsigned int vertexCount,
+		const unsigned int* indices, unsigned int indexCount, FXMMATRIX worldViewProj)
+	{
+		Clear();
+		AddMesh(positions, positionStride, vertexCount, indices, indexCount, worldViewProj);
+		return Stats();
+	}
+
+	// Per pixel fragment counts since the last Clear, handy for a heat map.
+	const std::vector<unsigned int>& Counts() const { return count; }
+};
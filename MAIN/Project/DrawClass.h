@@ -2,6 +2,35 @@
 #include <zmouse.h>
 #include "defines.h"
 #include "DDSTextureLoader.h"
+#include "Culling.h"
+#include "Views.h"
+#include "RenderGraphD3D11.h"
+#include "RenderToTexture.h"
+#include "DepthComplexity.h"
+#include "RockInstancing.h"
+#include "ShaderCache.h"
+#include "ShaderJobs.h"
+#include "ShaderWatcher.h"
+#include "ShaderPermutations.h"
+#include "PipelineStateD3D11.h"
+#include "ClusteredLightingD3D11.h"
+#include "LightManager.h"
+#include "SceneLights.h"
+#include "ShadowsD3D11.h"
+#include "CommandStreamD3D11.h"
+#include "DynamicResolutionD3D11.h"
+#include "ProceduralGridD3D11.h"
+#include "TerrainD3D11.h"
+#include "FrameClock.h"
+#include "TripleBuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 // Base class for drawing objects
 class DrawClass
@@ -19,11 +48,15 @@ public:
 		+win.GetClientHeight(clientHeight);
 	}
 
-	// Used for compiling shaders
-	static HRESULT CompileShaderFromFile(const WCHAR* szFileName, LPCSTR szEntryPoint, LPCSTR szShaderModel, ID3DBlob** ppBlobOut)
+	// Compiled blobs persist under Shaders/Cache between launches.
+	static ShaderCache& GetShaderCache()
 	{
-		HRESULT hr = S_OK;
+		static ShaderCache cache("Shaders/Cache");
+		return cache;
+	}
 
+	static DWORD ShaderFlags()
+	{
 		DWORD dwShaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
 #ifdef _DEBUG
 		// Set the D3DCOMPILE_DEBUG flag to embed debug information in the shaders.
@@ -35,22 +68,121 @@ public:
 		// Disable optimizations to further improve shader debugging
 		dwShaderFlags |= D3DCOMPILE_SKIP_OPTIMIZATION;
 #endif
+		return dwShaderFlags;
+	}
 
-		ID3DBlob* pErrorBlob = nullptr;
-		hr = D3DCompileFromFile(szFileName, nullptr, nullptr, szEntryPoint, szShaderModel,
-			dwShaderFlags, 0, ppBlobOut, &pErrorBlob);
-		if (FAILED(hr))
-		{
+	// Reads a shader file once so a whole batch of entry points can share it. Its hash is part of the cache key.
+	static bool ReadShaderSource(const std::string& path, std::string& outPath, std::string& source)
+	{
+		std::vector<uint8_t> file;
+		if (!ShaderCache::ReadFile(path, file))
+			return false;
+		outPath = path;
+		source.assign(file.begin(), file.end());
+		return true;
+	}
+
+	static bool ReadShaderSource(const WCHAR* szFileName, std::string& path, std::string& source)
+	{
+		std::string narrow;
+		for (const WCHAR* c = szFileName; *c; c++)
+			narrow += (char)*c;
+		return ReadShaderSource(narrow, path, source);
+	}
+
+	// Compiles through the shader cache, a hit never invokes the compiler. Safe to call from several threads.
+	// defines is "NAME=VALUE;" pairs, see ShaderPermutations.h.
+	static bool CompileShaderCached(const std::string& path, const std::string& source, const std::string& entry,
+		const std::string& profile, const std::string& defines, std::vector<uint8_t>& code)
+	{
+		ShaderCache::Compiler compile = [&](const std::string& src, const ShaderKey& key, std::vector<uint8_t>& blob)
+		{
+			std::vector<std::pair<std::string, std::string>> pairs = ParseDefines(key.defines);
+			std::vector<D3D_SHADER_MACRO> macros;
+			for (const auto& pair : pairs)
+				macros.push_back({ pair.first.c_str(), pair.second.c_str() });
+			macros.push_back({ nullptr, nullptr });
+
+			ID3DBlob* pCode = nullptr;
+			ID3DBlob* pErrorBlob = nullptr;
+			HRESULT hr = D3DCompile(src.data(), src.size(), path.c_str(), macros.data(), nullptr, key.entry.c_str(), key.profile.c_str(),
+				key.flags, 0, &pCode, &pErrorBlob);
 			if (pErrorBlob)
 			{
-				OutputDebugStringA(reinterpret_cast<const char*>(pErrorBlob->GetBufferPointer())); // Print to output window.
+				if (FAILED(hr))
+				{
+					OutputDebugStringA(reinterpret_cast<const char*>(pErrorBlob->GetBufferPointer())); // Print to output window.
+					std::cout << reinterpret_cast<const char*>(pErrorBlob->GetBufferPointer()); // And the console, for hot reloads.
+				}
 				pErrorBlob->Release();
 			}
+			if (FAILED(hr))
+				return false;
+			const uint8_t* bytes = static_cast<const uint8_t*>(pCode->GetBufferPointer());
+			blob.assign(bytes, bytes + pCode->GetBufferSize());
+			pCode->Release();
+			return true;
+		};
+		return GetShaderCache().Get(source, entry, profile, defines, ShaderFlags(), compile, code);
+	}
+
+	// Used for compiling shaders, goes through the shader cache.
+	static HRESULT CompileShaderFromFile(const WCHAR* szFileName, LPCSTR szEntryPoint, LPCSTR szShaderModel, ID3DBlob** ppBlobOut)
+	{
+		std::string path, source;
+		if (!ReadShaderSource(szFileName, path, source))
+			return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+
+		std::vector<uint8_t> code;
+		if (!CompileShaderCached(path, source, szEntryPoint, szShaderModel, "", code))
+			return E_FAIL;
+
+		HRESULT hr = D3DCreateBlob(code.size(), ppBlobOut);
+		if (FAILED(hr))
 			return hr;
+		memcpy((*ppBlobOut)->GetBufferPointer(), code.data(), code.size());
+		return S_OK;
+	}
+
+	// Offline step (-buildshadercache): compiles every entry point the Mesh uses into Shaders/Cache without creating a device.
+	static bool BuildShaderCache()
+	{
+		static const char* entries[][2] =
+		{
+			{ "VS", "vs_4_0" }, { "VSWave", "vs_4_0" }, { "VSDepth", "vs_4_0" }, { "VSInstanced", "vs_4_0" }, { "SkyVS", "vs_4_0" },
+			{ "GridVS", "vs_4_0" }, { "FullscreenVS", "vs_4_0" },
+			{ "GSWave", "gs_4_0" },
+			{ "PSUnique", "ps_4_0" }, { "SkyPS", "ps_4_0" }, { "UpscalePS", "ps_4_0" },
+		};
+
+		std::string path, source;
+		if (!ReadShaderSource(L"Shaders\\shaders.fx", path, source))
+		{
+			std::cout << "Couldn't read Shaders\\shaders.fx\n";
+			return false;
 		}
-		if (pErrorBlob) pErrorBlob->Release();
 
-		return S_OK;
+		ShaderBatch batch;
+		for (const auto& e : entries)
+			batch.Add(e[0], e[1], [](const std::vector<uint8_t>&) { return true; });
+		// Every pixel shader permutation, so picking one at draw time never has to compile.
+		for (uint32_t key : AllPermutations())
+			batch.Add("PSPermutation", "ps_4_0", [](const std::vector<uint8_t>&) { return true; }, PermutationDefines(key));
+
+		GW::SYSTEM::GConcurrent workers;
+		workers.Create(true);
+		bool ok = batch.Run(
+			[&](const std::string& entry, const std::string& profile, const std::string& defines, std::vector<uint8_t>& blob)
+			{
+				return CompileShaderCached(path, source, entry, profile, defines, blob);
+			},
+			[&](std::function<void()> task) { workers.BranchSingular(task); },
+			[&]() { workers.Converge(0); });
+
+		for (const std::string& failed : batch.Failed())
+			std::cout << "Failed to compile " << failed << "\n";
+		std::cout << "Shader cache: " << GetShaderCache().Hits() << " already cached, " << GetShaderCache().Misses() << " compiled\n";
+		return ok;
 	}
 protected:
 	GW::SYSTEM::GWindow win;
@@ -67,12 +199,15 @@ public:
 		XMFLOAT4 Pos;
 		XMFLOAT3 Normal;
 		XMFLOAT2 UV;
+		XMFLOAT2 Baked = { 1.0f, 1.0f };	// Ambient occlusion and sun visibility from LightBaker, nothing blocked by default
 	};
 
 	struct SimpleMesh
 	{
 		std::vector<SimpleVertex> vertexList;
 		std::vector<unsigned int> indicesList;
+		bool baked = false;					// The vertices' Baked values came from a bake
+		XMFLOAT3 bakedSunDir = { 0, 0, 0 };	// Toward the sun the bake was done for
 	};
 
 private:
@@ -87,6 +222,7 @@ private:
 		XMFLOAT4 spotLightPos;
 		float time;
 		float cone;
+		float bakedSun;		// How much the baked sun visibility counts, 0 once the sun has moved away from the bake
 	};
 
 	struct UniqueBuffer
@@ -94,17 +230,32 @@ private:
 		XMFLOAT4 timePos;
 	};
 
+	// Everything made out of shaders.fx, kept together so a hot reload can swap it all at once.
+	struct MeshShaders
+	{
+		Microsoft::WRL::ComPtr<ID3D11InputLayout>			input = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>			vertexshader = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>			vertexshaderwave = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>			gridVS = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11GeometryShader>		geoshaderwave = nullptr;
+		// PSPermutation variants by CanonicalPermutation key, filled at startup and lazily after.
+		std::map<uint32_t, Microsoft::WRL::ComPtr<ID3D11PixelShader>>	pixelPermutations;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>			pixelshaderUnique = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>			vertexshaderInstanced = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11InputLayout>			instancedInput = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>			vertexshaderDepth = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11InputLayout>			depthInput = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>			skyVS = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>			skyPS = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>			fullscreenVS = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>			upscalePS = nullptr;
+	};
+
+	MeshShaders											shaderSet;
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		renderTargetView = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11InputLayout>			input = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11VertexShader>			vertexshader = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11VertexShader>			vertexshaderwave = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11GeometryShader>		geoshader = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11GeometryShader>		geoshaderwave = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11PixelShader>			pixelshader = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11PixelShader>			pixelshaderSolid = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11PixelShader>			pixelshaderNoLights = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11PixelShader>			pixelshaderUnique = nullptr;
 	Microsoft::WRL::ComPtr<ID3D11Buffer>				vertexbuffer = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>				instancebuffer = nullptr;
+	std::vector<RockInstance>							rockInstances;
 	Microsoft::WRL::ComPtr<ID3D11Buffer>				indexbuffer = nullptr;
 	Microsoft::WRL::ComPtr<ID3D11Buffer>				constantbuffer = nullptr;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	textureRV = nullptr;
@@ -113,21 +264,153 @@ private:
 	XMMATRIX											g_World;
 	XMMATRIX											g_View;
 	XMMATRIX											g_Projection;
-	XMMATRIX											stor_World;
-	XMMATRIX											stor_View;
-	XMMATRIX											stor_Projection;
 
-	bool doFlip = false;
+	// Shared by every view drawn this frame.
+	SceneSnapshot										scene;
+	std::vector<RenderView>								views;
+
 	bool moveDirLight = false;
 	bool ghostProtect = false, ghostProtectZ = false;
 
 	float zoom = 0;
 	float nearP = 0.01f, farP = 100.0f;
 
-	XMFLOAT4 lightDir[3], lightClr[3], spotlightPos; // Should've used a structure here - Note for 'next' time.
-	float cone = 20.0f;
+	// Every light, the first three are the directional, point and spot lights the fixed shaders use.
+	LightManager										lights;
+	SceneLightAnimator									lightAnimator;
+
+	// Simulation time, the lights and waves move in fixed steps whatever the frame rate. F pauses, '.' steps
+	// once while paused, - and = halve and double the speed. Frames draw between the last two steps.
+	FrameClock											clock;
+	SceneSnapshot										previousStep;		// The lights before the newest step
+	float												waveTime = 0.0f;	// Drives the grid wave, 0 -> 4 pi
+	float												pulseTime = 0.0f;	// Drives the unique pixel shader, 0 -> 1
+	bool												ghostProtectF = false, ghostProtectPeriod = false;
+	bool												ghostProtectMinus = false, ghostProtectPlus = false;
+
+	// Frame pipelining. The update thread runs Simulate (camera, animation) a frame ahead of Render and hands
+	// each frame over through frames. Without it Render runs Simulate itself first. Everything above, from
+	// g_World down, belongs to whichever one runs Simulate; Render only reads the frame.
+	TripleBuffer<FrameSnapshot>							frames;
+	const FrameSnapshot*								frame = nullptr;			// The one Render is drawing
+	uint64_t											framesBuilt = 0;
+	uint64_t											lightsUploaded = 0;			// Snapshot whose lights are on the GPU, 0 for none
+	unsigned int										extraLights = 0;			// What SetExtraLights last made
+	std::atomic<unsigned int>							requestedExtraLights{ 0 };	// What K last asked for
+	std::thread											updateThread;
+	std::atomic<bool>									updateRunning{ false };
+	std::mutex											pacing;						// Only for sleeping, frames needs no lock
+	std::condition_variable								paced;
+	uint64_t											framesTaken = 0;			// Newest snapshot Render has picked up, under pacing
+	enum FixedLight { LIGHT_SUN, LIGHT_POINT_LAMP, LIGHT_SPOT_LAMP, FIXED_LIGHT_COUNT };
+	std::vector<std::pair<uint32_t, uint32_t>>			lightUploadRuns;
 	SimpleMesh* mesh = nullptr;
 
+	// Everything that can be culled per view, skybox is left out since it always covers the screen.
+	enum SceneObject { OBJ_MESH, OBJ_DIR_LIGHT, OBJ_POINT_LIGHT, OBJ_SPOT_LIGHT, OBJ_RTT_CUBE, OBJ_GRID, OBJ_COUNT };
+	CullSphere											meshBounds = {};
+	float												meshInstanceRadius = 0;	// Just the mesh, meshBounds also covers the rocks
+	FrustumCuller										culler;
+	std::vector<unsigned int>							visibleList;
+	bool												visible[OBJ_COUNT] = {};
+
+	// Bounds of the mesh in its own space, grown to fit the rock instances.
+	void ComputeMeshBounds()
+	{
+		XMVECTOR vMin = XMVectorReplicate(FLT_MAX), vMax = XMVectorReplicate(-FLT_MAX);
+		for (const SimpleVertex& v : mesh->vertexList)
+		{
+			XMVECTOR p = XMLoadFloat4(&v.Pos);
+			vMin = XMVectorMin(vMin, p);
+			vMax = XMVectorMax(vMax, p);
+		}
+		XMVECTOR center = XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f);
+		float radius = 0;
+		for (const SimpleVertex& v : mesh->vertexList)
+		{
+			float d = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat4(&v.Pos), center)));
+			if (d > radius)
+				radius = d;
+		}
+		XMStoreFloat3(&meshBounds.center, center);
+		// Instances are scaled about the world origin after the world rotation, so bound them with
+		// the center's distance from the origin instead of its direction.
+		float centerDist = XMVectorGetX(XMVector3Length(center));
+		meshBounds.radius = radius;
+		meshInstanceRadius = radius;
+		for (const RockInstance& inst : rockInstances)
+		{
+			float scale = inst.offsetScale.w;
+			float offsetLen = XMVectorGetX(XMVector3Length(XMLoadFloat4(&inst.offsetScale)));
+			float d = scale * radius + (1.0f - scale) * centerDist + offsetLen;
+			if (d > meshBounds.radius)
+				meshBounds.radius = d;
+		}
+
+		for (int i = 0; i < OBJ_COUNT; i++)
+			culler.AddSphere(meshBounds);
+		for (size_t i = 0; i < rockInstances.size(); i++)
+			shadowCasters.AddSphere(meshBounds);
+	}
+
+	// Move the bounds to where everything is this frame.
+	void UpdateBounds()
+	{
+		const float cubeRadius = 1.7320508f; // Half diagonal of the unit cube
+
+		CullSphere s;
+		XMStoreFloat3(&s.center, XMVector3Transform(XMLoadFloat3(&meshBounds.center), scene.world));
+		s.radius = meshBounds.radius;
+		culler.SetSphere(OBJ_MESH, s);
+
+		XMStoreFloat3(&s.center, 5.0f * XMLoadFloat4(&scene.lightDir[0]));
+		s.radius = 0.2f * cubeRadius;
+		culler.SetSphere(OBJ_DIR_LIGHT, s);
+
+		s.center = { scene.lightDir[1].x, scene.lightDir[1].y, scene.lightDir[1].z };
+		s.radius = 0.05f * cubeRadius;
+		culler.SetSphere(OBJ_POINT_LIGHT, s);
+
+		s.center = { scene.spotlightPos.x, scene.spotlightPos.y, scene.spotlightPos.z };
+		s.radius = 0.05f * cubeRadius;
+		culler.SetSphere(OBJ_SPOT_LIGHT, s);
+
+		s.center = { posRTTCube.x, posRTTCube.y, posRTTCube.z };
+		s.radius = rttCubeScale * cubeRadius;
+		culler.SetSphere(OBJ_RTT_CUBE, s);
+
+		// Square grid sitting at y = -2.5 with a wave of 0.5 on top.
+		s.center = { 0.0f, -2.5f, 0.0f };
+		s.radius = sqrtf(gridDesc.extent * gridDesc.extent * 2.0f + 0.5f * 0.5f);
+		culler.SetSphere(OBJ_GRID, s);
+
+		// Every instance casts its own shadow, moved the same way VSDepth moves it.
+		XMVECTOR meshCenter = XMVector3Transform(XMLoadFloat3(&meshBounds.center), scene.world);
+		for (unsigned int i = 0; i < rockInstances.size(); i++)
+		{
+			XMStoreFloat3(&s.center, ApplyRockInstance(meshCenter, rockInstances[i]));
+			s.radius = meshInstanceRadius * rockInstances[i].offsetScale.w;
+			shadowCasters.SetSphere(i, s);
+		}
+	}
+
+	// Cull every object against the given view, one bit per visible object.
+	unsigned int CullScene(FXMMATRIX view, CXMMATRIX projection)
+	{
+		culler.CullSpheres(Frustum::FromViewProjection(view, projection), visibleList);
+		unsigned int mask = 0;
+		for (unsigned int i : visibleList)
+			mask |= 1u << i;
+		return mask;
+	}
+
+	// Load a view's culling results into visible[] for the draw functions.
+	void SetVisible(unsigned int mask)
+	{
+		for (int i = 0; i < OBJ_COUNT; i++)
+			visible[i] = (mask & (1u << i)) != 0;
+	}
+
 
 	// For Cube - Will try to move to seperate class once working.
 	Microsoft::WRL::ComPtr<ID3D11Buffer>				c_vertexbuffer = nullptr;
@@ -225,82 +508,20 @@ private:
 		}
 	}
 
-	// For Grid - Same thing as the cube, my end goal would be to move everything out and create a much better pipeline for rendering.
-	Microsoft::WRL::ComPtr<ID3D11Buffer>				g_vertexbuffer = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11Buffer>				g_indexbuffer = nullptr;
-
-	// Create index buffer
-	std::vector<unsigned int> gridIndices;
-
-	// Generate a proceduraly 3D grid.
-	void CreateGrid(ID3D11Device* dev, ID3D11DeviceContext* con)
-	{
-		// Create vertex buffer
-		std::vector<SimpleVertex> verts;
-
-		for (int z = -50; z < 50; z++)
-		{
-			for (int x = -50; x < 50; x++)
-			{
-				verts.push_back({ XMFLOAT4((x / 50.0f) * 5.0f, 0.0f, (z / 50.0f) * 5.0f, 1.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), });
-			}
-		}
-
-		D3D11_BUFFER_DESC bd = {};
-		bd.Usage = D3D11_USAGE_DEFAULT;
-		bd.ByteWidth = sizeof(SimpleVertex) * verts.size();
-		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		bd.CPUAccessFlags = 0;
-		D3D11_SUBRESOURCE_DATA InitData = {};
-		InitData.pSysMem = verts.data();
-		if (FAILED(dev->CreateBuffer(&bd, &InitData, g_vertexbuffer.GetAddressOf())))
-		{
-			DebugBreak();
-			return;
-		}
-
-		// Create Vertical Lines
-		for (int i = 0; i < (verts.size() - 100); i++)
-		{
-			gridIndices.push_back(i);
-			gridIndices.push_back(i + 100);
-		}
-		// Create Horizontal Lines
-		for (int x = 0; x < verts.size(); x += 100)
-		{
-			for (int i = 0; i < 99; i++)
-			{
-				gridIndices.push_back(i + x);
-				gridIndices.push_back(i + 1 + x);
-			}
-		}
-
-		bd.Usage = D3D11_USAGE_DEFAULT;
-		bd.ByteWidth = sizeof(unsigned int) * gridIndices.size();        // 36 vertices needed for 12 triangles in a triangle list
-		bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		bd.CPUAccessFlags = 0;
-		InitData.pSysMem = gridIndices.data();
-		if (FAILED(dev->CreateBuffer(&bd, &InitData, g_indexbuffer.GetAddressOf())))
-		{
-			DebugBreak();
-			return;
-		}
-	}
+	// The wave grid, [ and ] halve and double its resolution.
+	GridDesc											gridDesc;
+	D3D11GridResources									gridResources;
+	bool												ghostProtectGrid = false;
 
 	// Render the grid
 	void RenderGrid(ID3D11DeviceContext* con, ID3D11RenderTargetView* view, ConstantBuffer& cb)
 	{
-		// Change Topology to Lines
-		con->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
-
-		// Set vertex buffer
-		const UINT c_stride[] = { sizeof(SimpleVertex) };
-		const UINT c_offset[] = { 0 };
-		ID3D11Buffer* const c_buffs[] = { g_vertexbuffer.Get() };
-		con->IASetVertexBuffers(0, ARRAYSIZE(c_buffs), c_buffs, c_stride, c_offset);
+		if (!visible[OBJ_GRID])
+			return;
 
-		// Set Index Buffer
-		con->IASetIndexBuffer(g_indexbuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+		// Wave vertex shader drawn as lines, every vertex comes from its id.
+		BindPipeline(con, MakePipeline(shaderSet.gridVS.Get(), PixelPermutation(PERM_SOLID), nullptr, D3D11_PRIMITIVE_TOPOLOGY_LINELIST));
+		gridResources.Bind(con, gridDesc);
 
 		// Update the world variable to reflect the current light
 		XMFLOAT4 pos = { 0.0f, -0.5f, 0.0f, 0.0f };
@@ -310,30 +531,128 @@ private:
 		con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
 
 		// Update VS, GS, and PS's constant buffer to unique
-		con->VSSetShader(vertexshaderwave.Get(), nullptr, 0);
 		con->VSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-		//con->GSSetShader(geoshaderwave.Get(), 0, 0);
 		//con->GSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
 		con->PSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-		con->PSSetShader(pixelshaderSolid.Get(), nullptr, 0);
-	
-		con->DrawIndexed(gridIndices.size(), 0, 0);
-		
-		// Reset Geometry Shader so it doesn't affect everything else.
-		//con->GSSetShader(nullptr, 0, 0);
-		con->VSSetShader(vertexshader.Get(), nullptr, 0);
 
-		// Change Topology to Triangles
-		con->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		con->Draw(gridDesc.VertexCount(), 0);
+	}
+
+	// Streamed heightfield terrain following the camera, V swaps it in for the wave grid.
+	TerrainStreamer										terrain;
+	D3D11TerrainResources								terrainResources;
+	bool												terrainOn = false;
+	bool												ghostProtectV = false;
+	static_assert(sizeof(TerrainVertex) == sizeof(SimpleVertex), "Terrain is drawn with the SimpleVertex input layout");
+
+	// Picks and uploads the chunks around the main camera, once a frame for every view.
+	void UpdateTerrain(ID3D11DeviceContext* con)
+	{
+		XMFLOAT3 eye;
+		XMStoreFloat3(&eye, frame->camera.r[3]);
+		terrain.Update(eye);
+		terrainResources.Upload(con, terrain.Selected());
+	}
+
+	// Render the terrain chunks this view can see, lit by the fixed lights. Chunks are in world space already.
+	void RenderTerrain(ID3D11DeviceContext* con, const RenderView& rv, ConstantBuffer& cb)
+	{
+		BindPipeline(con, MakePipeline(shaderSet.vertexshader.Get(), PixelPermutation(PERM_DIR_LIGHT | PERM_POINT_LIGHT | PERM_SPOT_LIGHT), shaderSet.input.Get()));
+		terrainResources.Bind(con);
+
+		cb.mWorld = XMMatrixIdentity();
+		cb.vOutputColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+		con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
+		con->VSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
+		con->PSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
+		con->PSSetShaderResources(0, 1, textureRV.GetAddressOf());
+		con->PSSetSamplers(0, 1, samplerLinear.GetAddressOf());
+
+		Frustum frustum = Frustum::FromViewProjection(rv.view, rv.projection);
+		for (const TerrainChunk* chunk : terrain.Selected())
+		{
+			if (frustum.TestAABB(chunk->bounds))
+				terrainResources.Draw(con, *chunk);
+		}
 	}
 
 	// For Skybox Generation
-	Microsoft::WRL::ComPtr<ID3D11VertexShader>			SKBvertexshader = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11PixelShader>			SKBpixelshader = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11Buffer>				SKBvertex_Buffer = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11InputLayout>			SKBinput = nullptr;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	SKBtextureRV = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11DepthStencilState>		depthStencilState = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState>		skyDepthState = nullptr;
+
+	// Depth pre-pass, toggled with P
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState>		depthPrepassState = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState>		depthShadeState = nullptr;
+	bool												depthPrepass = false;
+	bool												ghostProtectP = false, ghostProtectO = false;
+
+	// Pixel shader features for the mesh, N toggles normal mapping and I the baked lighting.
+	uint32_t											meshPermutation = PERM_LIT | PERM_SHADOWS | PERM_BAKED;
+	bool												ghostProtectN = false, ghostProtectI = false;
+
+	// Clustered forward lighting, K cycles through how many extra lights there are (0 is the fixed 3 light setup).
+	ClusteredLightBinner								clusterBinner;
+	D3D11ClusterBuffers									clusterBuffers;
+	unsigned int										clusterExtraLights = 0;
+	bool												ghostProtectK = false;
+
+	// Shadows from the directional and spot lights, B toggles them. Each map only draws the casters it can see.
+	CascadedShadowMaps									shadows;
+	D3D11ShadowResources								shadowResources;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState>		shadowDepthState = nullptr;
+	FrustumCuller										shadowCasters;		// One sphere per mesh instance, 0 is the mesh
+	std::vector<unsigned int>							shadowCasterLists[SHADOW_MAP_COUNT];
+	RGResource											shadowAtlas = RG_INVALID;	// This frame's, RG_INVALID with shadows off
+	bool												ghostProtectB = false;
+
+	// Every map's casters are copied into shadowInstances back to back, and drawn as jobs of one instanced draw of up
+	// to shadowJobSize of them. The jobs are recorded on worker threads and, once there are enough draws, turned into
+	// one command list per worker. X toggles between that and playing the jobs onto the immediate context.
+	struct ShadowJob
+	{
+		unsigned int map, first, count;
+	};
+	static const unsigned int							shadowJobSize = 64;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>				shadowInstances = nullptr;
+	std::vector<ShadowJob>								shadowJobs;
+	std::vector<CommandStream>							shadowStreams;
+	D3D11CommandLists									shadowLists;
+	bool												ghostProtectX = false;
+
+	// Dynamic resolution, U toggles it. The main view draws into the corner of sceneColor that the controller
+	// picks from the last frame times, and is stretched over the back buffer before the minimap goes on top.
+	DynamicResolutionController							dynamicRes;
+	D3D11GpuFrameTimer									gpuTimer;
+	D3D11UpscaleResources								upscaleResources;
+	RGResource											sceneColor = RG_INVALID;	// This frame's, RG_INVALID at full scale
+	bool												dynamicResolution = true;
+	bool												gpuTimed = false;		// Has the GPU timer ever answered
+	float												cpuFrameMs = 0.0f;		// Last Render() call, until it has
+	bool												ghostProtectU = false;
+	DepthComplexityCounter								overdraw;
+
+	// Hot reload, checked once per frame before anything is drawn, see HotReloadShaders.
+	ShaderWatcher										watcher;
+	uint64_t											shaderSourceHash = 0;
+	Microsoft::WRL::ComPtr<ID3D11Device>				device = nullptr;
+	std::unique_ptr<ShaderBatch>						reloadBatch;
+	std::unique_ptr<MeshShaders>						reloadSet;
+	std::string											reloadPath, reloadSource;
+	std::string											shaderPath, shaderSource;	// What shaderSet was built from, for lazy permutations
+	std::atomic<bool>									reloadDone{ false };
+	bool												reloadOk = false;
+	bool												reloading = false;
+	GW::SYSTEM::GConcurrent								reloadWorker; // After everything the reload job touches, so it's torn down (and waited on) first
+
+	// Every draw binds one pipeline, only the parts that differ from the last one reach the context.
+	PipelineCache										pipelines;
+	PipelineStateTracker								pipelineState;
+
+	void BindPipeline(ID3D11DeviceContext* con, const PipelineDesc& desc)
+	{
+		PipelineId id = pipelines.Get(desc);
+		ApplyPipeline(con, pipelines.Desc(id), pipelineState.Bind(pipelines, id));
+	}
 
 	// Reflection Cube Variables
 	//XMFLOAT4											refCube = {0.1f, 0.0f, 0.2f, 1.0f};
@@ -353,29 +672,28 @@ private:
 		con->IASetIndexBuffer(c_indexbuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
 		// Start rendering the cube.
-		XMMATRIX mLight = XMMatrixTranslationFromVector(1.0f * XMLoadFloat4(&lightDir[1]));
+		XMMATRIX mLight = XMMatrixTranslationFromVector(1.0f * XMLoadFloat4(&scene.lightDir[1]));
 		XMMATRIX mLightScale = XMMatrixScaling(0.5f, 0.5f, 0.5f);
 		mLight = mLightScale * mLight;
 
 		// Update the world variable to reflect the current light
 		cb.mWorld = XMMatrixTranspose(mLight);
-		cb.vOutputColor = lightClr[1];
+		cb.vOutputColor = scene.lightClr[1];
 		con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
 
 		// Be sure the constant buffer is still the contsant buffer.
+		BindPipeline(con, MakePipeline(shaderSet.vertexshader.Get(), PixelPermutation(PERM_SOLID), shaderSet.input.Get()));
 		con->PSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-		con->PSSetShader(pixelshaderSolid.Get(), nullptr, 0);
 
 		// Draw it out
 		con->DrawIndexed(36, 0, 0);
 	}
 
-	// For Render to Texture
-	Microsoft::WRL::ComPtr<ID3D11Texture2D>				RTrenderTargetTexture = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		RTrenderTargetView = nullptr;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	RTshaderResourceView = nullptr;
+	// Frame graph, the render to texture target is imported from rttPool each frame.
+	RenderGraph											graph;
+	D3D11RenderGraphBackend								graphBackend;
+	D3D11GraphTexture									backBuffer;
 
-	XMMATRIX											vp_two_World;
 	XMMATRIX											vp_two_View;
 	XMMATRIX											vp_two_Projection;
 
@@ -383,61 +701,9 @@ private:
 	XMMATRIX											rtt_Projection;
 	float clr[4] = { 0.2f, 0.2f, 0.5f, 1 };
 
-	// Render to Texture Initialization
+	// Render to Texture Initialization, the target itself is created by the render graph.
 	void InitRTT(ID3D11Device* dev, ID3D11DeviceContext* con)
 	{
-		D3D11_TEXTURE2D_DESC textureDesc;
-		D3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc;
-		D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
-
-		// Render to Texture
-		// Initialize the texture description.
-		ZeroMemory(&textureDesc, sizeof(textureDesc));
-
-		// Setup the texture description.
-		textureDesc.Width = clientWidth;
-		textureDesc.Height = clientHeight;
-		textureDesc.MipLevels = 1;
-		textureDesc.ArraySize = 1;
-		textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		textureDesc.SampleDesc.Count = 1;
-		textureDesc.Usage = D3D11_USAGE_DEFAULT;
-		textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
-		textureDesc.CPUAccessFlags = 0;
-		textureDesc.MiscFlags = 0;
-
-		// Create the texture
-		if(FAILED(dev->CreateTexture2D(&textureDesc, NULL, RTrenderTargetTexture.GetAddressOf())))
-		{
-			DebugBreak();
-			return;
-		}
-
-		// Setup the render target view.
-		renderTargetViewDesc.Format = textureDesc.Format;
-		renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-		renderTargetViewDesc.Texture2D.MipSlice = 0;
-
-		// Create the render target view.
-		if(FAILED(dev->CreateRenderTargetView(RTrenderTargetTexture.Get(), &renderTargetViewDesc, RTrenderTargetView.GetAddressOf())))
-		{
-			DebugBreak();
-			return;
-		}
-
-		// Setup the shader resource view.
-		shaderResourceViewDesc.Format = textureDesc.Format;
-		shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-		shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
-		shaderResourceViewDesc.Texture2D.MipLevels = 1;
-
-		// Create the shader resource view.
-		if(FAILED(dev->CreateShaderResourceView(RTrenderTargetTexture.Get(), &shaderResourceViewDesc, RTshaderResourceView.GetAddressOf())))
-		{
-			DebugBreak();
-			return;
-		}
-
 		// Initialize the view matrix
 		XMVECTOR Eye = XMVectorSet(0.0f, 1.0f + 15.0f, -5.0f, 100.0f);
 		XMVECTOR At = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
@@ -448,42 +714,28 @@ private:
 		rtt_Projection = XMMatrixOrthographicLH(8, 8, nearP, farP);
 		// Isometric Projection Matrix
 		//rtt_Projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, DrawClass::width / (FLOAT)DrawClass::height, nearP, farP);
-	}
-
-	// Draw the object in the seperate 'scene'
-	void DrawBehind(ID3D11DeviceContext* con, ID3D11RenderTargetView* view, ConstantBuffer& cb, UINT size)
-	{
-		ID3D11DepthStencilView* depthview = nullptr;
-		+d3d11.GetDepthStencilView((void**)&depthview);
-
-		con->ClearRenderTargetView(RTrenderTargetView.Get(), clr);
-
-		con->OMSetRenderTargets(1, RTrenderTargetView.GetAddressOf(), depthview);
-
-		//cb.mWorld = XMMatrixTranspose(rtt_World);
-		cb.mView = XMMatrixTranspose(rtt_View);
-		cb.mProjection = XMMatrixTranspose(rtt_Projection);
-		cb.vOutputColor = { 1.0f, 0.5f, 1.0f, 1.0f };
-		con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
-
-		con->DrawIndexed(size, 0, 0);
 
-		con->OMSetRenderTargets(1, renderTargetView.GetAddressOf(), depthview);
-		con->ClearDepthStencilView(depthview, D3D11_CLEAR_DEPTH, 1.0f, 0);
-		depthview->Release();
-
-		XMVECTOR det;
-		cb.mWorld = g_World;
-		cb.mView = XMMatrixTranspose(XMMatrixInverse(&det, g_View));
-		cb.mProjection = XMMatrixTranspose(g_Projection);
-		con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
+		// Square, sized from the cube on screen and redrawn every third frame unless the mesh moves.
+		RGTextureDesc rttDesc;
+		rttDesc.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		rttDesc.bindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+		rttTarget.Configure(rttDesc, 64, 1024, 3);
 	}
 
 	XMFLOAT4											posRTTCube = {0.0f, 2.5f, 0.0f, 1.0f};
 	XMFLOAT4											clrRTTCube = {1.0f, 1.0f, 1.0f, 1.0f };
+	const float											rttCubeScale = 0.5f;
+
+	// The RTT target keeps what it drew between redraws, so it comes from its own pool instead of the graph's.
+	RenderTargetPool									rttPool;
+	AdaptiveRenderTarget								rttTarget;
+	XMFLOAT4X4											rttWorld = {};	// Mesh world matrix the target was last drawn with
 
-	void RenderRTT(ID3D11DeviceContext* con, ID3D11RenderTargetView* view, ConstantBuffer& cb, UINT size)
+	void RenderRTT(ID3D11DeviceContext* con, ID3D11ShaderResourceView* srv, ConstantBuffer& cb, UINT size)
 	{
+		if (!visible[OBJ_RTT_CUBE] || srv == nullptr)
+			return;
+
 		// Set vertex buffer
 		const UINT c_stride[] = { sizeof(SimpleVertex) };
 		const UINT c_offset[] = { 0 };
@@ -495,7 +747,7 @@ private:
 
 		// Start rendering the cube.
 		XMMATRIX mLight = XMMatrixTranslationFromVector(1.0f * XMLoadFloat4(&posRTTCube));
-		XMMATRIX mLightScale = XMMatrixScaling(.5f, .5f, .5f);
+		XMMATRIX mLightScale = XMMatrixScaling(rttCubeScale, rttCubeScale, rttCubeScale);
 		mLight = mLightScale * mLight;
 
 		// Update the world variable to reflect the current light
@@ -506,9 +758,9 @@ private:
 		con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
 
 		// Be sure the constant buffer is still the contsant buffer.
-		con->PSSetShader(pixelshaderNoLights.Get(), nullptr, 0);
+		BindPipeline(con, MakePipeline(shaderSet.vertexshader.Get(), PixelPermutation(PERM_NO_LIGHTS), shaderSet.input.Get()));
 		con->PSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-		con->PSSetShaderResources(0, 1, RTshaderResourceView.GetAddressOf());
+		con->PSSetShaderResources(0, 1, &srv);
 		con->PSSetSamplers(0, 1, samplerLinear.GetAddressOf());
 
 		// Draw it out
@@ -529,6 +781,13 @@ public:
 		}
 
 		mesh = _mesh;
+		rockInstances = GenerateRockInstances();
+		if (mesh != nullptr)
+			ComputeMeshBounds();
+		// Without a bake the vertices' Baked values are only placeholders.
+		if (mesh == nullptr || !mesh->baked)
+			meshPermutation &= ~PERM_BAKED;
+
 		ID3D11Device* dev = nullptr;
 		ID3D11DeviceContext* con = nullptr;
 		ID3D11DepthStencilView* depthview = nullptr;
@@ -555,303 +814,179 @@ public:
 
 			con->OMSetRenderTargets(1, renderTargetView.GetAddressOf(), depthview);
 			depthview->Release();
+
+			// The back buffer is handed to the render graph as an imported texture.
+			backBuffer.rtv = renderTargetView;
+			graphBackend.SetDevice(dev);
 		}
 
-		// Creation of DEPTH stencil desc
+		// The sky sits on the far plane: tested against the depth buffer so it only fills what nothing covered, never written.
 		D3D11_DEPTH_STENCIL_DESC desc;
 		ZeroMemory(&desc, sizeof(D3D11_DEPTH_STENCIL_DESC));
 		desc.DepthEnable = true;
-		desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+		desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
 		desc.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
 
-		if (FAILED(dev->CreateDepthStencilState(&desc, &depthStencilState)))
+		if (FAILED(dev->CreateDepthStencilState(&desc, &skyDepthState)))
 		{
 			DebugBreak();
 			return;
 		}
 
-		// Compile the vertex shader
-		ID3DBlob* pVSBlob = nullptr;
-		if (FAILED(DrawClass::CompileShaderFromFile(L"Shaders\\shaders.fx", "VS", "vs_4_0", &pVSBlob)))
+		// Pre-pass lays down depth, shading pass only lets the front-most fragment through.
+		desc.DepthFunc = D3D11_COMPARISON_LESS;
+		desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+		if (FAILED(dev->CreateDepthStencilState(&desc, depthPrepassState.GetAddressOf())))
 		{
 			DebugBreak();
 			return;
 		}
 
-		// Create the vertex shader
-		if (FAILED(dev->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, vertexshader.GetAddressOf())))
+		// Shadow maps get their own, so changes to the pre-pass can't reach them.
+		if (FAILED(dev->CreateDepthStencilState(&desc, shadowDepthState.GetAddressOf())))
 		{
 			DebugBreak();
-			pVSBlob->Release();
 			return;
 		}
 
-		// Compile the vertex shader for the wave.
-		pVSBlob = nullptr;
-		if (FAILED(DrawClass::CompileShaderFromFile(L"Shaders\\shaders.fx", "VSWave", "vs_4_0", &pVSBlob)))
+		// Rocks are in the pre-pass now and both passes share InstanceToClip, so EQUAL is exact.
+		desc.DepthFunc = D3D11_COMPARISON_EQUAL;
+		desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+		if (FAILED(dev->CreateDepthStencilState(&desc, depthShadeState.GetAddressOf())))
 		{
 			DebugBreak();
 			return;
 		}
 
-		// Create the vertex shader for the wave.
-		if (FAILED(dev->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, vertexshaderwave.GetAddressOf())))
+		// Read the shaders once, every compile job shares the source.
+		if (!ReadShaderSource("Shaders/shaders.fx", shaderPath, shaderSource))
 		{
-			DebugBreak();
-			pVSBlob->Release();
+			MessageBox(nullptr,
+				L"The FX file cannot be compiled.  Please run this executable from the directory that contains the FX file.", L"Error", MB_OK);
 			return;
 		}
+		shaderSourceHash = HashBytes(shaderSource.data(), shaderSource.size());
 
-		// Define the input layout
-		D3D11_INPUT_ELEMENT_DESC layout[] =
-		{
-			{ "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-			{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-		};
-		UINT numElements = ARRAYSIZE(layout);
-
-		// Create the input layout
-		if (FAILED(dev->CreateInputLayout(layout, numElements, pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), input.GetAddressOf())))
-		{
+		// Everything runs on Gateware's thread pool, this is the only wait before the first frame.
+		ShaderBatch batch;
+		QueueShaderJobs(batch, dev, shaderSet, { PERM_LIT | PERM_SHADOWS | PERM_BAKED, PERM_LIT, PERM_SOLID, PERM_NO_LIGHTS });
+		GW::SYSTEM::GConcurrent workers;
+		workers.Create(true);
+		bool shadersReady = batch.Run(
+			[&](const std::string& entry, const std::string& profile, const std::string& defines, std::vector<uint8_t>& blob)
+			{
+				return CompileShaderCached(shaderPath, shaderSource, entry, profile, defines, blob);
+			},
+			[&](std::function<void()> task) { workers.BranchSingular(task); },
+			[&]() { workers.Converge(0); });
+		// Keep going, anything missing just doesn't draw until shaders.fx is fixed and hot reloaded.
+		if (!shadersReady)
+			PrintShaderFailures(batch);
+
+		// Watch for edits to the shaders from here on.
+		device = dev;
+		if (!clusterBuffers.Create(dev))
 			DebugBreak();
-			pVSBlob->Release();
-			return;
-		}
-
-		con->IASetInputLayout(input.Get());
-
-		// Skybox VS
-		// Compile the Skybox vertex shader
-		pVSBlob = nullptr;
-		if (FAILED(DrawClass::CompileShaderFromFile(L"Shaders\\shaders.fx", "SKYBOX_VS", "vs_4_0", &pVSBlob)))
-		{
+		if (!shadowResources.Create(dev))
 			DebugBreak();
-			return;
-		}
-
-		// Create the Skybox vertex shader
-		if (FAILED(dev->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, SKBvertexshader.GetAddressOf())))
-		{
+		if (!gpuTimer.Create(dev) || !upscaleResources.Create(dev) || !gridResources.Create(dev)
+			|| !terrainResources.Create(dev, terrain.Desc()))
 			DebugBreak();
-			pVSBlob->Release();
-			return;
-		}
-
-		// Define the input layout
-		D3D11_INPUT_ELEMENT_DESC SKBlayout[] =
-		{
-			{ "SV_POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-			{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-			{ "TEXCOORD", 2, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-		};
-		numElements = ARRAYSIZE(SKBlayout);
+		reloadWorker.Create(true);
+		watcher.Start(ShaderWatchDirectory());
 
-		// Create the input layout
-		if (FAILED(dev->CreateInputLayout(SKBlayout, numElements, pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), SKBinput.GetAddressOf())))
-		{
-			DebugBreak();
-			pVSBlob->Release();
-			return;
-		}
+		con->IASetInputLayout(shaderSet.input.Get());
 
-		pVSBlob->Release();
+		// Create a cube to store and render later.
+		CreateCube(dev, con);
 
-		// Create the Base Geometry Shader
-		ID3DBlob* pGSBlob = nullptr;
+		// Create Vertex Buffer
+		D3D11_BUFFER_DESC bd = {};
+		bd.Usage = D3D11_USAGE_DEFAULT;
+		bd.ByteWidth = sizeof(SimpleVertex) * mesh->vertexList.size();
+		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bd.CPUAccessFlags = 0;
 
-		if (FAILED(DrawClass::CompileShaderFromFile(L"Shaders\\shaders.fx", "GS", "gs_4_0", &pGSBlob)))
+		D3D11_SUBRESOURCE_DATA InitData = {};
+		InitData.pSysMem = mesh->vertexList.data();
+		if (FAILED(dev->CreateBuffer(&bd, &InitData, vertexbuffer.GetAddressOf())))
 		{
 			DebugBreak();
-			pGSBlob->Release();
 			return;
 		}
+		// Set vertex buffer
+		const UINT stride[] = { sizeof(SimpleVertex) };
+		const UINT offset[] = { 0 };
+		ID3D11Buffer* const buffs[] = { vertexbuffer.Get() };
+		con->IASetVertexBuffers(0, ARRAYSIZE(buffs), buffs, stride, offset);
 
-		if (FAILED(dev->CreateGeometryShader(pGSBlob->GetBufferPointer(), pGSBlob->GetBufferSize(), NULL, &geoshader)))
+		// Create Index Buffer
+		bd.Usage = D3D11_USAGE_DEFAULT;
+		bd.ByteWidth = sizeof(int) * mesh->indicesList.size();
+		bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		bd.CPUAccessFlags = 0;
+		InitData.pSysMem = mesh->indicesList.data();
+		if (FAILED(dev->CreateBuffer(&bd, &InitData, indexbuffer.GetAddressOf())))
 		{
 			DebugBreak();
-			pGSBlob->Release();
 			return;
 		}
 
-		// Create the Wave Geometry Shader
-		pGSBlob = nullptr;
-		if (FAILED(DrawClass::CompileShaderFromFile(L"Shaders\\shaders.fx", "GSWave", "gs_4_0", &pGSBlob)))
+		// Create Instance Buffer, the rocks never move so it's filled once.
+		bd.Usage = D3D11_USAGE_IMMUTABLE;
+		bd.ByteWidth = sizeof(RockInstance) * rockInstances.size();
+		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bd.CPUAccessFlags = 0;
+		InitData.pSysMem = rockInstances.data();
+		if (FAILED(dev->CreateBuffer(&bd, &InitData, instancebuffer.GetAddressOf())))
 		{
 			DebugBreak();
-			pGSBlob->Release();
 			return;
 		}
 
-		if (FAILED(dev->CreateGeometryShader(pGSBlob->GetBufferPointer(), pGSBlob->GetBufferSize(), NULL, &geoshaderwave)))
+		// Room for every instance in every shadow map, refilled each frame with the ones each map keeps.
+		bd.Usage = D3D11_USAGE_DYNAMIC;
+		bd.ByteWidth = sizeof(RockInstance) * rockInstances.size() * SHADOW_MAP_COUNT;
+		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		if (FAILED(dev->CreateBuffer(&bd, nullptr, shadowInstances.GetAddressOf())))
 		{
 			DebugBreak();
-			pGSBlob->Release();
-			return;
-		}
-
-		pGSBlob->Release();
-
-		// Compile the pixel shaders
-		ID3DBlob* pPSBlob = nullptr;
-		if (FAILED(DrawClass::CompileShaderFromFile(L"Shaders\\shaders.fx", "PS", "ps_4_0", &pPSBlob)))
-		{
-			MessageBox(nullptr,
-				L"The FX file cannot be compiled.  Please run this executable from the directory that contains the FX file.", L"Error", MB_OK);
 			return;
 		}
 
-		// Create the pixel shader
-		if (FAILED(dev->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, pixelshader.GetAddressOf())))
-		{
-			pPSBlob->Release();
-			return;
-		}
+		// Set Index Buffer
+		con->IASetIndexBuffer(indexbuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
-		// Compile the lighting pixel shader
-		pPSBlob = nullptr;
-		if (FAILED(DrawClass::CompileShaderFromFile(L"Shaders\\shaders.fx", "PSSolid", "ps_4_0", &pPSBlob)))
+		// Create the constant buffer
+		bd.Usage = D3D11_USAGE_DEFAULT;
+		bd.ByteWidth = sizeof(ConstantBuffer);
+		bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		bd.CPUAccessFlags = 0;
+		if (FAILED(dev->CreateBuffer(&bd, nullptr, constantbuffer.GetAddressOf())))
 		{
-			MessageBox(nullptr,
-				L"The FX file cannot be compiled.  Please run this executable from the directory that contains the FX file.", L"Error", MB_OK);
+			DebugBreak();
 			return;
 		}
 
-		// Create the pixel shader
-		if (FAILED(dev->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, pixelshaderSolid.GetAddressOf())))
-		{
-			pPSBlob->Release();
-			return;
-		}
+		// LOADING TEXTURE //
 
-		// Compile the unique lighting pixel shader
-		pPSBlob = nullptr;
-		if (FAILED(DrawClass::CompileShaderFromFile(L"Shaders\\shaders.fx", "PSNoLights", "ps_4_0", &pPSBlob)))
+		// Load the Texture
+		
+		if (FAILED(CreateDDSTextureFromFile(dev, texturePath, nullptr, textureRV.GetAddressOf())))
 		{
-			MessageBox(nullptr,
-				L"The FX file cannot be compiled.  Please run this executable from the directory that contains the FX file.", L"Error", MB_OK);
 			DebugBreak();
 			return;
 		}
 
-		// Create the unique pixel shader
-		if (FAILED(dev->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, pixelshaderNoLights.GetAddressOf())))
+		// Load Normal Map
+		if (FAILED(CreateDDSTextureFromFile(dev, normPath, nullptr, normRV.GetAddressOf())))
 		{
-			pPSBlob->Release();
 			DebugBreak();
 			return;
 		}
-		pPSBlob->Release();
 
-		// Compile the unique lighting pixel shader
-		pPSBlob = nullptr;
-		if (FAILED(DrawClass::CompileShaderFromFile(L"Shaders\\shaders.fx", "PSUnique", "ps_4_0", &pPSBlob)))
-		{
-			MessageBox(nullptr,
-				L"The FX file cannot be compiled.  Please run this executable from the directory that contains the FX file.", L"Error", MB_OK);
-			DebugBreak();
-			return;
-		}
-
-		// Create the unique pixel shader
-		if (FAILED(dev->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, pixelshaderUnique.GetAddressOf())))
-		{
-			pPSBlob->Release();
-			DebugBreak();
-			return;
-		}
-		pPSBlob->Release();
-		
-		//Compile skybox pixel shader
-		pPSBlob = nullptr;
-		if (FAILED(DrawClass::CompileShaderFromFile(L"Shaders\\shaders.fx", "SKYBOX_PS", "ps_4_0", &pPSBlob)))
-		{
-			MessageBox(nullptr,
-				L"The FX file cannot be compiled.  Please run this executable from the directory that contains the FX file.", L"Error", MB_OK);
-			DebugBreak();
-			return;
-		}
-
-		// Create skybox pixel shader
-		if (FAILED(dev->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, SKBpixelshader.GetAddressOf())))
-		{
-			pPSBlob->Release();
-			DebugBreak();
-			return;
-		}
-		pPSBlob->Release();
-
-		// Create a cube to store and render later.
-		CreateCube(dev, con);
-
-		// Create the grid
-		CreateGrid(dev, con);
-
-		// Create Vertex Buffer
-		D3D11_BUFFER_DESC bd = {};
-		bd.Usage = D3D11_USAGE_DEFAULT;
-		bd.ByteWidth = sizeof(SimpleVertex) * mesh->vertexList.size();
-		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		bd.CPUAccessFlags = 0;
-
-		D3D11_SUBRESOURCE_DATA InitData = {};
-		InitData.pSysMem = mesh->vertexList.data();
-		if (FAILED(dev->CreateBuffer(&bd, &InitData, vertexbuffer.GetAddressOf())))
-		{
-			DebugBreak();
-			return;
-		}
-		// Set vertex buffer
-		const UINT stride[] = { sizeof(SimpleVertex) };
-		const UINT offset[] = { 0 };
-		ID3D11Buffer* const buffs[] = { vertexbuffer.Get() };
-		con->IASetVertexBuffers(0, ARRAYSIZE(buffs), buffs, stride, offset);
-
-		// Create Index Buffer
-		bd.Usage = D3D11_USAGE_DEFAULT;
-		bd.ByteWidth = sizeof(int) * mesh->indicesList.size();
-		bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		bd.CPUAccessFlags = 0;
-		InitData.pSysMem = mesh->indicesList.data();
-		if (FAILED(dev->CreateBuffer(&bd, &InitData, indexbuffer.GetAddressOf())))
-		{
-			DebugBreak();
-			return;
-		}
-
-		// Set Index Buffer
-		con->IASetIndexBuffer(indexbuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-		// Create the constant buffer
-		bd.Usage = D3D11_USAGE_DEFAULT;
-		bd.ByteWidth = sizeof(ConstantBuffer);
-		bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		bd.CPUAccessFlags = 0;
-		if (FAILED(dev->CreateBuffer(&bd, nullptr, constantbuffer.GetAddressOf())))
-		{
-			DebugBreak();
-			return;
-		}
-
-		// LOADING TEXTURE //
-
-		// Load the Texture
-		
-		if (FAILED(CreateDDSTextureFromFile(dev, texturePath, nullptr, textureRV.GetAddressOf())))
-		{
-			DebugBreak();
-			return;
-		}
-
-		// Load Normal Map
-		if (FAILED(CreateDDSTextureFromFile(dev, normPath, nullptr, normRV.GetAddressOf())))
-		{
-			DebugBreak();
-			return;
-		}
-
-		// SKYBOX Texture
-		if (FAILED(CreateDDSTextureFromFile(dev, L"Textures\\SunsetSkybox.dds", nullptr, SKBtextureRV.GetAddressOf())))
+		// SKYBOX Texture
+		if (FAILED(CreateDDSTextureFromFile(dev, L"Textures\\SunsetSkybox.dds", nullptr, SKBtextureRV.GetAddressOf())))
 		{
 			DebugBreak();
 			return;
@@ -887,18 +1022,8 @@ public:
 		g_Projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, DrawClass::width / (FLOAT)DrawClass::height, nearP, farP);
 
 		// Set-up Lighting Variables
-		{
-			// Directional Lighting
-			lightDir[0] = { -0.577f, 0.577f, -0.577f, 1.0f };
-			lightClr[0] = { 0.6f, 0.6f, 0.6f, 1.0f };
-			// Positional Lighting
-			lightDir[1] = { 0.0f, 0.2f, -1.0f, 1.0f };
-			lightClr[1] = { 0.0f, 0.8f, 0.8f, 1.0f };
-			// Spot Light
-			lightDir[2] = { 0.0f, 0.577f, -0.577f, 1.0f };
-			lightClr[2] = { 1.0f, 0.0f, 0.0f, 1.0f };
-			spotlightPos = { 0.0f, 2.0f, -2.0f, 1.0f};
-		}
+		AddSceneLights(lights);
+		TakeLights(previousStep);
 
 		InitRTT(dev, con);
 
@@ -917,185 +1042,531 @@ public:
 		return;
 	}
 
-	void Render(UINT flag = 1)
+	// For recording or replaying the frame times from the command line, before the update thread starts.
+	FrameClock& Clock() { return clock; }
+
+	// From here on Simulate runs on its own thread, a frame ahead of Render.
+	void StartUpdateThread()
 	{
-		if (mesh == nullptr)
+		if (updateThread.joinable())
 			return;
+		updateRunning = true;
+		updateThread = std::thread(&Mesh::UpdateLoop, this);
+	}
 
-		// Update time
-		static float t = 0.0f, tUpToOne = 0.0f, tTotal;
+	void StopUpdateThread()
+	{
+		if (!updateThread.joinable())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(pacing);
+			updateRunning = false;
+		}
+		paced.notify_one();
+		updateThread.join();
+	}
 
-		static ULONGLONG timePerFrame = 0, timeStart = 0;
+	~Mesh()
+	{
+		StopUpdateThread();
+		terrain.Stop();
+		watcher.Stop();
+		reloadWorker.Converge(0);
+		rttTarget.Release(rttPool);
+		rttPool.ReleaseAll(graphBackend);
+		graph.ReleasePool(graphBackend);
+	}
 
-		ULONGLONG timeCur = GetTickCount64();
-		if (timePerFrame == 0)
-			timePerFrame = timeCur;
-		t = (timeCur - timePerFrame) / 1500.0f;
-		if (timeStart == 0)
-			timeStart = timeCur;
-		tUpToOne = (timeCur - timeStart) / 1000.0f;
-		tTotal += t * 2.0f;
+	// Copies the fixed three lights and the animation times into a snapshot.
+	void TakeLights(SceneSnapshot& snapshot)
+	{
+		XMFLOAT3 sunDir = lights.Direction(LIGHT_SUN), pointPos = lights.Position(LIGHT_POINT_LAMP);
+		XMFLOAT3 spotDir = lights.Direction(LIGHT_SPOT_LAMP), spotPos = lights.Position(LIGHT_SPOT_LAMP);
+		snapshot.lightDir[0] = { sunDir.x, sunDir.y, sunDir.z, 1.0f };
+		snapshot.lightDir[1] = { pointPos.x, pointPos.y, pointPos.z, 1.0f };
+		snapshot.lightDir[2] = { -spotDir.x, -spotDir.y, -spotDir.z, 1.0f };
+		for (int i = 0; i < 3; i++)
+		{
+			XMFLOAT3 c = lights.Color(LIGHT_SUN + i);
+			snapshot.lightClr[i] = { c.x, c.y, c.z, 1.0f };
+		}
+		snapshot.spotlightPos = { spotPos.x, spotPos.y, spotPos.z, 1.0f };
+		snapshot.cone = lights.SpotCos(LIGHT_SPOT_LAMP) * 25.0f;
+		snapshot.time = waveTime;
+		snapshot.pulse = pulseTime;
+	}
+
+	// Advance time and animate the lights. Done once per frame, every view draws from the result.
+	void UpdateScene(SceneSnapshot& out)
+	{
+		// Each step is the old per frame time, milliseconds / 1500.
+		unsigned int steps = clock.Tick();
+		float t = (float)(clock.Step() * 1000.0 / 1500.0);
+		for (unsigned int i = 0; i < steps; i++)
+		{
+			TakeLights(previousStep);
+
+			waveTime += t * 2.0f;
+			// Reset the total time with that of the sine wave. (2 * pi)
+			if (waveTime > 6.28f * 2.0f) // I lowered the speed by half, so it's going to take twice as long now.
+				waveTime = 0;
+
+			// To cause a pulse for the Unique Pixel Shader
+			pulseTime += (float)clock.Step();
+			if (pulseTime > 1.0f)
+				pulseTime = 0;
+
+			// Pulse the point light and turn every light by its spin, the directional light holds still while it's being dragged.
+			lightAnimator.Step(lights, t, moveDirLight);
+		}
 
-		// Reset the total time with that of the sine wave. (2 * pi)
-		if (tTotal > 6.28f * 2.0f) // I lowered the speed by half, so it's going to take twice as long now.
-			tTotal = 0;
+		// Take the snapshot every view will share, part way from the last step to the newest. The clustered
+		// lights are uploaded as of the newest step.
+		SceneSnapshot newest;
+		TakeLights(newest);
+		out = BlendSnapshots(previousStep, newest, clock.Alpha());
+		out.world = g_World;
+	}
 
-		// To cause a pulse for the Unique Pixel Shader
-		if (tUpToOne > 1)
+	// The update thread's half of a frame: camera input and animation, then the snapshot of them Render draws.
+	void Simulate()
+	{
+		SimulationInput();
+
+		unsigned int requested = requestedExtraLights.load(std::memory_order_relaxed);
+		if (requested != extraLights)
+		{
+			SetExtraLights(requested);
+			extraLights = requested;
+		}
+
+		FrameSnapshot& f = frames.Back();
+		UpdateScene(f.scene);
+		f.number = ++framesBuilt;
+		f.camera = g_View;
+		f.projection = g_Projection;
+		f.nearP = nearP;
+		f.farP = farP;
+		lights.Pack();
+		lights.DirtyRuns(f.lightRuns);
+		f.lights = lights.Packed();
+		lights.ClearDirty();
+		f.spotSlot = lights.Slot(LIGHT_SPOT_LAMP);
+		frames.Publish();
+	}
+
+	// Keeps one frame ahead of Render, then sleeps until Render picks it up.
+	void UpdateLoop()
+	{
+		while (updateRunning)
 		{
-			timeStart = timeCur;
+			Simulate();
+			std::unique_lock<std::mutex> lock(pacing);
+			paced.wait(lock, [this] { return framesTaken >= framesBuilt || !updateRunning; });
 		}
+	}
 
-		// Grab the context and view.
-		ID3D11DeviceContext* con;
-		ID3D11RenderTargetView* view;
-		d3d11.GetImmediateContext((void**)&con);
-		d3d11.GetRenderTargetView((void**)&view);
-		
-		// Set the viewport.
-		//con->ClearRenderTargetView(renderTargetView.Get(), clr);
-		if (flag == 1)
-			con->RSSetViewports(1, &vp_one);
+	// The swarm of small lights for clustered shading, after the fixed three. A golden angle spiral out from the
+	// middle, every other light orbits at its ring's speed and the rest stand still, so only half of them get re-uploaded.
+	void SetExtraLights(unsigned int count)
+	{
+		lights.Truncate(FIXED_LIGHT_COUNT);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			float radius = 1.0f + 7.0f * sqrtf((i + 0.5f) / count);
+			float angle = i * 2.39996f;
+			LightDesc l;
+			l.position = { radius * cosf(angle), 0.2f + 0.6f * (0.5f + 0.5f * sinf((float)i)), radius * sinf(angle) };
+			l.color = { 0.5f + 0.5f * cosf(i * 0.7f), 0.5f + 0.5f * cosf(i * 0.7f + 2.1f), 0.5f + 0.5f * cosf(i * 0.7f + 4.2f) };
+			l.range = 0.75f;
+			l.positionSpin = (i & 1) ? 0.0f : 0.5f / radius;
+			lights.Add(l);
+		}
+	}
+
+	// Describe this frame as a list of views, the render graph works out the order they run in.
+	void BuildViews(RGResource backBufferRes)
+	{
+		views.clear();
+		XMVECTOR det;
+
+		// Main camera, the view matrix is kept inverted for the camera controls.
+		RenderView mainView;
+		mainView.name = "Main";
+		mainView.viewport = vp_one;
+		mainView.view = XMMatrixInverse(&det, frame->camera);
+		mainView.projection = frame->projection;
+		mainView.target = backBufferRes;
+		mainView.clearDepth = true;
+
+		// Below full scale the main view draws into the top left of a full size texture, so changing the scale
+		// never needs a new one. The swap chain's depth buffer is the same size, so it's still the one used.
+		sceneColor = RG_INVALID;
+		if (dynamicResolution && dynamicRes.Scale() < 1.0f)
+		{
+			RGTextureDesc sceneDesc;
+			sceneDesc.width = (unsigned int)vp_one.Width;
+			sceneDesc.height = (unsigned int)vp_one.Height;
+			sceneDesc.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			sceneDesc.bindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+			sceneColor = graph.CreateTexture("SceneColor", sceneDesc);
+
+			mainView.viewport.Width = (float)dynamicRes.Scaled(sceneDesc.width);
+			mainView.viewport.Height = (float)dynamicRes.Scaled(sceneDesc.height);
+			mainView.target = sceneColor;
+			// Same blue main.cpp clears the back buffer to.
+			mainView.clearTarget = true;
+			mainView.clearColor[0] = mainView.clearColor[1] = 0.2f;
+			mainView.clearColor[2] = 0.4f;
+		}
+		views.push_back(mainView);
+
+		// Top down second viewport
+		RenderView minimap;
+		minimap.name = "Minimap";
+		minimap.viewport = vp_two;
+		minimap.view = vp_two_View;
+		minimap.projection = vp_two_Projection;
+		minimap.target = backBufferRes;
+		minimap.clearDepth = true;
+		views.push_back(minimap);
+
+		// The RTT target only needs as many pixels as the cube covers in the views that can see it.
+		float footprint = 0.0f;
+		XMFLOAT3 cubeCenter = { posRTTCube.x, posRTTCube.y, posRTTCube.z };
+		XMFLOAT3 cubeExtents = { rttCubeScale, rttCubeScale, rttCubeScale };
+		for (RenderView& rv : views)
+		{
+			rv.visibleMask = CullScene(rv.view, rv.projection);
+			if ((rv.drawFlags & VIEW_DRAW_RTT_CUBE) && (rv.visibleMask & (1u << OBJ_RTT_CUBE)))
+				footprint = fmaxf(footprint, ProjectedFootprint(rv.view * rv.projection, cubeCenter, cubeExtents,
+					rv.viewport.Width, rv.viewport.Height));
+		}
+
+		// Spinning the mesh is redrawn right away, the slow light animation can wait a couple of frames.
+		XMFLOAT4X4 world;
+		XMStoreFloat4x4(&world, scene.world);
+		bool meshMoved = memcmp(&world, &rttWorld, sizeof(world)) != 0;
+		bool redraw = rttTarget.Update(graphBackend, rttPool, footprint, meshMoved);
+		if (rttTarget.Target() == nullptr)
+			return;
+
+		// Imported, so what was drawn last time is still there on the frames it isn't redrawn. Not an output: the RTT
+		// pass is kept only through the views that read it, the frames it's up to date are skipped below.
+		RGResource rttColor = graph.ImportTexture("RTTColor", rttTarget.Target(), false);
+		for (RenderView& rv : views)
+		{
+			if ((rv.drawFlags & VIEW_DRAW_RTT_CUBE) && (rv.visibleMask & (1u << OBJ_RTT_CUBE)))
+				rv.sampled = rttColor;
+		}
+		if (!redraw)
+			return;
+		rttWorld = world;
+
+		// Offscreen scene shown on the RTT cube, with a depth buffer of its own size from the graph's pool.
+		RGTextureDesc depthDesc;
+		depthDesc.width = depthDesc.height = rttTarget.Size();
+		depthDesc.format = DXGI_FORMAT_D32_FLOAT;
+		depthDesc.bindFlags = D3D11_BIND_DEPTH_STENCIL;
+
+		RenderView rtt;
+		rtt.name = "RTT";
+		rtt.viewport = { 0.0f, 0.0f, (float)rttTarget.Size(), (float)rttTarget.Size(), 0.0f, 1.0f };
+		rtt.view = rtt_View;
+		rtt.projection = rtt_Projection;
+		rtt.target = rttColor;
+		rtt.depth = graph.CreateTexture("RTTDepth", depthDesc);
+		rtt.clearTarget = true;
+		rtt.clearDepth = true;
+		for (int i = 0; i < 4; i++)
+			rtt.clearColor[i] = clr[i];
+		rtt.drawFlags = VIEW_DRAW_MESH;
+		rtt.visibleMask = CullScene(rtt.view, rtt.projection);
+		views.push_back(rtt);
+	}
+
+	// The PSPermutation variant for key. Anything not made at startup is compiled here the first time it's asked for,
+	// which is a cache hit once -buildshadercache has run. A variant that fails is remembered as null and draws nothing.
+	ID3D11PixelShader* PixelPermutation(uint32_t key)
+	{
+		key = CanonicalPermutation(key);
+		auto found = shaderSet.pixelPermutations.find(key);
+		if (found != shaderSet.pixelPermutations.end())
+			return found->second.Get();
+
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>& slot = shaderSet.pixelPermutations[key];
+		std::vector<uint8_t> blob;
+		if (CompileShaderCached(shaderPath, shaderSource, "PSPermutation", "ps_4_0", PermutationDefines(key), blob))
+			device->CreatePixelShader(blob.data(), blob.size(), nullptr, slot.GetAddressOf());
 		else
-			con->RSSetViewports(1, &vp_two);
+			std::cout << "Shader PSPermutation [" << PermutationDefines(key) << "] failed to compile\n";
+		return slot.Get();
+	}
+
+	// One job per entry point in shaders.fx, creating into out. The device is free threaded, so shaders and the
+	// input layouts that need their VS blob are created right on the worker as each compile finishes.
+	static void QueueShaderJobs(ShaderBatch& batch, ID3D11Device* dev, MeshShaders& out, const std::vector<uint32_t>& permutations)
+	{
+		// Define the input layout
+		static const D3D11_INPUT_ELEMENT_DESC layout[] =
+		{
+			{ "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		};
+		batch.Add("VS", "vs_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
+		{
+			return SUCCEEDED(dev->CreateVertexShader(blob.data(), blob.size(), nullptr, out.vertexshader.GetAddressOf())) &&
+				SUCCEEDED(dev->CreateInputLayout(layout, ARRAYSIZE(layout), blob.data(), blob.size(), out.input.GetAddressOf()));
+		});
 
-		// Set Primitive Topology
-		con->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		// Vertex shader for the wave.
+		batch.Add("VSWave", "vs_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
+		{
+			return SUCCEEDED(dev->CreateVertexShader(blob.data(), blob.size(), nullptr, out.vertexshaderwave.GetAddressOf()));
+		});
 
-		// Update the point light for attenuation
-		if (!doFlip)
+		// The grid, made from SV_VertexID so there's no input layout.
+		batch.Add("GridVS", "vs_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
 		{
-			// Point Light
-			lightClr[1].y -= t;
-			lightClr[1].z -= t;
-			// Spot Light
-			//cone -= t;
+			return SUCCEEDED(dev->CreateVertexShader(blob.data(), blob.size(), nullptr, out.gridVS.GetAddressOf()));
+		});
 
-			if(!XMVector3GreaterOrEqual({ lightClr[1].x, lightClr[1].y, lightClr[1].z }, { 0.0f,0.1f,0.1f }))
-				doFlip = true;
-		}
-		else if (doFlip)
+		// Only the position is read out of the SimpleVertex stream, plus the rock instance.
+		static const D3D11_INPUT_ELEMENT_DESC depthLayout[] =
 		{
-			// Point Light
-			lightClr[1].y += t;
-			lightClr[1].z += t;
-			// Spot Light
-			//cone += t;
+			{ "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "INSTANCE", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		};
+		batch.Add("VSDepth", "vs_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
+		{
+			return SUCCEEDED(dev->CreateVertexShader(blob.data(), blob.size(), nullptr, out.vertexshaderDepth.GetAddressOf())) &&
+				SUCCEEDED(dev->CreateInputLayout(depthLayout, ARRAYSIZE(depthLayout), blob.data(), blob.size(), out.depthInput.GetAddressOf()));
+		});
+
+		// Same as the mesh layout with the rock instance coming in on slot 1, once per instance.
+		static const D3D11_INPUT_ELEMENT_DESC instancedLayout[] =
+		{
+			{ "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "BAKED", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "INSTANCE", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		};
+		batch.Add("VSInstanced", "vs_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
+		{
+			return SUCCEEDED(dev->CreateVertexShader(blob.data(), blob.size(), nullptr, out.vertexshaderInstanced.GetAddressOf())) &&
+				SUCCEEDED(dev->CreateInputLayout(instancedLayout, ARRAYSIZE(instancedLayout), blob.data(), blob.size(), out.instancedInput.GetAddressOf()));
+		});
+
+		// Sky, a triangle from SV_VertexID so there's no input layout.
+		batch.Add("SkyVS", "vs_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
+		{
+			return SUCCEEDED(dev->CreateVertexShader(blob.data(), blob.size(), nullptr, out.skyVS.GetAddressOf()));
+		});
+
+		// Wave Geometry Shader
+		batch.Add("GSWave", "gs_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
+		{
+			return SUCCEEDED(dev->CreateGeometryShader(blob.data(), blob.size(), nullptr, out.geoshaderwave.GetAddressOf()));
+		});
 
-			if (XMVector3GreaterOrEqual({ lightClr[1].x, lightClr[1].y, lightClr[1].z }, { 0.0f, 0.9f, 0.9f }))
-				doFlip = false;
+		// Pixel shader permutations. The map slots are made here, before any job runs, so each job only touches its own.
+		for (uint32_t key : permutations)
+		{
+			Microsoft::WRL::ComPtr<ID3D11PixelShader>* slot = &out.pixelPermutations[CanonicalPermutation(key)];
+			batch.Add("PSPermutation", "ps_4_0", [dev, slot](const std::vector<uint8_t>& blob) -> bool
+			{
+				return SUCCEEDED(dev->CreatePixelShader(blob.data(), blob.size(), nullptr, slot->GetAddressOf()));
+			}, PermutationDefines(key));
 		}
 
-		// Rotate the directional light around the origin
-		if (!moveDirLight)
+		// Other pixel shaders
+		batch.Add("PSUnique", "ps_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
+		{
+			return SUCCEEDED(dev->CreatePixelShader(blob.data(), blob.size(), nullptr, out.pixelshaderUnique.GetAddressOf()));
+		});
+		batch.Add("SkyPS", "ps_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
+		{
+			return SUCCEEDED(dev->CreatePixelShader(blob.data(), blob.size(), nullptr, out.skyPS.GetAddressOf()));
+		});
+
+		// Fullscreen passes, the triangle is made from SV_VertexID so there's no input layout.
+		batch.Add("FullscreenVS", "vs_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
+		{
+			return SUCCEEDED(dev->CreateVertexShader(blob.data(), blob.size(), nullptr, out.fullscreenVS.GetAddressOf()));
+		});
+		batch.Add("UpscalePS", "ps_4_0", [dev, &out](const std::vector<uint8_t>& blob) -> bool
+		{
+			return SUCCEEDED(dev->CreatePixelShader(blob.data(), blob.size(), nullptr, out.upscalePS.GetAddressOf()));
+		});
+	}
+
+	static void PrintShaderFailures(const ShaderBatch& batch)
+	{
+		for (const std::string& failed : batch.Failed())
+			std::cout << "Shader " << failed << "\n";
+	}
+
+	// Edit the copy next to the sources when the build tells us where it is, otherwise the one we loaded.
+	static std::string ShaderWatchDirectory()
+	{
+#ifdef SHADER_SOURCE_DIR
+		std::vector<uint8_t> probe;
+		if (ShaderCache::ReadFile(std::string(SHADER_SOURCE_DIR) + "/shaders.fx", probe))
+			return SHADER_SOURCE_DIR;
+#endif
+		return "Shaders";
+	}
+
+	// Swaps in a finished reload, or starts one if shaders.fx changed. The old shaders stay bound on failure.
+	void HotReloadShaders()
+	{
+		if (reloading)
 		{
-			XMMATRIX mRotate = XMMatrixRotationY(0.2f * t);
-			XMVECTOR vLightDir = XMLoadFloat4(&lightDir[0]);
-			vLightDir = XMVector3Transform(vLightDir, mRotate);
-			XMStoreFloat4(&lightDir[0], vLightDir);
+			if (!reloadDone)
+				return;
+			reloading = false;
+			if (reloadOk)
+			{
+				shaderSet = *reloadSet;
+				// The cached pipelines point at the shaders that were just released.
+				pipelines.Clear();
+				pipelineState.Invalidate();
+				shaderPath = reloadPath;
+				shaderSource = reloadSource;
+				std::cout << "[NOT AN ERROR] Reloaded shaders.fx\n|\n";
+			}
+			else
+			{
+				PrintShaderFailures(*reloadBatch);
+				std::cout << "Kept the previous shaders\n|\n";
+			}
+			reloadBatch.reset();
+			reloadSet.reset();
 		}
 
-		// Rotate the positional light around the origin
-		XMMATRIX mRotate = XMMatrixRotationY(-1.0f * t);
-		XMVECTOR vLightDir = XMLoadFloat4(&lightDir[1]);
-		vLightDir = XMVector3Transform(vLightDir, mRotate);
-		XMStoreFloat4(&lightDir[1], vLightDir);
+		bool changed = false;
+		for (const std::string& file : watcher.Poll())
+			changed |= file.empty() || file == "shaders.fx";
+		if (!changed)
+			return;
 
-		// Rotate the spotlight's position
-		mRotate = XMMatrixRotationY(-0.1f * t);
-		vLightDir = XMLoadFloat4(&spotlightPos);
-		vLightDir = XMVector3Transform(vLightDir, mRotate);
-		XMStoreFloat4(&spotlightPos, vLightDir);
+		// Saving without changes (or a change notification for something else) costs nothing.
+		if (!ReadShaderSource(ShaderWatchDirectory() + "/shaders.fx", reloadPath, reloadSource))
+			return;
+		uint64_t hash = HashBytes(reloadSource.data(), reloadSource.size());
+		if (hash == shaderSourceHash)
+			return;
+		shaderSourceHash = hash;
+
+		// Compile and create off the frame thread into a fresh set, nothing bound changes until it's all done.
+		reloadSet.reset(new MeshShaders());
+		reloadBatch.reset(new ShaderBatch());
+		std::vector<uint32_t> inUse;
+		for (const auto& permutation : shaderSet.pixelPermutations)
+			inUse.push_back(permutation.first);
+		QueueShaderJobs(*reloadBatch, device.Get(), *reloadSet, inUse);
+		reloading = true;
+		reloadDone = false;
+		reloadWorker.BranchSingular([this]()
+		{
+			reloadOk = reloadBatch->RunSerial([this](const std::string& entry, const std::string& profile, const std::string& defines, std::vector<uint8_t>& blob)
+			{
+				return CompileShaderCached(reloadPath, reloadSource, entry, profile, defines, blob);
+			});
+			reloadDone = true;
+		});
+	}
 
-		// Rotate the direction
-		mRotate = XMMatrixRotationY(2.0f * t);
-		vLightDir = XMLoadFloat4(&lightDir[2]);
-		vLightDir = XMVector3Transform(vLightDir, mRotate);
-		XMStoreFloat4(&lightDir[2], vLightDir);
+	// Instance 0 is the mesh, the rest are the rocks.
+	UINT MeshInstanceCount(bool rocks) const
+	{
+		return rocks ? (UINT)rockInstances.size() : 1;
+	}
 
-		// Constant Buffer to communicate with the shader's values on the GPU
-		ConstantBuffer cb;
-		cb.mWorld = XMMatrixTranspose(g_World);
-		XMVECTOR det;
-		if (flag == 1)
-			cb.mView = XMMatrixTranspose(XMMatrixInverse(&det, g_View));
-		else
-			cb.mView = XMMatrixTranspose(g_View);
-		cb.mProjection = XMMatrixTranspose(g_Projection);
-		// Directional Light [0]
-		cb.lightDir[0] = lightDir[0];
-		cb.lightClr[0] = lightClr[0];
-		// Point Light [1]
-		cb.lightDir[1] = lightDir[1];
-		cb.lightClr[1] = lightClr[1];
-		// Spot Light [2]
-		cb.lightDir[2] = lightDir[2];
-		cb.lightClr[2] = lightClr[2];
-		cb.spotLightPos = spotlightPos;
-		cb.vOutputColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-		cb.time = tTotal;
-		cb.cone = cone;
-		con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
+	// All of it while the sun points where the mesh was baked for, fading out over the first couple of degrees away.
+	float BakedSunWeight() const
+	{
+		if (mesh == nullptr || !mesh->baked)
+			return 0.0f;
+		float cosAngle = XMVectorGetX(XMVector3Dot(XMVector3Normalize(XMLoadFloat4(&scene.lightDir[0])), XMVector3Normalize(XMLoadFloat3(&mesh->bakedSunDir))));
+		return fminf(fmaxf((cosAngle - 0.999f) / 0.001f, 0.0f), 1.0f);
+	}
 
-		// Unique Constant Buffer to communicate for unique PS
-		UniqueBuffer ub;
-		ub.timePos = { tUpToOne, 0, 0, 0};
-		con->UpdateSubresource(u_constantbuffer.Get(), 0, nullptr, &ub, 0, 0);
+	// Depth only draw of StoneHenge: position and instance streams, no pixel shader.
+	void RenderMeshDepth(ID3D11DeviceContext* con, bool rocks)
+	{
+		if (!visible[OBJ_MESH])
+			return;
 
-		// Render the mesh
-		// Set vertex buffer
-		const UINT stride[] = { sizeof(SimpleVertex) };
-		const UINT offset[] = { 0 };
-		ID3D11Buffer* const buffs[] = { vertexbuffer.Get() };
+		const UINT stride[] = { sizeof(SimpleVertex), sizeof(RockInstance) };
+		const UINT offset[] = { 0, 0 };
+		ID3D11Buffer* const buffs[] = { vertexbuffer.Get(), instancebuffer.Get() };
 		con->IASetVertexBuffers(0, ARRAYSIZE(buffs), buffs, stride, offset);
-
-		// Set Index Buffer
 		con->IASetIndexBuffer(indexbuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
-		// Set Vertex Shader
-		con->VSSetShader(vertexshader.Get(), nullptr, 0);
+		BindPipeline(con, MakePipeline(shaderSet.vertexshaderDepth.Get(), nullptr, shaderSet.depthInput.Get(),
+			D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, depthPrepassState.Get()));
 		con->VSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-		// Set the Geometry Shader
-		con->GSSetShader(geoshader.Get(), 0, 0);
-		con->GSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-		// Set Pixel Shader
-		con->PSSetShader(pixelshader.Get(), nullptr, 0);
-		con->PSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-		con->PSSetShaderResources(0, 1, textureRV.GetAddressOf());
-		con->PSSetShaderResources(1, 1, normRV.GetAddressOf());
-		con->PSSetSamplers(0, 1, samplerLinear.GetAddressOf());
-		// Draw out the mesh
-		//con->DrawIndexed(mesh->indicesList.size(), 0, 0);
 
-		// Reset Geometry Shader so it doesn't affect everything else.
-		con->GSSetShader(nullptr, 0, 0);
+		con->DrawIndexedInstanced(mesh->indicesList.size(), MeshInstanceCount(rocks), 0, 0, 0);
+	}
+
+	// Draw out StoneHenge, optionally with the instanced rocks.
+	void RenderMesh(ID3D11DeviceContext* con, ConstantBuffer& cb, bool rocks)
+	{
+		if (!visible[OBJ_MESH])
+			return;
 
-		if(flag == 1)
-			DrawBehind(con, view, cb, mesh->indicesList.size());
+		// Pixel shader picked by which features are switched on. With a pre-pass only the visible surface gets through to it.
+		BindPipeline(con, MakePipeline(shaderSet.vertexshaderInstanced.Get(), PixelPermutation(meshPermutation), shaderSet.instancedInput.Get(),
+			D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, depthPrepass ? depthShadeState.Get() : nullptr));
+
+		// Set vertex and instance buffers
+		const UINT stride[] = { sizeof(SimpleVertex), sizeof(RockInstance) };
+		const UINT offset[] = { 0, 0 };
+		ID3D11Buffer* const buffs[] = { vertexbuffer.Get(), instancebuffer.Get() };
+		con->IASetVertexBuffers(0, ARRAYSIZE(buffs), buffs, stride, offset);
 
 		// Set Index Buffer
 		con->IASetIndexBuffer(indexbuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
-		// Set Vertex Shader
-		con->VSSetShader(vertexshader.Get(), nullptr, 0);
 		con->VSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-		// Set the Geometry Shader
-		con->GSSetShader(geoshader.Get(), 0, 0);
-		con->GSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-		// Set Pixel Shader
-		con->PSSetShader(pixelshader.Get(), nullptr, 0);
 		con->PSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
 		con->PSSetShaderResources(0, 1, textureRV.GetAddressOf());
 		con->PSSetShaderResources(1, 1, normRV.GetAddressOf());
 		con->PSSetSamplers(0, 1, samplerLinear.GetAddressOf());
 
-		// Draw out the mesh
-		con->DrawIndexed(mesh->indicesList.size(), 0, 0);
+		// Draw out the mesh and its rocks
+		con->DrawIndexedInstanced(mesh->indicesList.size(), MeshInstanceCount(rocks), 0, 0, 0);
+	}
 
-		// Reset Geometry Shader so it doesn't affect everything else.
-		con->GSSetShader(nullptr, 0, 0);
+	// Count how much overdraw the mesh and its rocks have from the main camera, printed to the console.
+	void PrintOverdraw()
+	{
+		if (frame == nullptr || frame->number == 0)
+			return;
+		XMVECTOR det;
+		XMMATRIX viewProj = XMMatrixInverse(&det, frame->camera) * frame->projection;
+		overdraw.Resize(clientWidth / 4, clientHeight / 4);
+		overdraw.Clear();
+		// Same order as the instanced draw. The rocks' clip plane is ignored, so this slightly over counts them.
+		for (const RockInstance& inst : rockInstances)
+		{
+			overdraw.AddMesh(&mesh->vertexList[0].Pos, sizeof(SimpleVertex), (unsigned int)mesh->vertexList.size(),
+				mesh->indicesList.data(), (unsigned int)mesh->indicesList.size(), scene.world * RockInstanceMatrix(inst) * viewProj);
+		}
+		OverdrawStats stats = overdraw.Stats();
 
-		// Render the light sources as cubes (So they are visible)
+		std::cout << "[NOT AN ERROR] Overdraw (1/4 res): depth complexity " << stats.DepthComplexity()
+			<< ", shaded fragments " << stats.shadedNoPrepass << " without pre-pass vs " << stats.shadedPrepass
+			<< " with (" << (depthPrepass ? "ON" : "OFF") << ")\n|\n";
+	}
+
+	// Render the light sources as cubes (So they are visible)
+	void RenderLights(ID3D11DeviceContext* con, ConstantBuffer& cb)
+	{
 		// Set vertex buffer
 		const UINT c_stride[] = { sizeof(SimpleVertex) };
 		const UINT c_offset[] = { 0 };
@@ -1105,122 +1576,405 @@ public:
 		// Set Index Buffer
 		con->IASetIndexBuffer(c_indexbuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
+		con->VSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
+
 		// Render the lighting sources as a cube.
 		for (int i = 0; i < 3; i++)
 		{
+			if (!visible[OBJ_DIR_LIGHT + i])
+				continue;
+
 			// Directional Light
 			if (i == 0)
 			{
-				XMMATRIX mLight = XMMatrixTranslationFromVector(5.0f * XMLoadFloat4(&lightDir[i]));
+				XMMATRIX mLight = XMMatrixTranslationFromVector(5.0f * XMLoadFloat4(&scene.lightDir[i]));
 				XMMATRIX mLightScale = XMMatrixScaling(0.2f, 0.2f, 0.2f);
 				mLight = mLightScale * mLight;
 
 				// Update the world variable to reflect the current light
 				cb.mWorld = XMMatrixTranspose(mLight);
-				cb.vOutputColor = lightClr[i];
+				cb.vOutputColor = scene.lightClr[i];
 				con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
 
 				// Update PS's constant buffer to unique
 				con->PSSetConstantBuffers(1, 1, u_constantbuffer.GetAddressOf());
-				con->PSSetShader(pixelshaderUnique.Get(), nullptr, 0);
+				BindPipeline(con, MakePipeline(shaderSet.vertexshader.Get(), shaderSet.pixelshaderUnique.Get(), shaderSet.input.Get()));
 			}
 			// Positional Light
 			else if (i == 1)
 			{
-				XMMATRIX mLight = XMMatrixTranslationFromVector(1.0f * XMLoadFloat4(&lightDir[i]));
+				XMMATRIX mLight = XMMatrixTranslationFromVector(1.0f * XMLoadFloat4(&scene.lightDir[i]));
 				XMMATRIX mLightScale = XMMatrixScaling(0.05f, 0.05f, 0.05f);
 				mLight = mLightScale * mLight;
 
 				// Update the world variable to reflect the current light
 				cb.mWorld = XMMatrixTranspose(mLight);
-				cb.vOutputColor = lightClr[i];
+				cb.vOutputColor = scene.lightClr[i];
 				con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
 
 				// Be sure the constant buffer is still the contsant buffer.
 				con->PSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-				con->PSSetShader(pixelshaderSolid.Get(), nullptr, 0);
+				BindPipeline(con, MakePipeline(shaderSet.vertexshader.Get(), PixelPermutation(PERM_SOLID), shaderSet.input.Get()));
 			}
 			// Spot Light
 			else
 			{
-				XMMATRIX mLight = XMMatrixTranslationFromVector(1.0f * XMLoadFloat4(&spotlightPos));
+				XMMATRIX mLight = XMMatrixTranslationFromVector(1.0f * XMLoadFloat4(&scene.spotlightPos));
 				XMMATRIX mLightScale = XMMatrixScaling(0.05f, 0.05f, 0.05f);
 				mLight = mLightScale * mLight;
 
 				// Update the world variable to reflect the current light
 				cb.mWorld = XMMatrixTranspose(mLight);
-				cb.vOutputColor = lightClr[i];
+				cb.vOutputColor = scene.lightClr[i];
 				con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
 
 				// Be sure the constant buffer is still the contsant buffer.
 				con->PSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-				con->PSSetShader(pixelshaderSolid.Get(), nullptr, 0);
+				BindPipeline(con, MakePipeline(shaderSet.vertexshader.Get(), PixelPermutation(PERM_SOLID), shaderSet.input.Get()));
 			}
 
 			con->DrawIndexed(36, 0, 0);
 		}
+	}
+
+	// Render the Skybox as one triangle over the view, after everything else so it's only shaded where nothing was drawn.
+	void RenderSkybox(ID3D11DeviceContext* con, const RenderView& rv, ConstantBuffer& cb)
+	{
+		// The sky is infinitely far away, so only the view's rotation matters; World carries the inverse for SkyVS.
+		XMMATRIX rotation = rv.view;
+		rotation.r[3] = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+		XMVECTOR det;
+		cb.mWorld = XMMatrixTranspose(XMMatrixInverse(&det, rotation * rv.projection));
+		cb.vOutputColor = { 1.0f, 1.0f, 1.0f, 1.0f };
+		con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
+
+		BindPipeline(con, MakePipeline(shaderSet.skyVS.Get(), shaderSet.skyPS.Get(), nullptr,
+			D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, skyDepthState.Get()));
+		con->VSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
+		con->PSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
 
-		// Render the Skybox
+		con->Draw(3, 0);
+	}
+
+	// Fit every shadow map to this frame's main camera and lights.
+	void FitShadows()
+	{
+		XMVECTOR det;
+		shadows.FitCascades(XMMatrixInverse(&det, frame->camera), frame->projection, frame->nearP, frame->farP, XMLoadFloat4(&scene.lightDir[0]));
+		const ClusterLight& spot = frame->lights[frame->spotSlot];
+		shadows.FitSpot(XMLoadFloat3(&spot.position), XMLoadFloat3(&spot.direction), spot.spotCos, spot.range);
+	}
+
+	// Depth only draws into each map's tile of the atlas, instanced over only the casters that map can see.
+	void RenderShadowMaps(ID3D11DeviceContext* con)
+	{
+		D3D11GraphTexture* atlas = D3D11RenderGraphBackend::Get(graph, shadowAtlas);
+		D3D11ShadowResources::Unbind(con);
+		con->OMSetRenderTargets(0, nullptr, atlas->dsv.Get());
+		con->ClearDepthStencilView(atlas->dsv.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+		// Culling and pipeline lookups happen here, the jobs only read.
+		PipelineId mapPipelines[SHADOW_MAP_COUNT];
+		unsigned int mapFirst[SHADOW_MAP_COUNT];	// Where each map's casters start in shadowInstances
+		unsigned int casterCount = 0;
+		shadowJobs.clear();
+		for (unsigned int map = 0; map < SHADOW_MAP_COUNT; map++)
+		{
+			shadows.CullCasters(shadowCasters, map, shadowCasterLists[map]);
+			mapFirst[map] = casterCount;
+			casterCount += (unsigned int)shadowCasterLists[map].size();
+			PipelineDesc desc = MakePipeline(shaderSet.vertexshaderDepth.Get(), nullptr, shaderSet.depthInput.Get(),
+				D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, shadowDepthState.Get());
+			desc.rasterizerState = shadowResources.Rasterizer(map);
+			mapPipelines[map] = pipelines.Get(desc);
+			for (unsigned int first = 0; first < shadowCasterLists[map].size(); first += shadowJobSize)
+				shadowJobs.push_back({ map, first, std::min(shadowJobSize, (unsigned int)shadowCasterLists[map].size() - first) });
+		}
+
+		if (casterCount == 0)
+			return;
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		if (FAILED(con->Map(shadowInstances.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+			return;
+		RockInstance* kept = static_cast<RockInstance*>(mapped.pData);
+		for (unsigned int map = 0; map < SHADOW_MAP_COUNT; map++)
 		{
-			XMFLOAT4 skyPos = {0, 0, 0, 0};
-			XMMATRIX mSky = XMMatrixTranslationFromVector(1.0f * XMLoadFloat4(&skyPos));
-			XMMATRIX mScaleSky = XMMatrixScaling(1.0f, 2.0f, 1.0f);
-			mSky = mScaleSky * mSky;
+			for (unsigned int caster : shadowCasterLists[map])
+				*kept++ = rockInstances[caster];
+		}
+		con->Unmap(shadowInstances.Get(), 0);
 
-			// Update world variable for skybox
-			cb.mWorld = XMMatrixTranspose(mSky);
-			cb.vOutputColor = { 1.0f, 1.0f, 1.0f, 1.0f };
-			con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
-			con->PSSetShaderResources(2, 1, SKBtextureRV.GetAddressOf());
+		// Every job sets its own tile, pipeline and matrices, so each list stands alone.
+		UINT indexCount = (UINT)mesh->indicesList.size();
+		RecordCommands(shadowStreams, (unsigned int)shadowJobs.size(), 0,
+			[this, &mapPipelines, &mapFirst, indexCount](unsigned int j, CommandStream& stream)
+			{
+				const ShadowJob& job = shadowJobs[j];
+				unsigned int rect[4];
+				shadows.TileRect(job.map, rect);
+				stream.SetViewport((float)rect[0], (float)rect[1], (float)rect[2], (float)rect[3]);
+				stream.SetPipeline(mapPipelines[job.map]);
+
+				ConstantBuffer cb = {};
+				cb.mWorld = XMMatrixTranspose(scene.world);
+				cb.mView = XMMatrixTranspose(shadows.Map(job.map).view);
+				cb.mProjection = XMMatrixTranspose(shadows.Map(job.map).projection);
+				stream.SetConstants(&cb, sizeof(cb));
+
+				stream.DrawIndexed(indexCount, job.count, 0, 0, mapFirst[job.map] + job.first);
+			});
+
+		shadowLists.Execute(device.Get(), con, shadowStreams, (unsigned int)shadowJobs.size(), pipelines, constantbuffer.Get(), 0,
+			[this, atlas](ID3D11DeviceContext* c)
+			{
+				c->OMSetRenderTargets(0, nullptr, atlas->dsv.Get());
+				const UINT stride[] = { sizeof(SimpleVertex), sizeof(RockInstance) };
+				const UINT offset[] = { 0, 0 };
+				ID3D11Buffer* const buffs[] = { vertexbuffer.Get(), shadowInstances.Get() };
+				c->IASetVertexBuffers(0, ARRAYSIZE(buffs), buffs, stride, offset);
+				c->IASetIndexBuffer(indexbuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+				c->VSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
+			});
+		pipelineState.Invalidate();
+	}
 
-			// Update vertex and pixel shader for skybox.
-			con->VSSetShader(SKBvertexshader.Get(), nullptr, 0);
-			con->VSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-			con->PSSetShader(SKBpixelshader.Get(), nullptr, 0);
-			con->PSSetConstantBuffers(0, 1, constantbuffer.GetAddressOf());
-			
-			con->IASetInputLayout(SKBinput.Get());
-			con->OMSetDepthStencilState(depthStencilState.Get(), 0);
-			con->DrawIndexed(36, 0, 0);
-			con->OMSetDepthStencilState(NULL, 0);
+	// Bind the view's target and re-submit the draws it asked for, nothing here animates.
+	void DrawView(ID3D11DeviceContext* con, ID3D11RenderTargetView* view, const RenderView& rv)
+	{
+		// Views without a depth texture of their own share the swap chain's.
+		ID3D11DepthStencilView* depthview = nullptr;
+		if (rv.depth != RG_INVALID)
+			depthview = D3D11RenderGraphBackend::Get(graph, rv.depth)->dsv.Get();
+		else
+		{
+			+d3d11.GetDepthStencilView((void**)&depthview);
+			depthview->Release();
 		}
-		//DrawBehind(con, view, cb, 36);
-		con->IASetInputLayout(input.Get());
 
-		// Render the Grid
-		RenderGrid(con, view, cb);
+		ID3D11RenderTargetView* target = D3D11RenderGraphBackend::Get(graph, rv.target)->rtv.Get();
+		con->OMSetRenderTargets(1, &target, depthview);
+		if (rv.clearTarget)
+			con->ClearRenderTargetView(target, rv.clearColor);
+		if (rv.clearDepth)
+			con->ClearDepthStencilView(depthview, D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+		// Set the viewport.
+		con->RSSetViewports(1, &rv.viewport);
+
+		// Constant Buffer to communicate with the shader's values on the GPU
+		ConstantBuffer cb;
+		cb.mWorld = XMMatrixTranspose(scene.world);
+		cb.mView = XMMatrixTranspose(rv.view);
+		cb.mProjection = XMMatrixTranspose(rv.projection);
+		// Directional Light [0], Point Light [1], Spot Light [2]
+		for (int i = 0; i < 3; i++)
+		{
+			cb.lightDir[i] = scene.lightDir[i];
+			cb.lightClr[i] = scene.lightClr[i];
+		}
+		cb.spotLightPos = scene.spotlightPos;
+		cb.vOutputColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+		cb.time = scene.time;
+		cb.cone = scene.cone;
+		cb.bakedSun = BakedSunWeight();
+		con->UpdateSubresource(constantbuffer.Get(), 0, nullptr, &cb, 0, 0);
+
+		// The sky's cube map, the reflective draws sample it too and the sky itself now comes last.
+		con->PSSetShaderResources(2, 1, SKBtextureRV.GetAddressOf());
+
+		// What this view can actually see was worked out when the views were built.
+		SetVisible(rv.visibleMask);
+
+		if (rv.drawFlags & VIEW_DRAW_MESH)
+		{
+			// Only the mesh is lit by the clusters, so only views that draw it bin lights.
+			if (meshPermutation & PERM_CLUSTERED)
+			{
+				clusterBinner.Configure(rv.projection, frame->nearP, frame->farP);
+				clusterBinner.Bin(frame->lights, rv.view);
+				clusterBuffers.UploadClusters(device.Get(), con, clusterBinner);
+				clusterBuffers.Bind(con);
+			}
+			if (shadowAtlas != RG_INVALID)
+				shadowResources.Bind(con, D3D11RenderGraphBackend::Get(graph, shadowAtlas)->srv.Get());
+			if (depthPrepass)
+				RenderMeshDepth(con, (rv.drawFlags & VIEW_DRAW_ROCKS) != 0);
+			RenderMesh(con, cb, (rv.drawFlags & VIEW_DRAW_ROCKS) != 0);
+		}
+
+		if (rv.drawFlags & VIEW_DRAW_LIGHTS)
+			RenderLights(con, cb);
+
+		// Render the Grid, or the terrain in its place
+		if ((rv.drawFlags & VIEW_DRAW_GRID) && terrainOn)
+			RenderTerrain(con, rv, cb);
+		else if (rv.drawFlags & VIEW_DRAW_GRID)
+			RenderGrid(con, view, cb);
 
-		//renderReflectionCube(con, view, cb);
-		
 		// Render stone henge cube out.
-		RenderRTT(con, view, cb, 36);
+		if (rv.sampled != RG_INVALID)
+			RenderRTT(con, D3D11RenderGraphBackend::Get(graph, rv.sampled)->srv.Get(), cb, 36);
+
+		// Sky last, it only fills in behind everything drawn above.
+		if (rv.drawFlags & VIEW_DRAW_SKYBOX)
+			RenderSkybox(con, rv, cb);
+	}
 
-		// First passthrough for first VP.
-		if (flag == 1)
+	// Stretches the corner of sceneColor the main view drew into over the whole back buffer.
+	void RenderUpscale(ID3D11DeviceContext* con, RGResource backBufferRes, const RenderView& source)
+	{
+		ID3D11RenderTargetView* target = D3D11RenderGraphBackend::Get(graph, backBufferRes)->rtv.Get();
+		con->OMSetRenderTargets(1, &target, nullptr);
+		con->RSSetViewports(1, &vp_one);
+
+		BindPipeline(con, MakePipeline(shaderSet.fullscreenVS.Get(), shaderSet.upscalePS.Get(), nullptr));
+		upscaleResources.Bind(con, D3D11RenderGraphBackend::Get(graph, sceneColor)->srv.Get(),
+			(unsigned int)source.viewport.Width, (unsigned int)source.viewport.Height, (unsigned int)vp_one.Width, (unsigned int)vp_one.Height);
+		con->Draw(3, 0);
+
+		// sceneColor is drawn into again next frame.
+		ID3D11ShaderResourceView* none = nullptr;
+		con->PSSetShaderResources(0, 1, &none);
+	}
+
+	void Render()
+	{
+		if (mesh == nullptr)
+			return;
+		std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+		// Frame boundary, the only place shaders get swapped.
+		HotReloadShaders();
+
+		// Anything outside the mesh may have touched the context since last frame.
+		pipelineState.Invalidate();
+
+		// Draw the newest frame the update thread has finished, or the last one again if there isn't a new one
+		// yet. Animate here first when there's no update thread.
+		if (!updateThread.joinable())
+			Simulate();
+		if (frames.Acquire())
 		{
-			// Store the current world
-			stor_World = g_World;
-			vp_two_World = g_World;
-			g_World = vp_two_World;
-			// And view
-			stor_View = g_View;
-			g_View = vp_two_View;
-			// And projection
-			stor_Projection = g_Projection;
-			g_Projection = vp_two_Projection;
+			{
+				std::lock_guard<std::mutex> lock(pacing);
+				framesTaken = frames.Front().number;
+			}
+			paced.notify_one();
+		}
+		frame = &frames.Front();
+		if (frame->number == 0)
+			return;
+		scene = frame->scene;
+		UpdateBounds();
+
+		// Grab the context and view.
+		ID3D11DeviceContext* con;
+		ID3D11RenderTargetView* view;
+		d3d11.GetImmediateContext((void**)&con);
+		d3d11.GetRenderTargetView((void**)&view);
 
-			// Render with the second VP now.
-			Render(2);
+		// Pick this frame's resolution from the newest GPU frame time, a few frames old. Present waits on vsync,
+		// so until the GPU timer answers the CPU time of Render() itself stands in for it.
+		float gpuMs = 0.0f;
+		if (gpuTimer.Read(con, gpuMs))
+		{
+			gpuTimed = true;
+			if (dynamicResolution)
+				dynamicRes.Update(gpuMs);
 		}
-		// Second passthrough for second VP.
-		else if (flag == 2)
+		else if (!gpuTimed && dynamicResolution)
+			dynamicRes.Update(cpuFrameMs);
+		gpuTimer.Begin(con);
+
+		// Rebuild the frame graph.
+		graph.Reset();
+		RGResource backBufferRes = graph.ImportTexture("BackBuffer", &backBuffer);
+		BuildViews(backBufferRes);
+
+		// Unique Constant Buffer to communicate for unique PS
+		UniqueBuffer ub;
+		ub.timePos = { scene.pulse, 0, 0, 0};
+		con->UpdateSubresource(u_constantbuffer.Get(), 0, nullptr, &ub, 0, 0);
+
+		// Lights are in world space, every view shares them. Only the ones that changed since the last snapshot
+		// are copied; after a skipped snapshot, or with clustering having been off, they all are.
+		if (!(meshPermutation & PERM_CLUSTERED))
+			lightsUploaded = 0;
+		else if (frame->number != lightsUploaded)
 		{
-			g_World = stor_World;
-			g_View = stor_View;
-			g_Projection = stor_Projection;
+			if (frame->number == lightsUploaded + 1)
+				lightUploadRuns = frame->lightRuns;
+			else
+				lightUploadRuns.assign(1, std::make_pair(0u, (uint32_t)frame->lights.size()));
+			lightsUploaded = clusterBuffers.UploadLights(device.Get(), con, frame->lights, lightUploadRuns) ? frame->number : 0;
 		}
 
-		timePerFrame = timeCur;
+		// Terrain chunks that finished generating since last frame go in before any view draws.
+		if (terrainOn)
+			UpdateTerrain(con);
+
+		// Shadow maps go first, every view that draws the mesh reads them. The atlas is pooled by the graph like the RTT target.
+		shadowAtlas = RG_INVALID;
+		if (meshPermutation & PERM_SHADOWS)
+		{
+			FitShadows();
+			shadowResources.Upload(con, shadows.Constants((uint32_t)frame->spotSlot));
+
+			RGTextureDesc shadowDesc;
+			shadowDesc.width = shadowDesc.height = shadows.AtlasSize();
+			shadowDesc.format = D3D11ShadowResources::atlasFormat;
+			shadowDesc.bindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+			shadowAtlas = graph.CreateTexture("ShadowAtlas", shadowDesc);
+			graph.AddPass("Shadows",
+				[this](RenderGraph::PassBuilder& builder)
+				{
+					builder.Write(shadowAtlas);
+				},
+				[this, con](RenderGraph&)
+				{
+					RenderShadowMaps(con);
+				});
+		}
+
+		for (const RenderView& rv : views)
+		{
+			graph.AddPass(rv.name,
+				[this, &rv](RenderGraph::PassBuilder& builder)
+				{
+					builder.Write(rv.target);
+					if (rv.depth != RG_INVALID)
+						builder.Write(rv.depth);
+					if (rv.sampled != RG_INVALID)
+						builder.Read(rv.sampled);
+					if (shadowAtlas != RG_INVALID && (rv.drawFlags & VIEW_DRAW_MESH))
+						builder.Read(shadowAtlas);
+				},
+				[this, &rv, con, view](RenderGraph&)
+				{
+					DrawView(con, view, rv);
+				});
+
+			// A scaled down main view goes onto the back buffer before the views after it draw there.
+			if (sceneColor != RG_INVALID && rv.target == sceneColor)
+			{
+				graph.AddPass("Upscale",
+					[this, backBufferRes](RenderGraph::PassBuilder& builder)
+					{
+						builder.Read(sceneColor);
+						builder.Write(backBufferRes);
+					},
+					[this, &rv, con, backBufferRes](RenderGraph&)
+					{
+						RenderUpscale(con, backBufferRes, rv);
+					});
+			}
+		}
+
+		if (graph.Compile())
+			graph.Execute(graphBackend);
+		rttPool.EndFrame(graphBackend);
+		gpuTimer.End(con);
+		cpuFrameMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
 
 		con->Release();
 		view->Release();
@@ -1231,7 +1985,167 @@ public:
 		g_Projection = XMMatrixPerspectiveFovLH(XM_PIDIV2 + zoom, DrawClass::width / (FLOAT)DrawClass::height, nearP, farP);
 	}
 
+	// Render thread keys, everything that changes how the frame is drawn rather than what's in it.
 	void UserInput()
+	{
+		// Toggle the depth pre-pass
+		if (GetAsyncKeyState('P'))
+		{
+			if (!ghostProtectP)
+			{
+				depthPrepass = !depthPrepass;
+				std::cout << "[NOT AN ERROR] Depth pre-pass " << (depthPrepass ? "ON" : "OFF") << ".\n|\n";
+			}
+			ghostProtectP = true;
+		}
+		else
+			ghostProtectP = false;
+
+		// Switch the mesh to the pixel shader variant with(out) normal mapping
+		if (GetAsyncKeyState('N'))
+		{
+			if (!ghostProtectN)
+			{
+				meshPermutation ^= PERM_NORMAL_MAP;
+				std::cout << "[NOT AN ERROR] Normal mapping " << ((meshPermutation & PERM_NORMAL_MAP) ? "ON" : "OFF") << ".\n|\n";
+			}
+			ghostProtectN = true;
+		}
+		else
+			ghostProtectN = false;
+
+		// Baked ambient occlusion and sun visibility on the mesh, see LightBaker.h
+		if (GetAsyncKeyState('I'))
+		{
+			if (!ghostProtectI)
+			{
+				if (mesh != nullptr && mesh->baked)
+				{
+					meshPermutation ^= PERM_BAKED;
+					std::cout << "[NOT AN ERROR] Baked lighting " << ((meshPermutation & PERM_BAKED) ? "ON" : "OFF") << ".\n|\n";
+				}
+				else
+					std::cout << "[NOT AN ERROR] The mesh has no baked lighting, run LightBake.\n|\n";
+			}
+			ghostProtectI = true;
+		}
+		else
+			ghostProtectI = false;
+
+		// Cycle the clustered lights: off, then 64, 256 and 1024 extra lights
+		if (GetAsyncKeyState('K'))
+		{
+			if (!ghostProtectK)
+			{
+				if (!(meshPermutation & PERM_CLUSTERED))
+				{
+					meshPermutation |= PERM_CLUSTERED;
+					clusterExtraLights = 64;
+				}
+				else if (clusterExtraLights < 1024)
+					clusterExtraLights *= 4;
+				else
+				{
+					meshPermutation &= ~PERM_CLUSTERED;
+					clusterExtraLights = 0;
+				}
+				requestedExtraLights = clusterExtraLights;
+
+				if (meshPermutation & PERM_CLUSTERED)
+					std::cout << "[NOT AN ERROR] Clustered lighting ON with " << clusterExtraLights + 2 << " point/spot lights.\n|\n";
+				else
+					std::cout << "[NOT AN ERROR] Clustered lighting OFF.\n|\n";
+			}
+			ghostProtectK = true;
+		}
+		else
+			ghostProtectK = false;
+
+		// Shadows from the directional and spot lights
+		if (GetAsyncKeyState('B'))
+		{
+			if (!ghostProtectB)
+			{
+				meshPermutation ^= PERM_SHADOWS;
+				std::cout << "[NOT AN ERROR] Shadows " << ((meshPermutation & PERM_SHADOWS) ? "ON" : "OFF") << ".\n|\n";
+			}
+			ghostProtectB = true;
+		}
+		else
+			ghostProtectB = false;
+
+		// Dynamic resolution, back to full scale when it's off
+		if (GetAsyncKeyState('U'))
+		{
+			if (!ghostProtectU)
+			{
+				dynamicResolution = !dynamicResolution;
+				dynamicRes.Reset();
+				std::cout << "[NOT AN ERROR] Dynamic resolution " << (dynamicResolution ? "ON" : "OFF") << ".\n|\n";
+			}
+			ghostProtectU = true;
+		}
+		else
+			ghostProtectU = false;
+
+		// Record the shadow casters on worker threads into deferred contexts, or play them onto the immediate context
+		if (GetAsyncKeyState('X'))
+		{
+			if (!ghostProtectX)
+			{
+				shadowLists.parallel = !shadowLists.parallel;
+				std::cout << "[NOT AN ERROR] Shadow command lists from worker threads " << (shadowLists.parallel ? "ON" : "OFF")
+					<< (shadowLists.Supported() ? "" : " (the device has no deferred contexts)")
+					<< (shadowLists.parallel ? ", used from " + std::to_string(shadowLists.minDraws) + " draws up" : "") << ".\n|\n";
+			}
+			ghostProtectX = true;
+		}
+		else
+			ghostProtectX = false;
+
+		// Grid resolution, from 2 to 1024 points a side
+		bool finer = GetAsyncKeyState(VK_OEM_6) != 0, coarser = GetAsyncKeyState(VK_OEM_4) != 0;
+		if (finer || coarser)
+		{
+			if (!ghostProtectGrid && (finer ? gridDesc.resolution < 1024 : gridDesc.resolution > 2))
+			{
+				gridDesc.resolution = finer ? gridDesc.resolution * 2 : gridDesc.resolution / 2;
+				std::cout << "[NOT AN ERROR] Grid resolution " << gridDesc.resolution << "x" << gridDesc.resolution
+					<< ", " << gridDesc.VertexCount() << " line vertices.\n|\n";
+			}
+			ghostProtectGrid = true;
+		}
+		else
+			ghostProtectGrid = false;
+
+		// Swap the wave grid for the streamed terrain
+		if (GetAsyncKeyState('V'))
+		{
+			if (!ghostProtectV)
+			{
+				terrainOn = !terrainOn;
+				std::cout << "[NOT AN ERROR] Terrain " << (terrainOn ? "ON" : "OFF") << ": " << terrain.Selected().size() << " chunks drawn, "
+					<< terrain.Cached() << " of " << terrain.Desc().cacheChunks << " cached (" << terrain.CacheBytes() / (1024 * 1024)
+					<< " MB), " << terrain.Generated() << " generated.\n|\n";
+			}
+			ghostProtectV = true;
+		}
+		else
+			ghostProtectV = false;
+
+		// Print the overdraw of the mesh from the main camera
+		if (GetAsyncKeyState('O'))
+		{
+			if (!ghostProtectO)
+				PrintOverdraw();
+			ghostProtectO = true;
+		}
+		else
+			ghostProtectO = false;
+	}
+
+	// Update thread keys, the camera, the mesh's spin, the directional light and the simulation clock.
+	void SimulationInput()
 	{
 		// Rotate the objects.
 		if (GetAsyncKeyState('J'))
@@ -1348,6 +2262,53 @@ public:
 			changePerspective();
 		}
 
+		// Pause the simulation, '.' steps it once while it's paused
+		if (GetAsyncKeyState('F'))
+		{
+			if (!ghostProtectF)
+			{
+				clock.SetPaused(!clock.Paused());
+				std::cout << "[NOT AN ERROR] Simulation " << (clock.Paused() ? "PAUSED" : "RUNNING") << ".\n|\n";
+			}
+			ghostProtectF = true;
+		}
+		else
+			ghostProtectF = false;
+
+		if (GetAsyncKeyState(VK_OEM_PERIOD))
+		{
+			if (!ghostProtectPeriod && clock.Paused())
+				clock.StepOnce();
+			ghostProtectPeriod = true;
+		}
+		else
+			ghostProtectPeriod = false;
+
+		// Simulation speed, from 1/8 to 8 times
+		if (GetAsyncKeyState(VK_OEM_MINUS))
+		{
+			if (!ghostProtectMinus && clock.Scale() > 0.125)
+			{
+				clock.SetScale(clock.Scale() * 0.5);
+				std::cout << "[NOT AN ERROR] Simulation speed " << clock.Scale() << "x.\n|\n";
+			}
+			ghostProtectMinus = true;
+		}
+		else
+			ghostProtectMinus = false;
+
+		if (GetAsyncKeyState(VK_OEM_PLUS))
+		{
+			if (!ghostProtectPlus && clock.Scale() < 8.0)
+			{
+				clock.SetScale(clock.Scale() * 2.0);
+				std::cout << "[NOT AN ERROR] Simulation speed " << clock.Scale() << "x.\n|\n";
+			}
+			ghostProtectPlus = true;
+		}
+		else
+			ghostProtectPlus = false;
+
 		// Look around movement
 		if ((GetKeyState(VK_RBUTTON) & 0x100) != 0)
 		{
@@ -1428,10 +2389,7 @@ public:
 			int diffX = (cosX - cursorPos.x);
 			int diffY = (cosY - cursorPos.y);
 
-			XMMATRIX mRotate = XMMatrixRotationY(0.0125f * (diffX + diffY) );
-			XMVECTOR vLightDir = XMLoadFloat4(&lightDir[0]);
-			vLightDir = XMVector3Transform(vLightDir, mRotate);
-			XMStoreFloat4(&lightDir[0], vLightDir);
+			lights.RotateDirection(LIGHT_SUN, 0.0125f * (diffX + diffY));
 
 			//Set it back to the center
 			SetCursorPos(cosX, cosY);
@@ -0,0 +1,131 @@
+#include "DynamicResolution.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Plays the recorded GPU frame time traces in Traces/ through DynamicResolutionController and checks how the scale
+// responds to each, then plays every trace a second time and expects the exact same scales. Needs nothing at all.
+// DynResCheck [trace folder]   defaults to Traces, run it from the project folder.
+
+static bool LoadTrace(const std::string& path, std::vector<float>& frames)
+{
+	FILE* file = fopen(path.c_str(), "r");
+	if (file == nullptr)
+		return false;
+	frames.clear();
+	char line[256];
+	while (fgets(line, sizeof(line), file))
+	{
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+			continue;
+		frames.push_back((float)atof(line));
+	}
+	fclose(file);
+	return !frames.empty();
+}
+
+static std::vector<float> Play(const std::vector<float>& frames)
+{
+	DynamicResolutionController controller;
+	std::vector<float> scales;
+	scales.reserve(frames.size());
+	for (float ms : frames)
+		scales.push_back(controller.Update(ms));
+	return scales;
+}
+
+// What every trace has to give: scales on the step grid inside the limits, rises at least raiseDelay frames after
+// the change before, and the same scales when played again.
+static bool CheckCommon(const std::vector<float>& frames, const std::vector<float>& scales, unsigned int& changes)
+{
+	DynamicResolutionSettings s;
+	bool ok = true;
+	changes = 0;
+	unsigned int since = 0;
+	float last = s.maxScale;
+	for (float scale : scales)
+	{
+		float steps = scale / s.step;
+		ok &= scale >= s.minScale && scale <= s.maxScale && fabsf(steps - floorf(steps + 0.5f)) < 1e-4f;
+		since++;
+		if (scale != last)
+		{
+			ok &= scale < last || since >= s.raiseDelay;
+			changes++;
+			since = 0;
+		}
+		last = scale;
+	}
+	std::vector<float> again = Play(frames);
+	ok &= again.size() == scales.size() && memcmp(again.data(), scales.data(), scales.size() * sizeof(float)) == 0;
+	return ok;
+}
+
+static float Lowest(const std::vector<float>& scales, size_t from, size_t to)
+{
+	float lowest = 1e9f;
+	for (size_t i = from; i < to && i < scales.size(); i++)
+		lowest = fminf(lowest, scales[i]);
+	return lowest;
+}
+
+static bool NeverRises(const std::vector<float>& scales)
+{
+	for (size_t i = 1; i < scales.size(); i++)
+	{
+		if (scales[i] > scales[i - 1])
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	std::string folder = (argc > 1) ? argv[1] : "Traces";
+	DynamicResolutionSettings s;
+	bool ok = true;
+
+	struct Trace
+	{
+		const char* name;
+		const char* expect;
+	};
+	const Trace traces[] =
+	{
+		{ "steady", "stays at full scale" },
+		{ "spike", "lone hitches never drop the scale" },
+		{ "rampdown", "only ever drops, down to the minimum" },
+		{ "recovery", "drops under load, back to full once it lifts" },
+	};
+	for (const Trace& trace : traces)
+	{
+		std::vector<float> frames;
+		std::string path = folder + "/" + trace.name + ".txt";
+		if (!LoadTrace(path, frames))
+		{
+			printf("%-9s couldn't read %s\n", trace.name, path.c_str());
+			ok = false;
+			continue;
+		}
+		std::vector<float> scales = Play(frames);
+		unsigned int changes = 0;
+		bool common = CheckCommon(frames, scales, changes);
+
+		bool expected = false;
+		if (!strcmp(trace.name, "steady") || !strcmp(trace.name, "spike"))
+			expected = changes == 0 && scales.back() == s.maxScale;
+		else if (!strcmp(trace.name, "rampdown"))
+			expected = NeverRises(scales) && scales.back() == s.minScale;
+		else if (!strcmp(trace.name, "recovery"))
+			expected = Lowest(scales, 0, 600) < 0.8f && scales.back() == s.maxScale && changes <= 16;
+
+		printf("%-9s %5zu frames, %2u changes, lowest %.2f, last %.2f: %s%s\n", trace.name, frames.size(), changes,
+			Lowest(scales, 0, scales.size()), scales.back(), expected ? trace.expect : "NOT WHAT WAS EXPECTED",
+			common ? "" : ", BROKE THE STEP/DELAY/REPLAY RULES");
+		ok &= common && expected;
+	}
+	return ok ? 0 : 1;
+}
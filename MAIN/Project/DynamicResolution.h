@@ -0,0 +1,97 @@
+#pragma once
+#include <cmath>
+
+// Tuning for DynamicResolutionController. Errors are relative to the target, so the gains don't depend on it.
+struct DynamicResolutionSettings
+{
+	float targetMs = 14.0f;			// Frame time to aim for, a little under the 16.7 ms of a 60 Hz vsync
+	float minScale = 0.5f;			// Smallest fraction of the window's width and height rendered
+	float maxScale = 1.0f;
+	float step = 0.05f;				// Applied scales are multiples of this
+	float kp = 0.3f, ki = 0.1f, kd = 0.05f;
+	float deadband = 0.05f;			// Errors smaller than this (5% of the target) are left alone
+	float smoothing = 0.1f;		// How much of each new frame time goes into the filtered one
+	unsigned int raiseDelay = 30;	// Frames since the last change before the scale may go back up
+};
+
+// Picks a render scale from measured frame times. A PID controller in velocity form moves a raw scale toward
+// the target frame time, clamping it is all the anti-windup it needs. The applied scale follows the raw one with
+// hysteresis: it only moves once the raw scale is a whole step away, drops straight away and only rises when
+// it hasn't changed for raiseDelay frames. No clocks or devices, so the same trace always gives the same scales.
+class DynamicResolutionController
+{
+	DynamicResolutionSettings settings;
+	float filteredMs = 0.0f;
+	float error1 = 0.0f, error2 = 0.0f;	// Errors from the last two updates
+	float raw = 1.0f;
+	float scale = 1.0f;
+	unsigned int sinceChange = 0;
+
+	float Quantize(float s) const
+	{
+		s = floorf(s / settings.step + 0.5f) * settings.step;
+		return fminf(fmaxf(s, settings.minScale), settings.maxScale);
+	}
+
+public:
+	DynamicResolutionController() { Reset(); }
+
+	void Configure(const DynamicResolutionSettings& s)
+	{
+		settings = s;
+		Reset();
+	}
+
+	// Back to full scale with no history.
+	void Reset()
+	{
+		// Starting on target, a slow first frame or two (shaders still compiling) is just a spike.
+		filteredMs = settings.targetMs;
+		error1 = error2 = 0.0f;
+		raw = scale = settings.maxScale;
+		sinceChange = 0;
+	}
+
+	// One frame's time in milliseconds, returns the scale to render the next frame at.
+	float Update(float frameMs)
+	{
+		if (!(frameMs > 0.0f) || !std::isfinite(frameMs))
+			return scale;
+
+		// A lone hitch can only pull the filtered time up by half the smoothing, a real slowdown still gets through
+		// over a few frames.
+		filteredMs += settings.smoothing * (fminf(frameMs, 1.5f * filteredMs) - filteredMs);
+
+		// Positive when there is time to spare.
+		float error = (settings.targetMs - filteredMs) / settings.targetMs;
+		if (fabsf(error) < settings.deadband)
+			error = 0.0f;
+
+		raw += settings.kp * (error - error1) + settings.ki * error + settings.kd * (error - 2.0f * error1 + error2);
+		raw = fminf(fmaxf(raw, settings.minScale), settings.maxScale);
+		error2 = error1;
+		error1 = error;
+
+		sinceChange++;
+		float next = Quantize(raw);
+		// A hair under a whole step, so a raw scale clamped to a limit still reaches it.
+		bool farEnough = fabsf(raw - scale) > settings.step * 0.99f;
+		if (farEnough && next != scale && (next < scale || sinceChange >= settings.raiseDelay))
+		{
+			scale = next;
+			sinceChange = 0;
+		}
+		return scale;
+	}
+
+	float Scale() const { return scale; }
+	float RawScale() const { return raw; }
+	float FilteredMs() const { return filteredMs; }
+
+	// Pixels to render of a full size dimension at the current scale, never 0.
+	unsigned int Scaled(unsigned int full) const
+	{
+		unsigned int s = static_cast<unsigned int>(full * scale + 0.5f);
+		return (s < 1) ? 1 : s;
+	}
+};
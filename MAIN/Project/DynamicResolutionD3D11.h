@@ -0,0 +1,124 @@
+#pragma once
+#include "defines.h"
+#include "DynamicResolution.h"
+#include <wrl/client.h>
+
+// GPU time of whole frames from timestamp queries. Results are read a few frames late and never waited on.
+class D3D11GpuFrameTimer
+{
+	static const unsigned int latency = 4;
+
+	struct Frame
+	{
+		Microsoft::WRL::ComPtr<ID3D11Query>	disjoint = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11Query>	begin = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11Query>	end = nullptr;
+		bool pending = false;
+	};
+
+	Frame frames[latency];
+	unsigned int current = 0;
+
+public:
+	bool Create(ID3D11Device* dev)
+	{
+		D3D11_QUERY_DESC disjointDesc = { D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+		D3D11_QUERY_DESC timestampDesc = { D3D11_QUERY_TIMESTAMP, 0 };
+		for (Frame& f : frames)
+		{
+			if (FAILED(dev->CreateQuery(&disjointDesc, f.disjoint.GetAddressOf())) ||
+				FAILED(dev->CreateQuery(&timestampDesc, f.begin.GetAddressOf())) ||
+				FAILED(dev->CreateQuery(&timestampDesc, f.end.GetAddressOf())))
+				return false;
+		}
+		return true;
+	}
+
+	void Begin(ID3D11DeviceContext* con)
+	{
+		// A frame still unread after going all the way round is dropped.
+		Frame& f = frames[current];
+		f.pending = false;
+		con->Begin(f.disjoint.Get());
+		con->End(f.begin.Get());
+	}
+
+	void End(ID3D11DeviceContext* con)
+	{
+		Frame& f = frames[current];
+		con->End(f.end.Get());
+		con->End(f.disjoint.Get());
+		f.pending = true;
+		current = (current + 1) % latency;
+	}
+
+	// Milliseconds of the newest frame the GPU has finished since the last call, false if there is none yet.
+	bool Read(ID3D11DeviceContext* con, float& ms)
+	{
+		bool found = false;
+		// Oldest first, a frame still in flight means the ones after it are too.
+		for (unsigned int i = 0; i < latency; i++)
+		{
+			Frame& f = frames[(current + i) % latency];
+			if (!f.pending)
+				continue;
+			D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+			UINT64 begin = 0, end = 0;
+			if (con->GetData(f.disjoint.Get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+				con->GetData(f.begin.Get(), &begin, sizeof(begin), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+				con->GetData(f.end.Get(), &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+				break;
+			f.pending = false;
+			if (!disjoint.Disjoint && disjoint.Frequency > 0 && end >= begin)
+			{
+				ms = static_cast<float>(static_cast<double>(end - begin) * 1000.0 / disjoint.Frequency);
+				found = true;
+			}
+		}
+		return found;
+	}
+};
+
+// What UpscalePS needs, matches UpscaleBuffer in shaders.fx.
+struct UpscaleConstants
+{
+	XMFLOAT4 rect;	// uv scale of the rendered corner, then the largest uv that is still inside it
+};
+
+// The constant buffer and clamped sampler for stretching a dynamic resolution frame over the back buffer.
+class D3D11UpscaleResources
+{
+	Microsoft::WRL::ComPtr<ID3D11Buffer>		constants = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11SamplerState>	sampler = nullptr;
+
+public:
+	bool Create(ID3D11Device* dev)
+	{
+		D3D11_BUFFER_DESC bd = {};
+		bd.Usage = D3D11_USAGE_DEFAULT;
+		bd.ByteWidth = sizeof(UpscaleConstants);
+		bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		if (FAILED(dev->CreateBuffer(&bd, nullptr, constants.GetAddressOf())))
+			return false;
+
+		D3D11_SAMPLER_DESC sd = {};
+		sd.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+		sd.AddressU = sd.AddressV = sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+		sd.ComparisonFunc = D3D11_COMPARISON_NEVER;
+		sd.MaxLOD = D3D11_FLOAT32_MAX;
+		return SUCCEEDED(dev->CreateSamplerState(&sd, sampler.GetAddressOf()));
+	}
+
+	// The source only has width x height pixels filled in its top left corner, out of fullWidth x fullHeight.
+	void Bind(ID3D11DeviceContext* con, ID3D11ShaderResourceView* source, unsigned int width, unsigned int height,
+		unsigned int fullWidth, unsigned int fullHeight)
+	{
+		UpscaleConstants uc;
+		uc.rect = XMFLOAT4((float)width / fullWidth, (float)height / fullHeight,
+			(width - 0.5f) / fullWidth, (height - 0.5f) / fullHeight);
+		con->UpdateSubresource(constants.Get(), 0, nullptr, &uc, 0, 0);
+		con->PSSetShaderResources(0, 1, &source);
+		con->PSSetSamplers(2, 1, sampler.GetAddressOf());
+		con->PSSetConstantBuffers(4, 1, constants.GetAddressOf());
+	}
+};
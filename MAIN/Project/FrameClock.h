@@ -0,0 +1,129 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Drives the simulation in fixed steps however fast frames come. Each Tick puts the real time since the last one
+// into an accumulator, scaled and zero while paused, and hands back how many whole steps fit; what's left over is
+// Alpha, how far the rendered frame is between the last two steps. Real frame times can be recorded and replayed
+// later, so a replay runs exactly the same steps as the recording whatever the machine does.
+class FrameClock
+{
+	typedef std::chrono::steady_clock Clock;
+
+	double step = 1.0 / 60.0;
+	double maxFrame = 0.25;				// Longest frame counted, so a hitch doesn't turn into a burst of catch up steps
+	double scale = 1.0;
+	bool paused = false;
+	bool stepRequested = false;
+
+	double accumulator = 0.0;
+	double time = 0.0;					// Simulated seconds
+	unsigned long long steps = 0;
+	double frameSeconds = 0.0;			// Real length of the last frame, before scaling
+	bool started = false;
+	Clock::time_point last;
+
+	bool recording = false;
+	std::vector<double> recorded;
+	std::vector<double> replay;
+	size_t replayAt = 0;
+
+public:
+	// Seconds per simulation step.
+	void SetStep(double seconds) { step = seconds > 0.0 ? seconds : step; }
+	double Step() const { return step; }
+
+	// Speeds the simulation up or slows it down, real frame times are unaffected.
+	void SetScale(double s) { scale = s > 0.0 ? s : scale; }
+	double Scale() const { return scale; }
+
+	void SetPaused(bool on) { paused = on; }
+	bool Paused() const { return paused; }
+	// While paused, the next Tick runs exactly one step.
+	void StepOnce() { stepRequested = true; }
+
+	// Once per rendered frame, returns how many fixed steps to run before drawing it.
+	unsigned int Tick()
+	{
+		Clock::time_point now = Clock::now();
+		double real = started ? std::chrono::duration<double>(now - last).count() : 0.0;
+		last = now;
+		started = true;
+		return Tick(real);
+	}
+
+	// Same, with the frame's real length given rather than measured.
+	unsigned int Tick(double realSeconds)
+	{
+		if (replayAt < replay.size())
+			realSeconds = replay[replayAt++];
+		if (recording)
+			recorded.push_back(realSeconds);
+		frameSeconds = realSeconds;
+
+		if (paused)
+		{
+			if (!stepRequested)
+				return 0;
+			stepRequested = false;
+			accumulator = 0.0;
+			time += step;
+			steps++;
+			return 1;
+		}
+
+		accumulator += (realSeconds < maxFrame ? realSeconds : maxFrame) * scale;
+		unsigned int count = 0;
+		while (accumulator >= step)
+		{
+			accumulator -= step;
+			time += step;
+			steps++;
+			count++;
+		}
+		return count;
+	}
+
+	// 0 -> 1, how far past the last step the frame being drawn is.
+	float Alpha() const { return paused ? 1.0f : static_cast<float>(accumulator / step); }
+	double Time() const { return time; }
+	unsigned long long Steps() const { return steps; }
+	double FrameSeconds() const { return frameSeconds; }
+
+	// Recording keeps every frame's real length from here on.
+	void StartRecording()
+	{
+		recording = true;
+		recorded.clear();
+	}
+
+	// One frame length in seconds per line.
+	bool SaveRecording(const char* path) const
+	{
+		FILE* f = fopen(path, "w");
+		if (f == nullptr)
+			return false;
+		for (double seconds : recorded)
+			fprintf(f, "%.17g\n", seconds);	// Enough digits to read back the same double
+		fclose(f);
+		return true;
+	}
+
+	// Frames are timed from the file until it runs out, then from the real clock again.
+	bool LoadReplay(const char* path)
+	{
+		FILE* f = fopen(path, "r");
+		if (f == nullptr)
+			return false;
+		replay.clear();
+		replayAt = 0;
+		double seconds = 0.0;
+		while (fscanf(f, "%lf", &seconds) == 1)
+			replay.push_back(seconds);
+		fclose(f);
+		return !replay.empty();
+	}
+
+	bool Replaying() const { return replayAt < replay.size(); }
+};
@@ -0,0 +1,38 @@
+#include "ProceduralGrid.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+// Checks GridVertex, the C++ copy of GridVS, against the old vertex and index buffer grid at a range of
+// resolutions, and prints the buffer memory the procedural grid does without. Needs nothing but DirectXMath.
+// GridCheck [resolution] [extent]   defaults to 2 through 1024 points a side, extent 5.
+
+static bool Check(const GridDesc& desc)
+{
+	bool match = CheckGrid(desc);
+	const size_t vertexBytes = 44;	// sizeof(Mesh::SimpleVertex)
+	size_t bufferBytes = (size_t)desc.resolution * desc.resolution * vertexBytes + (size_t)desc.VertexCount() * sizeof(uint32_t);
+	printf("%4u x %-4u extent %g: %u line vertices, %.1f KB of buffers before, %s\n", desc.resolution, desc.resolution,
+		desc.extent, desc.VertexCount(), bufferBytes / 1024.0, match ? "matches" : "MISMATCH");
+	return match;
+}
+
+int main(int argc, char** argv)
+{
+	GridDesc desc;
+	if (argc > 2)
+		desc.extent = (float)atof(argv[2]);
+	if (argc > 1)
+	{
+		desc.resolution = (unsigned int)atoi(argv[1]);
+		return Check(desc) ? 0 : 1;
+	}
+
+	bool ok = true;
+	for (unsigned int resolution : { 2u, 3u, 7u, 64u, 100u, 255u, 1024u })
+	{
+		desc.resolution = resolution;
+		ok &= Check(desc);
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,293 @@
+#include "SoftwareRasterizer.h"
+#include "SceneLights.h"
+#include "ImageDiff.h"
+#include "StoneHenge.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Renders the StoneHenge mesh on the CPU with SoftwareRasterizer, lit the way the project lights it. Needs nothing
+// but DirectXMath. Run from the project folder so Textures\ is found.
+// HeadlessRender [output.tga] [width] [height] [threads]
+//     The first frame, timed, and checked to be the same on one thread as on all of them and with the scalar
+//     lighting reference. Defaults to StoneHenge.tga, 800 x 600 and every core.
+// HeadlessRender -capture <folder> [frames]
+//     Steps the scene at a fixed 60 Hz along a fixed camera path and writes frame_000.tga on into folder, making it if
+//     it isn't there.
+// HeadlessRender -compare <folder> [frames]
+//     Renders the same frames and diffs them against the ones captured into folder, per pixel and with SSIM.
+//     Frames that fail get a diff_000.tga next to them. Returns 1 if any do.
+
+// Same layout as Mesh::SimpleVertex, without the baked lighting.
+struct SimpleVertex
+{
+	XMFLOAT4 Pos;
+	XMFLOAT3 Normal;
+	XMFLOAT2 UV;
+};
+
+// Same layout as Mesh's ConstantBuffer, so it goes through SoftwareConstants::FromConstantBuffer the same way.
+struct ConstantBuffer
+{
+	XMMATRIX mWorld;
+	XMMATRIX mView;
+	XMMATRIX mProjection;
+	XMFLOAT4 lightDir[3];
+	XMFLOAT4 lightClr[3];
+	XMFLOAT4 vOutputColor;
+	XMFLOAT4 spotLightPos;
+	float time;
+	float cone;
+	float bakedSun;
+};
+
+// Uncompressed 32 bit DDS files only (which both StoneHenge textures are), first mip.
+static bool LoadDDS(const char* path, SoftwareTexture& texture)
+{
+	FILE* f = fopen(path, "rb");
+	if (f == nullptr)
+		return false;
+	uint8_t header[128];
+	bool ok = fread(header, 1, sizeof(header), f) == sizeof(header) && memcmp(header, "DDS ", 4) == 0;
+	uint32_t height = 0, width = 0, bits = 0, redMask = 0;
+	if (ok)
+	{
+		memcpy(&height, header + 12, 4);
+		memcpy(&width, header + 16, 4);
+		memcpy(&bits, header + 88, 4);
+		memcpy(&redMask, header + 92, 4);
+		ok = bits == 32 && (redMask == 0x000000FF || redMask == 0x00FF0000);
+	}
+	if (ok)
+	{
+		texture.width = width;
+		texture.height = height;
+		texture.texels.resize(width * height);
+		ok = fread(texture.texels.data(), 4, texture.texels.size(), f) == texture.texels.size();
+		// BGRA files get red and blue swapped into place.
+		if (ok && redMask == 0x00FF0000)
+		{
+			for (uint32_t& t : texture.texels)
+				t = (t & 0xFF00FF00) | ((t >> 16) & 0xFF) | ((t & 0xFF) << 16);
+		}
+	}
+	fclose(f);
+	return ok;
+}
+
+// The mesh, its textures and the lights, everything a frame is drawn from.
+struct HeadlessScene
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<unsigned int> indices;
+	SoftwareTexture diffuse, normalMap;
+	bool normalMapped = false;
+	LightManager lights;
+	SceneLightAnimator animator;
+
+	void Load()
+	{
+		// Same as ReadModel in main.cpp.
+		vertices.resize(sizeof(StoneHenge_data) / sizeof(StoneHenge_data[0]));
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			const OBJ_VERT& v = StoneHenge_data[i];
+			vertices[i].Pos = XMFLOAT4(v.pos[0] * 0.1f, v.pos[1] * 0.1f, v.pos[2] * 0.1f, 1.0f);
+			vertices[i].UV = XMFLOAT2(v.uvw[0], v.uvw[1]);
+			vertices[i].Normal = XMFLOAT3(v.nrm[0], v.nrm[1], v.nrm[2]);
+		}
+		indices.assign(StoneHenge_indicies, StoneHenge_indicies + sizeof(StoneHenge_indicies) / sizeof(StoneHenge_indicies[0]));
+
+		if (!LoadDDS("Textures/StoneHenge.dds", diffuse))
+			printf("Textures/StoneHenge.dds didn't load, drawing untextured\n");
+		normalMapped = LoadDDS("Textures/StoneHengeNM.dds", normalMap);
+
+		AddSceneLights(lights);
+	}
+
+	// Filled in like Mesh::DrawView.
+	SoftwareConstants Constants(FXMVECTOR eye, FXMVECTOR at, unsigned int width, unsigned int height) const
+	{
+		ConstantBuffer cb = {};
+		cb.mWorld = XMMatrixTranspose(XMMatrixIdentity());
+		cb.mView = XMMatrixTranspose(XMMatrixLookAtLH(eye, at, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+		cb.mProjection = XMMatrixTranspose(XMMatrixPerspectiveFovLH(XM_PIDIV2, width / (float)height, 0.01f, 100.0f));
+		XMFLOAT3 sunDir = lights.Direction(0), pointPos = lights.Position(1), spotDir = lights.Direction(2), spotPos = lights.Position(2);
+		cb.lightDir[0] = { sunDir.x, sunDir.y, sunDir.z, 1.0f };
+		cb.lightDir[1] = { pointPos.x, pointPos.y, pointPos.z, 1.0f };
+		cb.lightDir[2] = { -spotDir.x, -spotDir.y, -spotDir.z, 1.0f };
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			XMFLOAT3 c = lights.Color(i);
+			cb.lightClr[i] = { c.x, c.y, c.z, 1.0f };
+		}
+		cb.spotLightPos = { spotPos.x, spotPos.y, spotPos.z, 1.0f };
+		cb.cone = lights.SpotCos(2) * 25.0f;
+		return SoftwareConstants::FromConstantBuffer(cb);
+	}
+
+	void Draw(SoftwareRasterizer& raster, const SoftwareConstants& constants) const
+	{
+		// The blue main.cpp clears to.
+		const float clearColor[4] = { 0.2f, 0.2f, 0.4f, 1.0f };
+		raster.SetTextures(&diffuse, normalMapped ? &normalMap : nullptr);
+		raster.Clear(clearColor);
+		raster.DrawIndexed(vertices.data(), (unsigned int)vertices.size(), indices.data(), (unsigned int)indices.size(), constants);
+	}
+};
+
+// The project's first frame: the camera where it starts and the lights before they have moved.
+static int Benchmark(const char* output, unsigned int width, unsigned int height, unsigned int threads)
+{
+	HeadlessScene scene;
+	scene.Load();
+	SoftwareConstants constants = scene.Constants(XMVectorSet(0.0f, 1.0f, -5.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), width, height);
+	SoftwareRasterizer raster;
+
+	// Once on a single thread as the reference, then timed on the rest.
+	raster.Resize(width, height, 1);
+	scene.Draw(raster, constants);
+	std::vector<uint32_t> reference = raster.Color();
+
+	raster.Resize(width, height, threads);
+	const int runs = 20;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < runs; i++)
+		scene.Draw(raster, constants);
+	auto end = std::chrono::high_resolution_clock::now();
+	float ms = std::chrono::duration<float, std::milli>(end - start).count() / runs;
+
+	bool matches = raster.Color() == reference;
+	printf("%ux%u, %u triangles, %u threads: %.3f ms, %s\n", width, height, (unsigned int)scene.indices.size() / 3,
+		threads ? threads : std::thread::hardware_concurrency(), ms, matches ? "matches single thread" : "MISMATCH");
+
+	// The scalar lighting reference may round a channel the other way, but never by more than one step.
+	std::vector<uint32_t> simd = raster.Color();
+	raster.SetReferenceShading(true);
+	scene.Draw(raster, constants);
+	raster.SetReferenceShading(false);
+	int worst = 0;
+	for (size_t i = 0; i < simd.size(); i++)
+	{
+		for (int shift = 0; shift < 32; shift += 8)
+			worst = std::max(worst, abs((int)((simd[i] >> shift) & 0xFF) - (int)((raster.Color()[i] >> shift) & 0xFF)));
+	}
+	printf("Scalar lighting reference: worst channel difference %d, %s\n", worst, worst <= 1 ? "matches" : "MISMATCH");
+	matches &= worst <= 1;
+
+	if (!WriteTGA(output, simd, width, height))
+	{
+		printf("Couldn't write %s\n", output);
+		return 1;
+	}
+	printf("Wrote %s\n", output);
+	return matches ? 0 : 1;
+}
+
+static std::string FramePath(const char* folder, const char* name, unsigned int frame)
+{
+	char file[32];
+	snprintf(file, sizeof(file), "%s_%03u.tga", name, frame);
+	return std::string(folder) + "/" + file;
+}
+
+// Nothing here reads a clock: frame n is always the same picture.
+static int CaptureOrCompare(const char* folder, unsigned int frames, bool compare)
+{
+	const unsigned int width = 800, height = 600;
+	const float step = (1000.0f / 60.0f) / 1500.0f;		// A 60 Hz frame in Mesh::UpdateScene's time units
+
+	HeadlessScene scene;
+	scene.Load();
+	SoftwareRasterizer raster;
+	raster.Resize(width, height);
+
+	// Only the last folder in the path is made, the ones above it have to be there already.
+	if (!compare)
+	{
+#ifdef _WIN32
+		_mkdir(folder);
+#else
+		mkdir(folder, 0755);
+#endif
+	}
+
+	unsigned int failed = 0;
+	for (unsigned int frame = 0; frame < frames; frame++)
+	{
+		// Once round the mesh every 240 frames, rising a little on the far side. Frame 0 is the start camera.
+		float angle = XM_2PI * frame / 240.0f;
+		XMVECTOR eye = XMVectorSet(5.0f * sinf(angle), 1.0f + 0.5f * (1.0f - cosf(angle)), -5.0f * cosf(angle), 0.0f);
+		scene.Draw(raster, scene.Constants(eye, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), width, height));
+		scene.animator.Step(scene.lights, step, false);
+
+		std::string path = FramePath(folder, "frame", frame);
+		if (!compare)
+		{
+			if (!WriteTGA(path.c_str(), raster.Color(), width, height))
+			{
+				printf("Couldn't write %s, is the folder above %s there?\n", path.c_str(), folder);
+				return 1;
+			}
+			continue;
+		}
+
+		Image render, golden, diff;
+		render.width = width;
+		render.height = height;
+		render.pixels = raster.Color();
+		if (!ReadTGA(path.c_str(), golden))
+		{
+			printf("frame %3u: no golden image at %s\n", frame, path.c_str());
+			failed++;
+			continue;
+		}
+		ImageDiffResult result = DiffImages(render, golden, ImageDiffSettings(), &diff);
+		if (!result.sizeMatches)
+			printf("frame %3u: golden image is %ux%u, FAILED\n", frame, golden.width, golden.height);
+		else
+			printf("frame %3u: max difference %3d, %6u pixels off, PSNR %6.2f dB, SSIM %.5f, %s\n", frame, result.maxDifference,
+				result.badPixels, std::isinf(result.psnr) ? 99.99 : result.psnr, result.ssim, result.passed ? "ok" : "FAILED");
+		if (!result.passed)
+		{
+			failed++;
+			if (result.sizeMatches)
+				WriteTGA(FramePath(folder, "diff", frame).c_str(), diff.pixels, width, height);
+		}
+	}
+
+	if (compare)
+		printf("%u of %u frames match the golden images\n", frames - failed, frames);
+	else
+		printf("Captured %u frames into %s\n", frames, folder);
+	return failed ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 2 && (strcmp(argv[1], "-capture") == 0 || strcmp(argv[1], "-compare") == 0))
+	{
+		unsigned int frames = argc > 3 ? (unsigned int)atoi(argv[3]) : 60;
+		return CaptureOrCompare(argv[2], frames, strcmp(argv[1], "-compare") == 0);
+	}
+
+	const char* output = argc > 1 ? argv[1] : "StoneHenge.tga";
+	unsigned int width = argc > 2 ? (unsigned int)atoi(argv[2]) : 800;
+	unsigned int height = argc > 3 ? (unsigned int)atoi(argv[3]) : 600;
+	unsigned int threads = argc > 4 ? (unsigned int)atoi(argv[4]) : 0;
+	if (width == 0 || height == 0)
+	{
+		printf("Bad size %ux%u\n", width, height);
+		return 1;
+	}
+	return Benchmark(output, width, height, threads);
+}
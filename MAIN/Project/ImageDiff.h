@@ -0,0 +1,177 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// RGBA8 image, rows top to bottom, red in the low byte like SoftwareRasterizer::Color.
+struct Image
+{
+	unsigned int width = 0, height = 0;
+	std::vector<uint32_t> pixels;
+};
+
+// Uncompressed 32 bit TGA, rows top to bottom.
+inline bool WriteTGA(const char* path, const std::vector<uint32_t>& rgba, unsigned int width, unsigned int height)
+{
+	FILE* f = fopen(path, "wb");
+	if (f == nullptr)
+		return false;
+	uint8_t header[18] = {};
+	header[2] = 2;		// Uncompressed true color
+	header[12] = width & 0xFF;
+	header[13] = (width >> 8) & 0xFF;
+	header[14] = height & 0xFF;
+	header[15] = (height >> 8) & 0xFF;
+	header[16] = 32;
+	header[17] = 0x28;	// 8 alpha bits, rows top to bottom
+	fwrite(header, 1, sizeof(header), f);
+	std::vector<uint8_t> bgra(rgba.size() * 4);
+	for (size_t i = 0; i < rgba.size(); i++)
+	{
+		bgra[i * 4 + 0] = (rgba[i] >> 16) & 0xFF;
+		bgra[i * 4 + 1] = (rgba[i] >> 8) & 0xFF;
+		bgra[i * 4 + 2] = rgba[i] & 0xFF;
+		bgra[i * 4 + 3] = (rgba[i] >> 24) & 0xFF;
+	}
+	bool ok = fwrite(bgra.data(), 1, bgra.size(), f) == bgra.size();
+	fclose(f);
+	return ok;
+}
+
+// Uncompressed 24 or 32 bit TGA with either row order, e.g. what WriteTGA or an image editor saves.
+inline bool ReadTGA(const char* path, Image& image)
+{
+	FILE* f = fopen(path, "rb");
+	if (f == nullptr)
+		return false;
+	uint8_t header[18];
+	bool ok = fread(header, 1, sizeof(header), f) == sizeof(header) && header[1] == 0 && header[2] == 2 &&
+		(header[16] == 24 || header[16] == 32);
+	if (ok)
+	{
+		fseek(f, header[0], SEEK_CUR);	// Image ID
+		image.width = header[12] | (header[13] << 8);
+		image.height = header[14] | (header[15] << 8);
+		unsigned int bytes = header[16] / 8;
+		bool topDown = (header[17] & 0x20) != 0;
+		std::vector<uint8_t> data((size_t)image.width * image.height * bytes);
+		ok = fread(data.data(), 1, data.size(), f) == data.size();
+		image.pixels.resize((size_t)image.width * image.height);
+		for (unsigned int y = 0; ok && y < image.height; y++)
+		{
+			const uint8_t* row = &data[(size_t)(topDown ? y : image.height - 1 - y) * image.width * bytes];
+			for (unsigned int x = 0; x < image.width; x++)
+			{
+				const uint8_t* p = row + x * bytes;
+				uint32_t a = (bytes == 4) ? p[3] : 0xFF;
+				image.pixels[(size_t)y * image.width + x] = p[2] | (p[1] << 8) | (p[0] << 16) | (a << 24);
+			}
+		}
+	}
+	fclose(f);
+	return ok;
+}
+
+// When two renders count as the same picture.
+struct ImageDiffSettings
+{
+	int tolerance = 2;				// Largest per channel difference a pixel can have and still match
+	float maxBadFraction = 0.001f;	// Share of pixels allowed past the tolerance, for the odd edge pixel
+	float minSSIM = 0.99f;
+};
+
+struct ImageDiffResult
+{
+	int maxDifference = 0;			// Worst single channel, 0 -> 255
+	unsigned int badPixels = 0;		// Pixels with any channel past the tolerance
+	double psnr = INFINITY;			// Over red, green and blue, infinite when identical
+	double ssim = 1.0;				// Mean structural similarity of the luminance, 1 is identical
+	bool sizeMatches = false;
+	bool passed = false;
+};
+
+// Compares a render against a golden image, pixel by pixel and perceptually. SSIM is worked out over 8x8 windows
+// every 4 pixels, on luminance, so a slight shift in noise counts for less than a lost edge. Alpha is ignored.
+// diff, if given, gets the golden image greyed out with the pixels past the tolerance in red.
+inline ImageDiffResult DiffImages(const Image& render, const Image& golden, const ImageDiffSettings& settings = ImageDiffSettings(),
+	Image* diff = nullptr)
+{
+	ImageDiffResult result;
+	result.sizeMatches = render.width == golden.width && render.height == golden.height &&
+		render.pixels.size() == golden.pixels.size() && !golden.pixels.empty();
+	if (!result.sizeMatches)
+		return result;
+
+	unsigned int width = golden.width, height = golden.height;
+	size_t count = golden.pixels.size();
+	if (diff != nullptr)
+	{
+		diff->width = width;
+		diff->height = height;
+		diff->pixels.resize(count);
+	}
+
+	double squared = 0.0;
+	std::vector<float> lumaA(count), lumaB(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t a = render.pixels[i], b = golden.pixels[i];
+		int worst = 0;
+		for (int shift = 0; shift < 24; shift += 8)
+		{
+			int d = (int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF);
+			squared += d * d;
+			if (abs(d) > worst)
+				worst = abs(d);
+		}
+		if (worst > result.maxDifference)
+			result.maxDifference = worst;
+		bool bad = worst > settings.tolerance;
+		result.badPixels += bad ? 1 : 0;
+		lumaA[i] = 0.299f * (a & 0xFF) + 0.587f * ((a >> 8) & 0xFF) + 0.114f * ((a >> 16) & 0xFF);
+		lumaB[i] = 0.299f * (b & 0xFF) + 0.587f * ((b >> 8) & 0xFF) + 0.114f * ((b >> 16) & 0xFF);
+		if (diff != nullptr)
+		{
+			uint32_t grey = (uint32_t)(lumaB[i] * 0.5f);
+			diff->pixels[i] = bad ? 0xFF0000FF : (0xFF000000 | grey | (grey << 8) | (grey << 16));
+		}
+	}
+	double mse = squared / (count * 3.0);
+	result.psnr = (mse > 0.0) ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+
+	const double c1 = (0.01 * 255) * (0.01 * 255), c2 = (0.03 * 255) * (0.03 * 255);
+	const unsigned int window = 8, stride = 4;
+	double ssimSum = 0.0;
+	unsigned int windows = 0;
+	for (unsigned int y = 0; y + window <= height; y += stride)
+	{
+		for (unsigned int x = 0; x + window <= width; x += stride)
+		{
+			double sumA = 0, sumB = 0, sumAA = 0, sumBB = 0, sumAB = 0;
+			for (unsigned int wy = 0; wy < window; wy++)
+			{
+				for (unsigned int wx = 0; wx < window; wx++)
+				{
+					size_t i = (size_t)(y + wy) * width + x + wx;
+					double a = lumaA[i], b = lumaB[i];
+					sumA += a;
+					sumB += b;
+					sumAA += a * a;
+					sumBB += b * b;
+					sumAB += a * b;
+				}
+			}
+			double n = window * window;
+			double meanA = sumA / n, meanB = sumB / n;
+			double varA = sumAA / n - meanA * meanA, varB = sumBB / n - meanB * meanB, covar = sumAB / n - meanA * meanB;
+			ssimSum += ((2 * meanA * meanB + c1) * (2 * covar + c2)) / ((meanA * meanA + meanB * meanB + c1) * (varA + varB + c2));
+			windows++;
+		}
+	}
+	result.ssim = windows ? ssimSum / windows : 1.0;
+
+	result.passed = result.badPixels <= settings.maxBadFraction * count && result.ssim >= settings.minSSIM;
+	return result;
+}
@@ -0,0 +1,72 @@
+#include "LightBaker.h"
+#include "StoneHenge.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Bakes ambient occlusion and sun visibility for every StoneHenge vertex and writes them out as a header next to
+// StoneHenge.h, which ReadModel in main.cpp puts into the mesh. Needs nothing but DirectXMath.
+// LightBake [output.h] [threads]   defaults to StoneHengeBake.h and every core.
+
+// Where Mesh's constructor points the sun before it starts turning.
+static const float bakeSunDir[3] = { -0.577f, 0.577f, -0.577f };
+
+int main(int argc, char** argv)
+{
+	const char* output = argc > 1 ? argv[1] : "StoneHengeBake.h";
+	unsigned int threads = argc > 2 ? (unsigned int)atoi(argv[2]) : 0;
+
+	// Scaled down the same as ReadModel.
+	const unsigned int vertexCount = sizeof(StoneHenge_data) / sizeof(StoneHenge_data[0]);
+	const unsigned int indexCount = sizeof(StoneHenge_indicies) / sizeof(StoneHenge_indicies[0]);
+	std::vector<OBJ_VERT> vertices(StoneHenge_data, StoneHenge_data + vertexCount);
+	for (OBJ_VERT& v : vertices)
+		for (int k = 0; k < 3; k++)
+			v.pos[k] *= 0.1f;
+
+	LightBakeSettings settings;
+	settings.threads = threads;
+	XMVECTOR sun = XMVectorSet(bakeSunDir[0], bakeSunDir[1], bakeSunDir[2], 0.0f);
+	auto start = std::chrono::high_resolution_clock::now();
+	std::vector<BakedVertex> baked = LightBaker::Bake(vertices[0].pos, vertices[0].nrm, sizeof(OBJ_VERT), vertexCount,
+		StoneHenge_indicies, indexCount, sun, settings);
+	auto end = std::chrono::high_resolution_clock::now();
+	double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+	// Seeded per vertex, so a single thread has to give exactly the same answer.
+	settings.threads = 1;
+	std::vector<BakedVertex> reference = LightBaker::Bake(vertices[0].pos, vertices[0].nrm, sizeof(OBJ_VERT), vertexCount,
+		StoneHenge_indicies, indexCount, sun, settings);
+	bool matches = true;
+	double aoSum = 0.0, sunSum = 0.0;
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		matches &= baked[i].ao == reference[i].ao && baked[i].sun == reference[i].sun;
+		aoSum += baked[i].ao;
+		sunSum += baked[i].sun;
+	}
+	printf("%u vertices, %u triangles, %u threads: %.1f ms, average ao %.3f, average sun %.3f, %s\n", vertexCount, indexCount / 3,
+		threads ? threads : std::thread::hardware_concurrency(), ms, aoSum / vertexCount, sunSum / vertexCount,
+		matches ? "matches single thread" : "MISMATCH");
+	if (!matches)
+		return 1;
+
+	FILE* f = fopen(output, "w");
+	if (f == nullptr)
+	{
+		printf("Couldn't write %s\n", output);
+		return 1;
+	}
+	fprintf(f, "// File generated by LightBake (LightBake.cpp), rerun it after changing StoneHenge.h.\n");
+	fprintf(f, "// Per vertex of StoneHenge_data: ambient occlusion, then how much of the sun reaches it from StoneHenge_bakeSunDir.\n");
+	fprintf(f, "#ifndef _StoneHenge_bake_\n");
+	fprintf(f, "const float StoneHenge_bakeSunDir[3] = { %ff, %ff, %ff };\n", bakeSunDir[0], bakeSunDir[1], bakeSunDir[2]);
+	fprintf(f, "const float StoneHenge_bake[%u][2] =\n{\n", vertexCount);
+	for (unsigned int i = 0; i < vertexCount; i++)
+		fprintf(f, "\t{ %ff, %ff },\n", baked[i].ao, baked[i].sun);
+	fprintf(f, "};\n#define _StoneHenge_bake_\n#endif\n");
+	fclose(f);
+	printf("Wrote %s\n", output);
+	return 0;
+}
@@ -0,0 +1,299 @@
+#pragma once
+#include "ParallelFor.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace DirectX;
+
+// Bounding volume hierarchy over a triangle list, only answers "is anything in the way" for shadow style rays.
+class BakeBVH
+{
+	struct Node
+	{
+		XMFLOAT3 boundsMin, boundsMax;
+		uint32_t first = 0;		// First child for inner nodes (the second is first + 1), first triangle for leaves
+		uint32_t count = 0;		// Triangles in a leaf, 0 for inner nodes
+	};
+
+	static const uint32_t leafSize = 4;
+
+	std::vector<Node> nodes;
+	std::vector<XMFLOAT3> corners;		// Three per triangle, in leaf order
+	std::vector<uint32_t> order;		// Triangle indices, sorted into leaves while building
+
+	void Bound(Node& node, const std::vector<XMFLOAT3>& centroids, uint32_t first, uint32_t count, XMVECTOR& centroidMin, XMVECTOR& centroidMax) const
+	{
+		XMVECTOR vMin = XMVectorReplicate(FLT_MAX), vMax = XMVectorReplicate(-FLT_MAX);
+		centroidMin = vMin;
+		centroidMax = vMax;
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				XMVECTOR p = XMLoadFloat3(&corners[order[i] * 3 + k]);
+				vMin = XMVectorMin(vMin, p);
+				vMax = XMVectorMax(vMax, p);
+			}
+			XMVECTOR c = XMLoadFloat3(&centroids[order[i]]);
+			centroidMin = XMVectorMin(centroidMin, c);
+			centroidMax = XMVectorMax(centroidMax, c);
+		}
+		XMStoreFloat3(&node.boundsMin, vMin);
+		XMStoreFloat3(&node.boundsMax, vMax);
+	}
+
+	// Splits at the middle of the widest axis of the centroids, falling back to halving the list.
+	void Build(uint32_t nodeIndex, const std::vector<XMFLOAT3>& centroids, uint32_t first, uint32_t count)
+	{
+		XMVECTOR centroidMin, centroidMax;
+		Bound(nodes[nodeIndex], centroids, first, count, centroidMin, centroidMax);
+		if (count <= leafSize)
+		{
+			nodes[nodeIndex].first = first;
+			nodes[nodeIndex].count = count;
+			return;
+		}
+
+		XMFLOAT3 extent, middle;
+		XMStoreFloat3(&extent, XMVectorSubtract(centroidMax, centroidMin));
+		XMStoreFloat3(&middle, XMVectorScale(XMVectorAdd(centroidMin, centroidMax), 0.5f));
+		int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+		float split = (&middle.x)[axis];
+		uint32_t* begin = order.data() + first;
+		uint32_t* mid = begin;
+		for (uint32_t* it = begin; it != begin + count; it++)
+		{
+			if ((&centroids[*it].x)[axis] < split)
+				std::swap(*it, *mid++);
+		}
+		uint32_t leftCount = (uint32_t)(mid - begin);
+		if (leftCount == 0 || leftCount == count)
+			leftCount = count / 2;
+
+		uint32_t left = (uint32_t)nodes.size();
+		nodes.resize(nodes.size() + 2);
+		nodes[nodeIndex].first = left;
+		nodes[nodeIndex].count = 0;
+		Build(left, centroids, first, leftCount);
+		Build(left + 1, centroids, first + leftCount, count - leftCount);
+	}
+
+	// Slab test, rcp is 1 / direction.
+	static bool HitsBox(const Node& node, const XMFLOAT3& origin, const XMFLOAT3& rcp, float maxT)
+	{
+		float t0 = 0.0f, t1 = maxT;
+		const float* o = &origin.x;
+		const float* r = &rcp.x;
+		const float* lo = &node.boundsMin.x;
+		const float* hi = &node.boundsMax.x;
+		for (int k = 0; k < 3; k++)
+		{
+			float a = (lo[k] - o[k]) * r[k], b = (hi[k] - o[k]) * r[k];
+			t0 = fmaxf(t0, fminf(a, b));
+			t1 = fminf(t1, fmaxf(a, b));
+		}
+		return t0 <= t1;
+	}
+
+	// Moller-Trumbore, both sides count.
+	static bool HitsTriangle(const XMFLOAT3* tri, FXMVECTOR origin, FXMVECTOR direction, float minT, float maxT)
+	{
+		XMVECTOR v0 = XMLoadFloat3(&tri[0]);
+		XMVECTOR e1 = XMVectorSubtract(XMLoadFloat3(&tri[1]), v0);
+		XMVECTOR e2 = XMVectorSubtract(XMLoadFloat3(&tri[2]), v0);
+		XMVECTOR p = XMVector3Cross(direction, e2);
+		float det = XMVectorGetX(XMVector3Dot(e1, p));
+		if (fabsf(det) < 1e-12f)
+			return false;
+		float invDet = 1.0f / det;
+		XMVECTOR s = XMVectorSubtract(origin, v0);
+		float u = XMVectorGetX(XMVector3Dot(s, p)) * invDet;
+		if (u < 0.0f || u > 1.0f)
+			return false;
+		XMVECTOR q = XMVector3Cross(s, e1);
+		float v = XMVectorGetX(XMVector3Dot(direction, q)) * invDet;
+		if (v < 0.0f || u + v > 1.0f)
+			return false;
+		float t = XMVectorGetX(XMVector3Dot(e2, q)) * invDet;
+		return t > minT && t < maxT;
+	}
+
+public:
+	// positionStride is in bytes, so the positions can be read straight out of a vertex array.
+	void Build(const float* positions, size_t positionStride, const unsigned int* indices, unsigned int indexCount)
+	{
+		uint32_t triangleCount = indexCount / 3;
+		std::vector<XMFLOAT3> unsorted(triangleCount * 3), centroids(triangleCount);
+		for (uint32_t t = 0; t < triangleCount; t++)
+		{
+			XMVECTOR sum = XMVectorZero();
+			for (int k = 0; k < 3; k++)
+			{
+				const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + indices[t * 3 + k] * positionStride);
+				unsorted[t * 3 + k] = XMFLOAT3(p[0], p[1], p[2]);
+				sum = XMVectorAdd(sum, XMLoadFloat3(&unsorted[t * 3 + k]));
+			}
+			XMStoreFloat3(&centroids[t], XMVectorScale(sum, 1.0f / 3.0f));
+		}
+
+		corners = unsorted;
+		order.resize(triangleCount);
+		for (uint32_t t = 0; t < triangleCount; t++)
+			order[t] = t;
+		nodes.assign(1, Node());
+		if (triangleCount == 0)
+			return;
+		Build(0, centroids, 0, triangleCount);
+
+		// Leaves read their corners in order.
+		for (uint32_t i = 0; i < triangleCount; i++)
+			for (int k = 0; k < 3; k++)
+				corners[i * 3 + k] = unsorted[order[i] * 3 + k];
+	}
+
+	// True if any triangle crosses the ray between minT and maxT. direction doesn't have to be normalized, t is in
+	// multiples of it.
+	bool Occluded(FXMVECTOR origin, FXMVECTOR direction, float minT, float maxT) const
+	{
+		if (order.empty())
+			return false;
+		XMFLOAT3 o, d, rcp;
+		XMStoreFloat3(&o, origin);
+		XMStoreFloat3(&d, direction);
+		// Zero components become huge rather than infinite, so 0 * rcp stays 0 in the slab test.
+		rcp = XMFLOAT3(1.0f / (fabsf(d.x) > 1e-20f ? d.x : 1e-20f), 1.0f / (fabsf(d.y) > 1e-20f ? d.y : 1e-20f),
+			1.0f / (fabsf(d.z) > 1e-20f ? d.z : 1e-20f));
+
+		uint32_t stack[64];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			const Node& node = nodes[stack[--top]];
+			if (!HitsBox(node, o, rcp, maxT))
+				continue;
+			if (node.count == 0)
+			{
+				stack[top++] = node.first;
+				stack[top++] = node.first + 1;
+				continue;
+			}
+			for (uint32_t i = node.first; i < node.first + node.count; i++)
+			{
+				if (HitsTriangle(&corners[i * 3], origin, direction, minT, maxT))
+					return true;
+			}
+		}
+		return false;
+	}
+
+	unsigned int NodeCount() const { return (unsigned int)nodes.size(); }
+};
+
+// What the baker leaves on each vertex, both 0 -> 1.
+struct BakedVertex
+{
+	float ao = 1.0f;			// Cosine weighted share of the sky the vertex sees
+	float sun = 1.0f;			// Share of the sun's disc it sees
+};
+
+struct LightBakeSettings
+{
+	unsigned int aoRays = 256;
+	float aoDistance = 0.5f;		// Further hits don't occlude, keeps open ground from going grey under a distant stone
+	unsigned int sunRays = 32;
+	float sunAngle = 0.02f;			// Radius of the sun's disc in radians, softens the baked shadow edges
+	float bias = 0.002f;			// Ray starts are pushed this far off the surface along the normal
+	unsigned int threads = 0;		// 0 uses every hardware thread
+};
+
+// Bakes ambient occlusion and static sun visibility into mesh vertices by casting rays against a BakeBVH of the
+// mesh itself. Each vertex is independent and seeded by its index, so the result doesn't depend on the thread count.
+class LightBaker
+{
+	// PCG style hash, one stream of numbers per vertex.
+	struct Random
+	{
+		uint32_t state;
+		explicit Random(uint32_t seed) : state(seed * 747796405u + 2891336453u) {}
+		float Next()
+		{
+			state = state * 747796405u + 2891336453u;
+			uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+			return ((word >> 22u) ^ word) * (1.0f / 4294967296.0f);
+		}
+	};
+
+	// Any two axes at right angles to n.
+	static void Basis(FXMVECTOR n, XMVECTOR& t, XMVECTOR& b)
+	{
+		XMVECTOR up = fabsf(XMVectorGetY(n)) < 0.9f ? XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f) : XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+		t = XMVector3Normalize(XMVector3Cross(up, n));
+		b = XMVector3Cross(n, t);
+	}
+
+	// Cell (i, j) of a side x side grid over the square, jittered, then mapped onto a cosine weighted hemisphere.
+	static XMVECTOR CosineSample(unsigned int i, unsigned int j, unsigned int side, Random& rng, FXMVECTOR n, FXMVECTOR t, FXMVECTOR b)
+	{
+		float u = (i + rng.Next()) / side, v = (j + rng.Next()) / side;
+		float r = sqrtf(u), phi = XM_2PI * v;
+		float z = sqrtf(fmaxf(0.0f, 1.0f - u));
+		return XMVectorAdd(XMVectorAdd(XMVectorScale(t, r * cosf(phi)), XMVectorScale(b, r * sinf(phi))), XMVectorScale(n, z));
+	}
+
+public:
+	// Positions and normals are read with the same byte stride, e.g. &vertices[0].Pos and &vertices[0].Normal.
+	// sunDir points toward the sun. Returns one BakedVertex per vertex.
+	static std::vector<BakedVertex> Bake(const float* positions, const float* normals, size_t stride, unsigned int vertexCount,
+		const unsigned int* indices, unsigned int indexCount, FXMVECTOR sunDir, const LightBakeSettings& settings = LightBakeSettings())
+	{
+		BakeBVH bvh;
+		bvh.Build(positions, stride, indices, indexCount);
+
+		XMVECTOR sun = XMVector3Normalize(sunDir);
+		XMVECTOR sunT, sunB;
+		Basis(sun, sunT, sunB);
+		unsigned int aoSide = (unsigned int)ceilf(sqrtf((float)settings.aoRays));
+		unsigned int sunSide = (unsigned int)ceilf(sqrtf((float)settings.sunRays));
+		if (aoSide < 1)
+			aoSide = 1;
+		if (sunSide < 1)
+			sunSide = 1;
+
+		std::vector<BakedVertex> baked(vertexCount);
+		ParallelFor(settings.threads, vertexCount, 16, [&](unsigned int v)
+		{
+			const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + v * stride);
+			const float* nrm = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(normals) + v * stride);
+			XMVECTOR n = XMVector3Normalize(XMVectorSet(nrm[0], nrm[1], nrm[2], 0.0f));
+			XMVECTOR origin = XMVectorAdd(XMVectorSet(p[0], p[1], p[2], 0.0f), XMVectorScale(n, settings.bias));
+			XMVECTOR t, b;
+			Basis(n, t, b);
+			Random rng(v);
+
+			unsigned int open = 0;
+			for (unsigned int i = 0; i < aoSide; i++)
+				for (unsigned int j = 0; j < aoSide; j++)
+					open += bvh.Occluded(origin, CosineSample(i, j, aoSide, rng, n, t, b), 0.0f, settings.aoDistance) ? 0 : 1;
+			baked[v].ao = (float)open / (aoSide * aoSide);
+
+			// Uniform over the sun's disc, nothing is too far away to shadow.
+			open = 0;
+			for (unsigned int i = 0; i < sunSide; i++)
+			{
+				for (unsigned int j = 0; j < sunSide; j++)
+				{
+					float r = settings.sunAngle * sqrtf((i + rng.Next()) / sunSide), phi = XM_2PI * (j + rng.Next()) / sunSide;
+					XMVECTOR dir = XMVectorAdd(sun, XMVectorAdd(XMVectorScale(sunT, r * cosf(phi)), XMVectorScale(sunB, r * sinf(phi))));
+					open += bvh.Occluded(origin, dir, 0.0f, FLT_MAX) ? 0 : 1;
+				}
+			}
+			baked[v].sun = (float)open / (sunSide * sunSide);
+		});
+		return baked;
+	}
+};
@@ -0,0 +1,245 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "ClusteredLighting.h"
+
+using namespace DirectX;
+
+enum LightType : uint8_t
+{
+	LIGHT_DIRECTIONAL,	// Lives in the constant buffer, never clustered
+	LIGHT_POINT,
+	LIGHT_SPOT
+};
+
+// Everything needed to add a light. Spins are radians per unit of animation time around the world y axis.
+struct LightDesc
+{
+	LightType type = LIGHT_POINT;
+	XMFLOAT3 position = XMFLOAT3(0, 0, 0);
+	XMFLOAT3 direction = XMFLOAT3(0, -1, 0);
+	XMFLOAT3 color = XMFLOAT3(1, 1, 1);
+	float range = 1.0f;
+	float spotCos = -1.0f;		// Cosine of the cone's half angle, spot lights only
+	float positionSpin = 0.0f;
+	float directionSpin = 0.0f;
+};
+
+// Every light in the scene, stored as structure of arrays so animation runs four lights per instruction.
+// Point and spot lights also get a slot in the packed ClusterLight array the GPU reads. Anything that changes a
+// light marks its slot dirty, and only dirty runs of slots need uploading.
+class LightManager
+{
+	// Padded to a multiple of four, the padding lights never spin.
+	std::vector<float> px, py, pz, dx, dy, dz, cr, cg, cb, range, spotCos, posSpin, dirSpin;
+	std::vector<LightType> type;
+	std::vector<int32_t> slot;				// Index into packed, -1 for directional lights
+	unsigned int count = 0;
+
+	std::vector<ClusterLight> packed;
+	std::vector<uint64_t> dirty;			// One bit per packed slot
+
+	static unsigned int Padded(unsigned int n) { return (n + 3) & ~3u; }
+
+	void MarkDirty(unsigned int i)
+	{
+		if (slot[i] >= 0)
+			dirty[slot[i] >> 6] |= 1ull << (slot[i] & 63);
+	}
+
+	void Grow()
+	{
+		unsigned int size = Padded(count);
+		for (std::vector<float>* v : { &px, &py, &pz, &dx, &dy, &dz, &cr, &cg, &cb, &range, &spotCos, &posSpin, &dirSpin })
+			v->resize(size, 0.0f);
+		type.resize(size, LIGHT_DIRECTIONAL);
+		slot.resize(size, -1);
+	}
+
+	// x' = x cos + z sin, z' = z cos - x sin, the same turn XMMatrixRotationY gives.
+	static void RotateY(XMVECTOR& x, XMVECTOR& z, FXMVECTOR s, FXMVECTOR c)
+	{
+		XMVECTOR nx = XMVectorMultiplyAdd(z, s, XMVectorMultiply(x, c));
+		z = XMVectorNegativeMultiplySubtract(x, s, XMVectorMultiply(z, c));
+		x = nx;
+	}
+
+	static XMVECTOR Load4(const std::vector<float>& v, unsigned int i)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&v[i]));
+	}
+
+	static void Store4(std::vector<float>& v, unsigned int i, FXMVECTOR value)
+	{
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&v[i]), value);
+	}
+
+public:
+	unsigned int Add(const LightDesc& desc)
+	{
+		unsigned int i = count++;
+		Grow();
+		type[i] = desc.type;
+		if (desc.type != LIGHT_DIRECTIONAL)
+		{
+			slot[i] = (int32_t)packed.size();
+			packed.push_back(ClusterLight());
+			dirty.resize((packed.size() + 63) / 64, 0);
+		}
+		SetPosition(i, desc.position);
+		SetDirection(i, desc.direction);
+		SetColor(i, desc.color);
+		SetRange(i, desc.range);
+		SetSpotCos(i, desc.spotCos);
+		SetSpin(i, desc.positionSpin, desc.directionSpin);
+		return i;
+	}
+
+	// Drops every light from index n on, the ones before keep their indices and slots.
+	void Truncate(unsigned int n)
+	{
+		if (n >= count)
+			return;
+		unsigned int slots = 0;
+		for (unsigned int i = 0; i < n; i++)
+			slots += (slot[i] >= 0) ? 1 : 0;
+		count = n;
+		for (unsigned int i = count; i < type.size(); i++)
+		{
+			type[i] = LIGHT_DIRECTIONAL;
+			slot[i] = -1;
+			posSpin[i] = dirSpin[i] = 0.0f;
+		}
+		Grow();
+		packed.resize(slots);
+		dirty.resize((slots + 63) / 64);
+		if (slots & 63)
+			dirty.back() &= (1ull << (slots & 63)) - 1;
+	}
+
+	void SetPosition(unsigned int i, const XMFLOAT3& p) { px[i] = p.x; py[i] = p.y; pz[i] = p.z; MarkDirty(i); }
+	void SetDirection(unsigned int i, const XMFLOAT3& d) { dx[i] = d.x; dy[i] = d.y; dz[i] = d.z; MarkDirty(i); }
+	void SetColor(unsigned int i, const XMFLOAT3& c) { cr[i] = c.x; cg[i] = c.y; cb[i] = c.z; MarkDirty(i); }
+	void SetRange(unsigned int i, float r) { range[i] = r; MarkDirty(i); }
+	void SetSpotCos(unsigned int i, float c) { spotCos[i] = c; MarkDirty(i); }
+	// Spinning doesn't change the light until the next Animate, so it doesn't dirty anything.
+	void SetSpin(unsigned int i, float positionSpin, float directionSpin) { posSpin[i] = positionSpin; dirSpin[i] = directionSpin; }
+
+	// One off turn of a light's direction around y, for dragging it with the mouse.
+	void RotateDirection(unsigned int i, float angle)
+	{
+		float s = sinf(angle), c = cosf(angle);
+		float x = dx[i], z = dz[i];
+		dx[i] = x * c + z * s;
+		dz[i] = z * c - x * s;
+		MarkDirty(i);
+	}
+
+	XMFLOAT3 Position(unsigned int i) const { return XMFLOAT3(px[i], py[i], pz[i]); }
+	XMFLOAT3 Direction(unsigned int i) const { return XMFLOAT3(dx[i], dy[i], dz[i]); }
+	XMFLOAT3 Color(unsigned int i) const { return XMFLOAT3(cr[i], cg[i], cb[i]); }
+	float Range(unsigned int i) const { return range[i]; }
+	float SpotCos(unsigned int i) const { return spotCos[i]; }
+	LightType Type(unsigned int i) const { return type[i]; }
+	int32_t Slot(unsigned int i) const { return slot[i]; }	// Index into Packed(), -1 for directional lights
+	unsigned int Count() const { return count; }
+
+	// Turns every spinning light by its spin times dt, four at a time. Groups of four that don't spin are skipped.
+	void Animate(float dt)
+	{
+		XMVECTOR step = XMVectorReplicate(dt);
+		XMVECTOR zero = XMVectorZero();
+		for (unsigned int i = 0; i < count; i += 4)
+		{
+			XMVECTOR posAngle = XMVectorMultiply(Load4(posSpin, i), step);
+			XMVECTOR dirAngle = XMVectorMultiply(Load4(dirSpin, i), step);
+			XMVECTOR moving = XMVectorOrInt(XMVectorNotEqual(posAngle, zero), XMVectorNotEqual(dirAngle, zero));
+			uint32_t mask[4];
+			XMStoreInt4(mask, moving);
+			if (!(mask[0] | mask[1] | mask[2] | mask[3]))
+				continue;
+
+			XMVECTOR s, c;
+			XMVectorSinCos(&s, &c, posAngle);
+			XMVECTOR x = Load4(px, i), z = Load4(pz, i);
+			RotateY(x, z, s, c);
+			Store4(px, i, x);
+			Store4(pz, i, z);
+
+			XMVectorSinCos(&s, &c, dirAngle);
+			x = Load4(dx, i);
+			z = Load4(dz, i);
+			RotateY(x, z, s, c);
+			Store4(dx, i, x);
+			Store4(dz, i, z);
+
+			for (unsigned int l = 0; l < 4 && i + l < count; l++)
+			{
+				if (mask[l])
+					MarkDirty(i + l);
+			}
+		}
+	}
+
+	// Refreshes the packed copy of every dirty slot. Spot directions are normalized on the way.
+	const std::vector<ClusterLight>& Pack()
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			int32_t s = slot[i];
+			if (s < 0 || !(dirty[s >> 6] & (1ull << (s & 63))))
+				continue;
+			ClusterLight& l = packed[s];
+			l.position = XMFLOAT3(px[i], py[i], pz[i]);
+			l.range = range[i];
+			l.color = XMFLOAT3(cr[i], cg[i], cb[i]);
+			l.spotCos = (type[i] == LIGHT_SPOT) ? spotCos[i] : -1.0f;
+			float len = sqrtf(dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+			l.direction = (len > 0.0f) ? XMFLOAT3(dx[i] / len, dy[i] / len, dz[i] / len) : XMFLOAT3(0, -1, 0);
+			l.pad = 0.0f;
+		}
+		return packed;
+	}
+
+	const std::vector<ClusterLight>& Packed() const { return packed; }
+
+	// Dirty slots as (first, count) runs. Runs with at most gap clean slots between them are merged: re-sending gap lights
+	// (gap * 48 bytes) is cheaper than another UpdateSubresource call.
+	void DirtyRuns(std::vector<std::pair<uint32_t, uint32_t>>& runs, uint32_t gap = 8) const
+	{
+		runs.clear();
+		for (uint32_t s = 0; s < (uint32_t)packed.size(); s++)
+		{
+			if (!(dirty[s >> 6] & (1ull << (s & 63))))
+				continue;
+			if (!runs.empty() && s - (runs.back().first + runs.back().second) <= gap)
+				runs.back().second = s + 1 - runs.back().first;
+			else
+				runs.push_back(std::make_pair(s, 1u));
+		}
+	}
+
+	unsigned int DirtyCount() const
+	{
+		unsigned int n = 0;
+		for (uint64_t word : dirty)
+			for (; word; word &= word - 1)
+				n++;
+		return n;
+	}
+
+	void MarkAllDirty()
+	{
+		for (unsigned int i = 0; i < count; i++)
+			MarkDirty(i);
+	}
+
+	void ClearDirty()
+	{
+		for (uint64_t& word : dirty)
+			word = 0;
+	}
+};
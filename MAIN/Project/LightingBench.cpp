@@ -0,0 +1,107 @@
+#include "LightingKernel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Times LightingKernel::Shade against the scalar ShadeReference on random fragments, with and without the normal
+// map, and checks they agree. Needs nothing but DirectXMath.
+// LightingBench [fragment count]   defaults to 1048576 fragments.
+
+// The lights as Mesh sets them up at the start.
+static LightingParams ProjectLights()
+{
+	LightingParams p;
+	p.sunDir = XMFLOAT3(-0.577f, 0.577f, -0.577f);
+	p.sunColor = XMFLOAT3(0.6f, 0.6f, 0.6f);
+	p.pointPos = XMFLOAT3(0.0f, 0.2f, -1.0f);
+	p.pointColor = XMFLOAT3(0.0f, 0.8f, 0.8f);
+	p.spotPos = XMFLOAT3(0.0f, 2.0f, -2.0f);
+	p.spotDir = XMFLOAT3(0.0f, 0.577f, -0.577f);
+	p.spotColor = XMFLOAT3(1.0f, 0.0f, 0.0f);
+	p.cone = 20.0f;
+	return p;
+}
+
+static std::vector<LightingFragments> RandomFragments(unsigned int batches, unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> pos(-3.0f, 3.0f), height(0.0f, 2.0f), signedUnit(-1.0f, 1.0f), unit(0.0f, 1.0f);
+	std::vector<LightingFragments> fragments(batches);
+	for (LightingFragments& f : fragments)
+	{
+		for (unsigned int i = 0; i < LightingFragments::size; i++)
+		{
+			f.posX[i] = f.tangX[i] = pos(rng);
+			f.posY[i] = f.tangY[i] = height(rng);
+			f.posZ[i] = f.tangZ[i] = pos(rng);
+			// Interpolated normals are a little short of unit length.
+			XMFLOAT3 n;
+			XMStoreFloat3(&n, XMVectorScale(XMVector3Normalize(XMVectorSet(signedUnit(rng), signedUnit(rng), signedUnit(rng), 0.0f)), 0.9f + 0.1f * unit(rng)));
+			f.normX[i] = n.x;
+			f.normY[i] = n.y;
+			f.normZ[i] = n.z;
+			// Mostly facing out of the surface, like a real normal map.
+			f.mapX[i] = 0.5f + 0.3f * signedUnit(rng);
+			f.mapY[i] = 0.5f + 0.3f * signedUnit(rng);
+			f.mapZ[i] = 0.8f + 0.2f * unit(rng);
+			f.albedoR[i] = unit(rng);
+			f.albedoG[i] = unit(rng);
+			f.albedoB[i] = unit(rng);
+		}
+	}
+	return fragments;
+}
+
+static bool Bench(unsigned int count, bool normalMapped)
+{
+	unsigned int batches = (count + LightingFragments::size - 1) / LightingFragments::size;
+	LightingParams lights = ProjectLights();
+	std::vector<LightingFragments> simd = RandomFragments(batches, count), reference = simd;
+
+	const int runs = 10;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < runs; r++)
+		for (LightingFragments& f : simd)
+			LightingKernel::Shade(lights, f, LightingFragments::size, normalMapped);
+	auto end = std::chrono::high_resolution_clock::now();
+	double simdMs = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < runs; r++)
+		for (LightingFragments& f : reference)
+			LightingKernel::ShadeReference(lights, f, LightingFragments::size, normalMapped);
+	end = std::chrono::high_resolution_clock::now();
+	double refMs = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+
+	// Only the order of the multiplies differs, well under what an 8 bit target can show.
+	float worst = 0.0f;
+	for (unsigned int b = 0; b < batches; b++)
+	{
+		for (unsigned int i = 0; i < LightingFragments::size; i++)
+		{
+			worst = fmaxf(worst, fabsf(simd[b].r[i] - reference[b].r[i]));
+			worst = fmaxf(worst, fabsf(simd[b].g[i] - reference[b].g[i]));
+			worst = fmaxf(worst, fabsf(simd[b].b[i] - reference[b].b[i]));
+		}
+	}
+
+	bool match = worst < 1e-4f;
+	printf("%-14s %8u fragments: simd %.3f ms, reference %.3f ms (%.1fx), worst difference %g, %s\n",
+		normalMapped ? "normal mapped" : "plain", batches * LightingFragments::size, simdMs, refMs, refMs / simdMs,
+		worst, match ? "matches" : "MISMATCH");
+	return match;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int count = argc > 1 ? (unsigned int)atoi(argv[1]) : 1048576;
+	if (count == 0)
+		count = LightingFragments::size;
+
+	bool ok = Bench(count, false);
+	ok &= Bench(count, true);
+	return ok ? 0 : 1;
+}
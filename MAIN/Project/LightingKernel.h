@@ -0,0 +1,214 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cmath>
+
+using namespace DirectX;
+
+// The three fixed lights PSPermutation shades with: slot 0 directional, 1 point, 2 spot.
+struct LightingParams
+{
+	XMFLOAT3 sunDir = { 0, 0, 0 };		// Toward the sun, vLightDir[0]
+	XMFLOAT3 sunColor = { 0, 0, 0 };
+	XMFLOAT3 pointPos = { 0, 0, 0 };	// vLightDir[1]
+	XMFLOAT3 pointColor = { 0, 0, 0 };
+	XMFLOAT3 spotPos = { 0, 0, 0 };
+	XMFLOAT3 spotDir = { 0, 0, 0 };		// From the lit surface toward the spot light, vLightDir[2]
+	XMFLOAT3 spotColor = { 0, 0, 0 };
+	float cone = 0;						// 25 x the cosine of the spot's edge, as the shader takes it
+
+	// From anything with the shader's lightDir, lightClr, spotLightPos and cone fields, e.g. Mesh's ConstantBuffer.
+	template <typename Constants>
+	static LightingParams FromConstants(const Constants& c)
+	{
+		LightingParams p;
+		p.sunDir = XMFLOAT3(c.lightDir[0].x, c.lightDir[0].y, c.lightDir[0].z);
+		p.sunColor = XMFLOAT3(c.lightClr[0].x, c.lightClr[0].y, c.lightClr[0].z);
+		p.pointPos = XMFLOAT3(c.lightDir[1].x, c.lightDir[1].y, c.lightDir[1].z);
+		p.pointColor = XMFLOAT3(c.lightClr[1].x, c.lightClr[1].y, c.lightClr[1].z);
+		p.spotPos = XMFLOAT3(c.spotLightPos.x, c.spotLightPos.y, c.spotLightPos.z);
+		p.spotDir = XMFLOAT3(c.lightDir[2].x, c.lightDir[2].y, c.lightDir[2].z);
+		p.spotColor = XMFLOAT3(c.lightClr[2].x, c.lightClr[2].y, c.lightClr[2].z);
+		p.cone = c.cone;
+		return p;
+	}
+};
+
+// A batch of fragments as structure of arrays, what PSPermutation gets per pixel and what it returns.
+// Fill the inputs of the first count fragments, Shade writes r, g and b of the same ones.
+struct LightingFragments
+{
+	static const unsigned int size = 16;
+
+	float posX[size], posY[size], posZ[size];		// World position
+	float normX[size], normY[size], normZ[size];	// Interpolated normal, not normalized (the shader doesn't)
+	float tangX[size], tangY[size], tangZ[size];	// Interpolated tangent, only read when normal mapped
+	float mapX[size], mapY[size], mapZ[size];		// Normal map sample in 0 -> 1, only read when normal mapped
+	float albedoR[size], albedoG[size], albedoB[size];	// Diffuse texture sample
+	float r[size], g[size], b[size];
+};
+
+// The lit branch of PSPermutation with the fixed directional, point and spot lights, on the CPU. It keeps the
+// shader's quirks so it can stand in for it: the point light's range check always passes (it measures a
+// normalized vector) and the spot light is scaled by the color gathered so far. Alpha is always 1.
+// ShadeReference is a line by line scalar copy of the HLSL, Shade does the same four fragments at a time.
+class LightingKernel
+{
+	static float Saturate(float v) { return fminf(fmaxf(v, 0.0f), 1.0f); }
+
+	// Straight off a structure of arrays row.
+	static XMVECTOR Load(const float* row) { return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(row)); }
+	static void Store(float* row, FXMVECTOR v) { XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(row), v); }
+
+	// Four 3D vectors, one per lane, as separate x, y and z.
+	static XMVECTOR Dot(FXMVECTOR ax, FXMVECTOR ay, FXMVECTOR az, GXMVECTOR bx, HXMVECTOR by, HXMVECTOR bz)
+	{
+		return XMVectorMultiplyAdd(az, bz, XMVectorMultiplyAdd(ay, by, XMVectorMultiply(ax, bx)));
+	}
+
+	static void Normalize(XMVECTOR& x, XMVECTOR& y, XMVECTOR& z)
+	{
+		XMVECTOR length = XMVectorSqrt(Dot(x, y, z, x, y, z));
+		x = XMVectorDivide(x, length);
+		y = XMVectorDivide(y, length);
+		z = XMVectorDivide(z, length);
+	}
+
+public:
+	static void ShadeReference(const LightingParams& p, LightingFragments& f, unsigned int count, bool normalMapped)
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			float n[3] = { f.normX[i], f.normY[i], f.normZ[i] };
+
+			if (normalMapped)
+			{
+				float m[3] = { 2.0f * f.mapX[i] - 1.0f, 2.0f * f.mapY[i] - 1.0f, 2.0f * f.mapZ[i] - 1.0f };
+				float t[3] = { f.tangX[i], f.tangY[i], f.tangZ[i] };
+				float tn = t[0] * n[0] + t[1] * n[1] + t[2] * n[2];
+				for (int k = 0; k < 3; k++)
+					t[k] -= tn * n[k];
+				float tLength = sqrtf(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+				for (int k = 0; k < 3; k++)
+					t[k] /= tLength;
+				float b[3] = { n[1] * t[2] - n[2] * t[1], n[2] * t[0] - n[0] * t[2], n[0] * t[1] - n[1] * t[0] };
+				float mapped[3];
+				for (int k = 0; k < 3; k++)
+					mapped[k] = m[0] * t[k] + m[1] * b[k] + m[2] * n[k];
+				float mLength = sqrtf(mapped[0] * mapped[0] + mapped[1] * mapped[1] + mapped[2] * mapped[2]);
+				for (int k = 0; k < 3; k++)
+					n[k] = mapped[k] / mLength;
+			}
+
+			float color[3] = { 0.05f, 0.05f, 0.05f };
+			const float sunColor[3] = { p.sunColor.x, p.sunColor.y, p.sunColor.z };
+			const float pointColor[3] = { p.pointColor.x, p.pointColor.y, p.pointColor.z };
+			const float spotColor[3] = { p.spotColor.x, p.spotColor.y, p.spotColor.z };
+
+			// Directional
+			float sun = p.sunDir.x * n[0] + p.sunDir.y * n[1] + p.sunDir.z * n[2];
+			for (int k = 0; k < 3; k++)
+				color[k] += Saturate(sun * sunColor[k]);
+
+			// Point
+			float l[3] = { p.pointPos.x - f.posX[i], p.pointPos.y - f.posY[i], p.pointPos.z - f.posZ[i] };
+			float lLength = sqrtf(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+			float point = (l[0] * n[0] + l[1] * n[1] + l[2] * n[2]) / lLength;
+			for (int k = 0; k < 3; k++)
+				color[k] += Saturate(point * pointColor[k]);
+
+			// Spot
+			float s[3] = { p.spotPos.x - f.posX[i], p.spotPos.y - f.posY[i], p.spotPos.z - f.posZ[i] };
+			float sLength = sqrtf(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+			for (int k = 0; k < 3; k++)
+				s[k] /= sLength;
+			float surfaceRatio = Saturate(s[0] * p.spotDir.x + s[1] * p.spotDir.y + s[2] * p.spotDir.z);
+			float coneRatio = p.cone / 25.0f;
+			float innerConeRatio = (p.cone + 0.25f) / 25.0f;
+			if (surfaceRatio > coneRatio)
+			{
+				float lightRatio = Saturate(s[0] * n[0] + s[1] * n[1] + s[2] * n[2]);
+				float atten = 1.0f - Saturate((innerConeRatio - surfaceRatio) / (innerConeRatio - coneRatio));
+				for (int k = 0; k < 3; k++)
+					color[k] += Saturate(lightRatio * spotColor[k] * color[k] * atten);
+			}
+
+			f.r[i] = color[0] * f.albedoR[i];
+			f.g[i] = color[1] * f.albedoG[i];
+			f.b[i] = color[2] * f.albedoB[i];
+		}
+	}
+
+	// Rounds count up to whole groups of four, the extra lanes are shaded from whatever they hold and ignored.
+	static void Shade(const LightingParams& p, LightingFragments& f, unsigned int count, bool normalMapped)
+	{
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR one = XMVectorSplatOne();
+		const XMVECTOR two = XMVectorReplicate(2.0f);
+		const XMVECTOR ambient = XMVectorReplicate(0.05f);
+		const XMVECTOR sunX = XMVectorReplicate(p.sunDir.x), sunY = XMVectorReplicate(p.sunDir.y), sunZ = XMVectorReplicate(p.sunDir.z);
+		const XMVECTOR spotDirX = XMVectorReplicate(p.spotDir.x), spotDirY = XMVectorReplicate(p.spotDir.y), spotDirZ = XMVectorReplicate(p.spotDir.z);
+		const XMVECTOR coneRatio = XMVectorReplicate(p.cone / 25.0f);
+		const XMVECTOR innerConeRatio = XMVectorReplicate((p.cone + 0.25f) / 25.0f);
+		const XMVECTOR coneWidth = XMVectorSubtract(innerConeRatio, coneRatio);
+		const float* sunColor = &p.sunColor.x;
+		const float* pointColor = &p.pointColor.x;
+		const float* spotColor = &p.spotColor.x;
+		const float* albedo[3] = { f.albedoR, f.albedoG, f.albedoB };
+		float* out[3] = { f.r, f.g, f.b };
+
+		for (unsigned int i = 0; i < count; i += 4)
+		{
+			XMVECTOR nx = Load(&f.normX[i]), ny = Load(&f.normY[i]), nz = Load(&f.normZ[i]);
+
+			if (normalMapped)
+			{
+				XMVECTOR mx = XMVectorSubtract(XMVectorMultiply(Load(&f.mapX[i]), two), one);
+				XMVECTOR my = XMVectorSubtract(XMVectorMultiply(Load(&f.mapY[i]), two), one);
+				XMVECTOR mz = XMVectorSubtract(XMVectorMultiply(Load(&f.mapZ[i]), two), one);
+				XMVECTOR tx = Load(&f.tangX[i]), ty = Load(&f.tangY[i]), tz = Load(&f.tangZ[i]);
+				XMVECTOR tn = Dot(tx, ty, tz, nx, ny, nz);
+				tx = XMVectorNegativeMultiplySubtract(tn, nx, tx);
+				ty = XMVectorNegativeMultiplySubtract(tn, ny, ty);
+				tz = XMVectorNegativeMultiplySubtract(tn, nz, tz);
+				Normalize(tx, ty, tz);
+				XMVECTOR bx = XMVectorSubtract(XMVectorMultiply(ny, tz), XMVectorMultiply(nz, ty));
+				XMVECTOR by = XMVectorSubtract(XMVectorMultiply(nz, tx), XMVectorMultiply(nx, tz));
+				XMVECTOR bz = XMVectorSubtract(XMVectorMultiply(nx, ty), XMVectorMultiply(ny, tx));
+				XMVECTOR x = XMVectorMultiplyAdd(mz, nx, XMVectorMultiplyAdd(my, bx, XMVectorMultiply(mx, tx)));
+				XMVECTOR y = XMVectorMultiplyAdd(mz, ny, XMVectorMultiplyAdd(my, by, XMVectorMultiply(mx, ty)));
+				XMVECTOR z = XMVectorMultiplyAdd(mz, nz, XMVectorMultiplyAdd(my, bz, XMVectorMultiply(mx, tz)));
+				Normalize(x, y, z);
+				nx = x;
+				ny = y;
+				nz = z;
+			}
+
+			XMVECTOR px = Load(&f.posX[i]), py = Load(&f.posY[i]), pz = Load(&f.posZ[i]);
+
+			XMVECTOR sun = Dot(sunX, sunY, sunZ, nx, ny, nz);
+
+			XMVECTOR lx = XMVectorSubtract(XMVectorReplicate(p.pointPos.x), px);
+			XMVECTOR ly = XMVectorSubtract(XMVectorReplicate(p.pointPos.y), py);
+			XMVECTOR lz = XMVectorSubtract(XMVectorReplicate(p.pointPos.z), pz);
+			XMVECTOR point = XMVectorDivide(Dot(lx, ly, lz, nx, ny, nz), XMVectorSqrt(Dot(lx, ly, lz, lx, ly, lz)));
+
+			XMVECTOR sx = XMVectorSubtract(XMVectorReplicate(p.spotPos.x), px);
+			XMVECTOR sy = XMVectorSubtract(XMVectorReplicate(p.spotPos.y), py);
+			XMVECTOR sz = XMVectorSubtract(XMVectorReplicate(p.spotPos.z), pz);
+			Normalize(sx, sy, sz);
+			XMVECTOR surfaceRatio = XMVectorSaturate(Dot(sx, sy, sz, spotDirX, spotDirY, spotDirZ));
+			XMVECTOR lightRatio = XMVectorSaturate(Dot(sx, sy, sz, nx, ny, nz));
+			XMVECTOR atten = XMVectorSubtract(one, XMVectorSaturate(XMVectorDivide(XMVectorSubtract(innerConeRatio, surfaceRatio), coneWidth)));
+			// Lanes outside the cone get nothing, like the shader's spotfactor.
+			XMVECTOR spot = XMVectorSelect(zero, XMVectorMultiply(lightRatio, atten), XMVectorGreater(surfaceRatio, coneRatio));
+
+			for (int k = 0; k < 3; k++)
+			{
+				XMVECTOR color = XMVectorAdd(ambient, XMVectorSaturate(XMVectorScale(sun, sunColor[k])));
+				color = XMVectorAdd(color, XMVectorSaturate(XMVectorScale(point, pointColor[k])));
+				color = XMVectorAdd(color, XMVectorSaturate(XMVectorMultiply(XMVectorScale(spot, spotColor[k]), color)));
+				Store(&out[k][i], XMVectorMultiply(color, Load(&albedo[k][i])));
+			}
+		}
+	}
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Runs fn(i) for i in [0, count) spread over threads workers (0 is every hardware thread), grain indices at a time.
+// The calling thread is one of the workers. Plain std::thread so the CPU tools build without Gateware.
+template <typename Fn>
+void ParallelFor(unsigned int threads, unsigned int count, unsigned int grain, Fn fn)
+{
+	unsigned int workers = threads ? threads : std::thread::hardware_concurrency();
+	if (workers < 1)
+		workers = 1;
+	std::atomic<unsigned int> next(0);
+	auto work = [&]()
+	{
+		for (unsigned int start = next.fetch_add(grain); start < count; start = next.fetch_add(grain))
+		{
+			unsigned int end = (start + grain < count) ? start + grain : count;
+			for (unsigned int i = start; i < end; i++)
+				fn(i);
+		}
+	};
+	std::vector<std::thread> pool;
+	for (unsigned int t = 1; t < workers && t * grain < count; t++)
+		pool.emplace_back(work);
+	work();
+	for (std::thread& t : pool)
+		t.join();
+}
@@ -0,0 +1,153 @@
+#include "PipelineState.h"
+
+#include <cstdio>
+
+// Checks PipelineCache's hashing and dedup and PipelineStateTracker's bind accounting with made up object
+// pointers, no device involved. Needs nothing but the standard library.
+// PipelineCheck   no arguments.
+
+// Distinct stand-ins for shaders and states, only their addresses are ever used.
+static char fakeObjects[16];
+
+static const void* Fake(int i)
+{
+	return &fakeObjects[i];
+}
+
+static PipelineDesc BaseDesc()
+{
+	PipelineDesc d;
+	d.vertexShader = Fake(0);
+	d.pixelShader = Fake(1);
+	d.inputLayout = Fake(2);
+	d.topology = 4;		// Triangle list
+	return d;
+}
+
+static bool Expect(bool condition, const char* what)
+{
+	if (!condition)
+		printf("FAILED: %s\n", what);
+	return condition;
+}
+
+// Each field changed on its own gives a new pipeline and exactly its own bit.
+static bool CheckFields(PipelineCache& cache)
+{
+	struct Change
+	{
+		const char* name;
+		uint32_t bit;
+		void (*apply)(PipelineDesc&);
+	};
+	const Change changes[] =
+	{
+		{ "vertex shader", PIPE_VS, [](PipelineDesc& d) { d.vertexShader = Fake(3); } },
+		{ "geometry shader", PIPE_GS, [](PipelineDesc& d) { d.geometryShader = Fake(4); } },
+		{ "pixel shader", PIPE_PS, [](PipelineDesc& d) { d.pixelShader = Fake(5); } },
+		{ "input layout", PIPE_INPUT_LAYOUT, [](PipelineDesc& d) { d.inputLayout = nullptr; } },
+		{ "topology", PIPE_TOPOLOGY, [](PipelineDesc& d) { d.topology = 2; } },
+		{ "rasterizer", PIPE_RASTERIZER, [](PipelineDesc& d) { d.rasterizerState = Fake(6); } },
+		{ "blend", PIPE_BLEND, [](PipelineDesc& d) { d.blendState = Fake(7); } },
+		{ "depth stencil", PIPE_DEPTH_STENCIL, [](PipelineDesc& d) { d.depthStencilState = Fake(8); } },
+		{ "stencil ref", PIPE_DEPTH_STENCIL, [](PipelineDesc& d) { d.stencilRef = 1; } },
+	};
+
+	bool ok = true;
+	PipelineDesc base = BaseDesc();
+	PipelineId baseId = cache.Get(base);
+	std::vector<PipelineId> seen(1, baseId);
+	for (const Change& c : changes)
+	{
+		PipelineDesc d = base;
+		c.apply(d);
+		PipelineId id = cache.Get(d);
+		bool fresh = true;
+		for (PipelineId s : seen)
+			fresh &= s != id;
+		seen.push_back(id);
+		bool good = fresh && d.Hash() != base.Hash() && DiffPipelines(base, d) == c.bit && DiffPipelines(d, base) == c.bit;
+		printf("%-16s new id %u, diff bits 0x%02x: %s\n", c.name, id, DiffPipelines(base, d), good ? "ok" : "FAILED");
+		ok &= good;
+	}
+	ok &= Expect(DiffPipelines(base, base) == 0, "a desc differs from itself");
+	return ok;
+}
+
+int main()
+{
+	bool ok = true;
+	PipelineCache cache;
+
+	// Equal descs built separately share an id and a hash, and the cache doesn't grow.
+	PipelineDesc a = BaseDesc(), b = BaseDesc();
+	PipelineId idA = cache.Get(a), idB = cache.Get(b);
+	ok &= Expect(idA == idB && a.Hash() == b.Hash() && cache.Size() == 1, "equal descs get different ids");
+	ok &= Expect(cache.Desc(idA) == a, "stored desc changed");
+
+	ok &= CheckFields(cache);
+	size_t fieldPipelines = cache.Size();
+
+	// Lots of distinct pipelines: every one its own id, and asking again gives the same ids back.
+	std::vector<PipelineId> ids;
+	for (int vs = 0; vs < 8; vs++)
+	{
+		for (int ps = 0; ps < 8; ps++)
+		{
+			for (uint32_t topology = 0; topology < 8; topology++)
+			{
+				for (uint32_t ref = 0; ref < 4; ref++)
+				{
+					PipelineDesc d;
+					d.vertexShader = Fake(vs);
+					d.pixelShader = Fake(8 + ps);
+					d.topology = topology + 100;
+					d.stencilRef = ref;
+					ids.push_back(cache.Get(d));
+				}
+			}
+		}
+	}
+	size_t before = cache.Size();
+	ok &= Expect(before == fieldPipelines + ids.size(), "distinct descs were merged");
+	size_t at = 0;
+	for (int vs = 0; vs < 8; vs++)
+		for (int ps = 0; ps < 8; ps++)
+			for (uint32_t topology = 0; topology < 8; topology++)
+				for (uint32_t ref = 0; ref < 4; ref++)
+				{
+					PipelineDesc d;
+					d.vertexShader = Fake(vs);
+					d.pixelShader = Fake(8 + ps);
+					d.topology = topology + 100;
+					d.stencilRef = ref;
+					ok &= Expect(cache.Get(d) == ids[at++], "asking again gave a different id");
+				}
+	ok &= Expect(cache.Size() == before, "asking again grew the cache");
+	printf("dedup            %zu distinct pipelines, asked for twice: %s\n", ids.size(), ok ? "ok" : "FAILED");
+
+	// Tracker: first bind sets everything, repeats are redundant, switches only set what differs, and after
+	// Invalidate the same id sets everything again.
+	PipelineDesc other = BaseDesc();
+	other.pixelShader = Fake(5);
+	other.blendState = Fake(7);
+	PipelineId idOther = cache.Get(other);
+	PipelineStateTracker tracker;
+	bool tracked = true;
+	tracked &= Expect(tracker.Bind(cache, idA) == PIPE_ALL, "first bind didn't set everything");
+	tracked &= Expect(tracker.Bind(cache, idA) == 0, "repeat bind set something");
+	tracked &= Expect(tracker.Bind(cache, idA) == 0, "repeat bind set something");
+	tracked &= Expect(tracker.Bind(cache, idOther) == (PIPE_PS | PIPE_BLEND), "switch set the wrong fields");
+	tracked &= Expect(tracker.Bind(cache, idA) == (PIPE_PS | PIPE_BLEND), "switch back set the wrong fields");
+	tracker.Invalidate();
+	tracked &= Expect(tracker.Bind(cache, idA) == PIPE_ALL, "bind after Invalidate didn't set everything");
+	tracked &= Expect(tracker.Bind(cache, idA) == 0, "repeat after Invalidate set something");
+	// 7 binds, 3 of them repeats; 8 + 2 + 2 + 8 fields set.
+	tracked &= Expect(tracker.Binds() == 7 && tracker.RedundantBinds() == 3 && tracker.FieldChanges() == 20, "bind counts are off");
+	printf("tracker          %u binds, %u redundant, %u field changes: %s\n", tracker.Binds(), tracker.RedundantBinds(),
+		tracker.FieldChanges(), tracked ? "ok" : "FAILED");
+	tracker.ResetStats();
+	tracked &= Expect(tracker.Binds() == 0 && tracker.RedundantBinds() == 0 && tracker.FieldChanges() == 0, "ResetStats left counts");
+
+	return ok && tracked ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "ShaderCache.h"
+
+// Everything a draw binds apart from its buffers, textures and constants.
+// The objects are opaque here, they're only hashed and compared, so this runs without a device.
+struct PipelineDesc
+{
+	const void* vertexShader = nullptr;
+	const void* geometryShader = nullptr;
+	const void* pixelShader = nullptr;
+	const void* inputLayout = nullptr;
+	uint32_t topology = 0;
+	const void* rasterizerState = nullptr;
+	const void* blendState = nullptr;
+	const void* depthStencilState = nullptr;
+	uint32_t stencilRef = 0;
+
+	// Field by field so padding never ends up in the hash.
+	uint64_t Hash() const
+	{
+		uint64_t hash = HashBytes(&vertexShader, sizeof(vertexShader));
+		hash = HashBytes(&geometryShader, sizeof(geometryShader), hash);
+		hash = HashBytes(&pixelShader, sizeof(pixelShader), hash);
+		hash = HashBytes(&inputLayout, sizeof(inputLayout), hash);
+		hash = HashBytes(&topology, sizeof(topology), hash);
+		hash = HashBytes(&rasterizerState, sizeof(rasterizerState), hash);
+		hash = HashBytes(&blendState, sizeof(blendState), hash);
+		hash = HashBytes(&depthStencilState, sizeof(depthStencilState), hash);
+		return HashBytes(&stencilRef, sizeof(stencilRef), hash);
+	}
+
+	bool operator==(const PipelineDesc& o) const
+	{
+		return vertexShader == o.vertexShader && geometryShader == o.geometryShader && pixelShader == o.pixelShader &&
+			inputLayout == o.inputLayout && topology == o.topology && rasterizerState == o.rasterizerState &&
+			blendState == o.blendState && depthStencilState == o.depthStencilState && stencilRef == o.stencilRef;
+	}
+};
+
+// Which parts of a pipeline differ, one bit per thing the context sets separately.
+enum PipelineField : uint32_t
+{
+	PIPE_VS				= 1 << 0,
+	PIPE_GS				= 1 << 1,
+	PIPE_PS				= 1 << 2,
+	PIPE_INPUT_LAYOUT	= 1 << 3,
+	PIPE_TOPOLOGY		= 1 << 4,
+	PIPE_RASTERIZER		= 1 << 5,
+	PIPE_BLEND			= 1 << 6,
+	PIPE_DEPTH_STENCIL	= 1 << 7,	// State and stencil ref go together
+	PIPE_ALL			= (1 << 8) - 1
+};
+
+inline uint32_t DiffPipelines(const PipelineDesc& a, const PipelineDesc& b)
+{
+	uint32_t changed = 0;
+	if (a.vertexShader != b.vertexShader) changed |= PIPE_VS;
+	if (a.geometryShader != b.geometryShader) changed |= PIPE_GS;
+	if (a.pixelShader != b.pixelShader) changed |= PIPE_PS;
+	if (a.inputLayout != b.inputLayout) changed |= PIPE_INPUT_LAYOUT;
+	if (a.topology != b.topology) changed |= PIPE_TOPOLOGY;
+	if (a.rasterizerState != b.rasterizerState) changed |= PIPE_RASTERIZER;
+	if (a.blendState != b.blendState) changed |= PIPE_BLEND;
+	if (a.depthStencilState != b.depthStencilState || a.stencilRef != b.stencilRef) changed |= PIPE_DEPTH_STENCIL;
+	return changed;
+}
+
+typedef uint32_t PipelineId;
+static const PipelineId PIPELINE_INVALID = 0xFFFFFFFF;
+
+// Deduplicated store of pipelines, equal descs always get the same id and a stored desc never changes.
+// It doesn't hold references, whoever owns the objects clears it before releasing them (see the shader hot reload).
+class PipelineCache
+{
+	std::vector<PipelineDesc> pipelines;
+	std::unordered_multimap<uint64_t, PipelineId> lookup;
+
+public:
+	PipelineId Get(const PipelineDesc& desc)
+	{
+		uint64_t hash = desc.Hash();
+		auto range = lookup.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (pipelines[it->second] == desc)
+				return it->second;
+		}
+		PipelineId id = (PipelineId)pipelines.size();
+		pipelines.push_back(desc);
+		lookup.insert(std::make_pair(hash, id));
+		return id;
+	}
+
+	const PipelineDesc& Desc(PipelineId id) const { return pipelines[id]; }
+	size_t Size() const { return pipelines.size(); }
+
+	void Clear()
+	{
+		pipelines.clear();
+		lookup.clear();
+	}
+};
+
+// Remembers the bound pipeline so switching only touches the fields that differ.
+class PipelineStateTracker
+{
+	PipelineId boundId = PIPELINE_INVALID;
+	PipelineDesc bound;
+	unsigned int binds = 0, redundant = 0, fieldChanges = 0;
+
+public:
+	// Returns the PipelineField bits that have to be set to go to id, and records id as bound.
+	uint32_t Bind(const PipelineCache& cache, PipelineId id)
+	{
+		binds++;
+		if (id == boundId)
+		{
+			redundant++;
+			return 0;
+		}
+		const PipelineDesc& desc = cache.Desc(id);
+		uint32_t changed = (boundId == PIPELINE_INVALID) ? (uint32_t)PIPE_ALL : DiffPipelines(bound, desc);
+		boundId = id;
+		bound = desc;
+		for (uint32_t bits = changed; bits; bits &= bits - 1)
+			fieldChanges++;
+		return changed;
+	}
+
+	// Someone else touched the context (or the cache was cleared), next bind sets everything.
+	void Invalidate() { boundId = PIPELINE_INVALID; }
+
+	unsigned int Binds() const { return binds; }
+	unsigned int RedundantBinds() const { return redundant; }
+	unsigned int FieldChanges() const { return fieldChanges; }
+	void ResetStats() { binds = redundant = fieldChanges = 0; }
+};
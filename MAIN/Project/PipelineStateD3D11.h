@@ -0,0 +1,37 @@
+#pragma once
+#include "defines.h"
+#include "PipelineState.h"
+
+// Builds a desc out of D3D11 objects, the pointers are what PipelineCache hashes.
+inline PipelineDesc MakePipeline(ID3D11VertexShader* vs, ID3D11PixelShader* ps, ID3D11InputLayout* layout,
+	D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, ID3D11DepthStencilState* depthStencil = nullptr)
+{
+	PipelineDesc desc;
+	desc.vertexShader = vs;
+	desc.pixelShader = ps;
+	desc.inputLayout = layout;
+	desc.topology = (uint32_t)topology;
+	desc.depthStencilState = depthStencil;
+	return desc;
+}
+
+// Sets only the changed parts of desc on the context.
+inline void ApplyPipeline(ID3D11DeviceContext* con, const PipelineDesc& desc, uint32_t changed)
+{
+	if (changed & PIPE_VS)
+		con->VSSetShader((ID3D11VertexShader*)desc.vertexShader, nullptr, 0);
+	if (changed & PIPE_GS)
+		con->GSSetShader((ID3D11GeometryShader*)desc.geometryShader, nullptr, 0);
+	if (changed & PIPE_PS)
+		con->PSSetShader((ID3D11PixelShader*)desc.pixelShader, nullptr, 0);
+	if (changed & PIPE_INPUT_LAYOUT)
+		con->IASetInputLayout((ID3D11InputLayout*)desc.inputLayout);
+	if (changed & PIPE_TOPOLOGY)
+		con->IASetPrimitiveTopology((D3D11_PRIMITIVE_TOPOLOGY)desc.topology);
+	if (changed & PIPE_RASTERIZER)
+		con->RSSetState((ID3D11RasterizerState*)desc.rasterizerState);
+	if (changed & PIPE_BLEND)
+		con->OMSetBlendState((ID3D11BlendState*)desc.blendState, nullptr, 0xFFFFFFFF);
+	if (changed & PIPE_DEPTH_STENCIL)
+		con->OMSetDepthStencilState((ID3D11DepthStencilState*)desc.depthStencilState, desc.stencilRef);
+}
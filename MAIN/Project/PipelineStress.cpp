@@ -0,0 +1,205 @@
+#include "ClusteredLighting.h"
+#include "LightManager.h"
+#include "TripleBuffer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+
+// Hammers TripleBuffer from two threads and checks every snapshot the reader gets is whole and newer than the
+// last, then times the frame pipeline Mesh uses against doing the same work on one thread. Needs nothing but
+// DirectXMath.
+// PipelineStress [snapshots] [lights]   defaults to 2000000 snapshots and 2048 lights.
+
+// Every value in data is number, and how many there are comes from number too, so a torn read shows up.
+struct StressSnapshot
+{
+	uint64_t number = 0;
+	std::vector<uint64_t> data;
+};
+
+static size_t StressSize(uint64_t number)
+{
+	return 1 + (number * 2654435761u) % 257;
+}
+
+static bool StressHandoff(uint64_t count)
+{
+	TripleBuffer<StressSnapshot> buffer;
+	std::atomic<bool> done{ false };
+
+	auto start = std::chrono::high_resolution_clock::now();
+	std::thread writer([&]
+		{
+			std::mt19937 rng(1);
+			for (uint64_t n = 1; n <= count; n++)
+			{
+				StressSnapshot& s = buffer.Back();
+				s.number = n;
+				s.data.assign(StressSize(n), n);
+				buffer.Publish();
+				if ((rng() & 1023) == 0)
+					std::this_thread::yield();
+			}
+			done = true;
+		});
+
+	uint64_t last = 0, taken = 0, torn = 0, stale = 0;
+	std::mt19937 rng(2);
+	for (;;)
+	{
+		bool finished = done.load();
+		if (buffer.Acquire())
+		{
+			const StressSnapshot& s = buffer.Front();
+			taken++;
+			if (s.number <= last)
+				stale++;
+			bool whole = s.data.size() == StressSize(s.number);
+			for (size_t i = 0; whole && i < s.data.size(); i++)
+				whole = s.data[i] == s.number;
+			torn += whole ? 0 : 1;
+			last = s.number;
+		}
+		else if (finished)
+			break;
+		if ((rng() & 1023) == 0)
+			std::this_thread::yield();
+	}
+	writer.join();
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	// Once the writer's done the newest snapshot has to be the last one it wrote.
+	bool ok = torn == 0 && stale == 0 && last == count;
+	printf("handoff      %llu published, %llu taken, %llu skipped in %.1f ms: %llu torn, %llu out of order, newest %llu, %s\n",
+		(unsigned long long)count, (unsigned long long)taken, (unsigned long long)(count - taken), ms,
+		(unsigned long long)torn, (unsigned long long)stale, (unsigned long long)last, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+// The update half of a frame: animate the lights and snapshot them, like Mesh::Simulate.
+struct FrameWork
+{
+	uint64_t number = 0;
+	std::vector<ClusterLight> lights;
+};
+
+static void AddLights(LightManager& manager, unsigned int count)
+{
+	std::mt19937 rng(count);
+	std::uniform_real_distribution<float> pos(-20.0f, 20.0f), height(0.0f, 4.0f), range(0.5f, 3.0f), unit(0.0f, 1.0f);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		LightDesc desc;
+		desc.type = (i % 4 == 0) ? LIGHT_SPOT : LIGHT_POINT;
+		desc.position = XMFLOAT3(pos(rng), height(rng), pos(rng));
+		desc.direction = XMFLOAT3(0.0f, -1.0f, 0.0f);
+		desc.color = XMFLOAT3(unit(rng), unit(rng), unit(rng));
+		desc.range = range(rng);
+		desc.spotCos = 0.8f;
+		desc.positionSpin = 0.5f / (1.0f + (i % 7));
+		manager.Add(desc);
+	}
+}
+
+static void Update(LightManager& manager, FrameWork& out, uint64_t number)
+{
+	// A few substeps stand in for the input, camera and animation work, so the halves are of a similar size.
+	for (int i = 0; i < 4; i++)
+		manager.Animate(0.004f);
+	manager.Pack();
+	manager.ClearDirty();
+	out.number = number;
+	out.lights = manager.Packed();
+}
+
+// The render half: bin the lights for the main view and the minimap, summing the bins so runs can be compared.
+static uint64_t Draw(ClusteredLightBinner& binner, const FrameWork& frame)
+{
+	static const XMMATRIX views[2] = { XMMatrixTranslation(0.0f, -2.0f, 15.0f), XMMatrixTranslation(0.0f, 0.0f, 20.0f) };
+	binner.Configure(XMMatrixPerspectiveFovLH(XM_PIDIV2, 800.0f / 600.0f, 0.01f, 100.0f), 0.01f, 100.0f);
+	uint64_t sum = frame.number;
+	for (const XMMATRIX& view : views)
+	{
+		binner.Bin(frame.lights, view);
+		for (uint32_t index : binner.Indices())
+			sum = sum * 31 + index;
+	}
+	return sum;
+}
+
+static bool BenchPipeline(unsigned int lightCount, unsigned int frameCount)
+{
+	// One thread: update then draw, over and over.
+	std::vector<uint64_t> serialSums(frameCount);
+	LightManager manager;
+	AddLights(manager, lightCount);
+	ClusteredLightBinner binner;
+	FrameWork work;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (unsigned int f = 0; f < frameCount; f++)
+	{
+		Update(manager, work, f + 1);
+		serialSums[f] = Draw(binner, work);
+	}
+	double serialMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	// Two: the update thread keeps one frame ahead and sleeps until the render thread takes it, as Mesh does.
+	std::vector<uint64_t> pipelinedSums(frameCount);
+	LightManager pipelinedManager;
+	AddLights(pipelinedManager, lightCount);
+	TripleBuffer<FrameWork> frames;
+	std::mutex pacing;
+	std::condition_variable paced;
+	uint64_t taken = 0;
+	start = std::chrono::high_resolution_clock::now();
+	std::thread updater([&]
+		{
+			for (uint64_t n = 1; n <= frameCount; n++)
+			{
+				Update(pipelinedManager, frames.Back(), n);
+				frames.Publish();
+				std::unique_lock<std::mutex> lock(pacing);
+				paced.wait(lock, [&] { return taken >= n; });
+			}
+		});
+	unsigned int drawn = 0, skipped = 0;
+	while (drawn < frameCount)
+	{
+		if (!frames.Acquire())
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		const FrameWork& frame = frames.Front();
+		{
+			std::lock_guard<std::mutex> lock(pacing);
+			taken = frame.number;
+		}
+		paced.notify_one();
+		skipped += (frame.number != drawn + 1) ? 1 : 0;
+		pipelinedSums[drawn++] = Draw(binner, frame);
+	}
+	updater.join();
+	double pipelinedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	bool match = skipped == 0 && serialSums == pipelinedSums;
+	printf("pipeline     %5u lights, %u frames: serial %.3f ms/frame, pipelined %.3f ms/frame (%.2fx), %s\n",
+		lightCount, frameCount, serialMs / frameCount, pipelinedMs / frameCount, serialMs / pipelinedMs,
+		match ? "same frames" : "MISMATCH");
+	return match;
+}
+
+int main(int argc, char** argv)
+{
+	uint64_t snapshots = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 2000000;
+	unsigned int lights = (argc > 2) ? (unsigned int)atoi(argv[2]) : 2048;
+
+	bool ok = StressHandoff(snapshots);
+	ok &= BenchPipeline(lights, 300);
+	return ok ? 0 : 1;
+}
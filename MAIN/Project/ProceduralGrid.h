@@ -0,0 +1,105 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+using namespace DirectX;
+
+// A square grid of lines on y = 0, resolution points along each side spaced evenly from -extent. With the
+// defaults it's the old 100x100 grid, -5 to 4.9 in steps of 0.1.
+struct GridDesc
+{
+	unsigned int resolution = 100;
+	float extent = 5.0f;
+
+	float Spacing() const { return 2.0f * extent / resolution; }
+	// Line list vertices: a segment along z from every point but the last row, then along x from every point but the last column.
+	unsigned int Segments() const { return resolution < 2 ? 0 : 2 * resolution * (resolution - 1); }
+	unsigned int VertexCount() const { return 2 * Segments(); }
+};
+
+// What GridVS needs, matches GridBuffer in shaders.fx.
+struct GridConstants
+{
+	uint32_t resolution;
+	float spacing;
+	uint32_t pad[2];
+};
+
+inline GridConstants MakeGridConstants(const GridDesc& desc)
+{
+	GridConstants gc = { desc.resolution, desc.Spacing(), { 0, 0 } };
+	return gc;
+}
+
+// The position GridVS makes for vertex id of the line list, before the world matrix and the wave. Line for line
+// the same as the shader, so the two can be checked against each other.
+inline XMFLOAT3 GridVertex(const GridConstants& gc, uint32_t id)
+{
+	uint32_t segment = id >> 1, end = id & 1;
+	uint32_t alongZ = gc.resolution * (gc.resolution - 1);
+	uint32_t x, z;
+	if (segment < alongZ)
+	{
+		x = segment % gc.resolution;
+		z = segment / gc.resolution + end;
+	}
+	else
+	{
+		segment -= alongZ;
+		x = segment % (gc.resolution - 1) + end;
+		z = segment / (gc.resolution - 1);
+	}
+	float middle = (float)(gc.resolution / 2);
+	return XMFLOAT3(((float)x - middle) * gc.spacing, 0.0f, ((float)z - middle) * gc.spacing);
+}
+
+// The grid the way it used to be built for a vertex and index buffer, kept as the reference GridVertex is checked against.
+inline void BuildGridReference(const GridDesc& desc, std::vector<XMFLOAT3>& verts, std::vector<uint32_t>& indices)
+{
+	unsigned int n = desc.resolution;
+	float middle = (float)(n / 2);
+	verts.clear();
+	indices.clear();
+	for (unsigned int z = 0; z < n; z++)
+	{
+		for (unsigned int x = 0; x < n; x++)
+			verts.push_back(XMFLOAT3(((float)x - middle) * desc.Spacing(), 0.0f, ((float)z - middle) * desc.Spacing()));
+	}
+	if (n < 2)
+		return;
+
+	// Vertical lines
+	for (unsigned int i = 0; i < n * n - n; i++)
+	{
+		indices.push_back(i);
+		indices.push_back(i + n);
+	}
+	// Horizontal lines
+	for (unsigned int row = 0; row < n * n; row += n)
+	{
+		for (unsigned int i = 0; i < n - 1; i++)
+		{
+			indices.push_back(row + i);
+			indices.push_back(row + i + 1);
+		}
+	}
+}
+
+// True when every vertex GridVertex makes is exactly the reference's, in the same order.
+inline bool CheckGrid(const GridDesc& desc)
+{
+	std::vector<XMFLOAT3> verts;
+	std::vector<uint32_t> indices;
+	BuildGridReference(desc, verts, indices);
+	if (indices.size() != desc.VertexCount())
+		return false;
+	GridConstants gc = MakeGridConstants(desc);
+	for (uint32_t id = 0; id < indices.size(); id++)
+	{
+		XMFLOAT3 a = GridVertex(gc, id), b = verts[indices[id]];
+		if (a.x != b.x || a.y != b.y || a.z != b.z)
+			return false;
+	}
+	return true;
+}
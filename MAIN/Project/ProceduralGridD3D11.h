@@ -0,0 +1,36 @@
+#pragma once
+#include "defines.h"
+#include "ProceduralGrid.h"
+#include <wrl/client.h>
+
+// The constant buffer GridVS reads the grid's size from. There's no vertex or index buffer, the grid is drawn
+// with Draw(desc.VertexCount()) and no input layout.
+class D3D11GridResources
+{
+	Microsoft::WRL::ComPtr<ID3D11Buffer>		constants = nullptr;
+	GridDesc									uploaded;
+	bool										valid = false;
+
+public:
+	bool Create(ID3D11Device* dev)
+	{
+		D3D11_BUFFER_DESC bd = {};
+		bd.Usage = D3D11_USAGE_DEFAULT;
+		bd.ByteWidth = sizeof(GridConstants);
+		bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		return SUCCEEDED(dev->CreateBuffer(&bd, nullptr, constants.GetAddressOf()));
+	}
+
+	// Only uploads when the grid changed size.
+	void Bind(ID3D11DeviceContext* con, const GridDesc& desc)
+	{
+		if (!valid || desc.resolution != uploaded.resolution || desc.extent != uploaded.extent)
+		{
+			GridConstants gc = MakeGridConstants(desc);
+			con->UpdateSubresource(constants.Get(), 0, nullptr, &gc, 0, 0);
+			uploaded = desc;
+			valid = true;
+		}
+		con->VSSetConstantBuffers(5, 1, constants.GetAddressOf());
+	}
+};
@@ -0,0 +1,436 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+// Handle to a texture known by the graph.
+typedef unsigned int RGResource;
+static const RGResource RG_INVALID = 0xFFFFFFFF;
+
+// Description of a texture the graph is allowed to create. Format & bind flags are backend specific
+// (DXGI_FORMAT & D3D11_BIND_FLAG on D3D11), the graph only compares them.
+struct RGTextureDesc
+{
+	unsigned int width = 0;
+	unsigned int height = 0;
+	unsigned int format = 0;
+	unsigned int bindFlags = 0;
+
+	bool operator==(const RGTextureDesc& o) const
+	{
+		return width == o.width && height == o.height && format == o.format && bindFlags == o.bindFlags;
+	}
+};
+
+// Creates the physical textures the graph hands out. Handles are opaque to the graph.
+class RenderGraphBackend
+{
+public:
+	virtual ~RenderGraphBackend() {}
+	virtual void* CreateTexture(const RGTextureDesc& desc) = 0;
+	virtual void DestroyTexture(void* texture) = 0;
+};
+
+// Backend that never touches a GPU, hands out fake handles and counts them.
+class NullRenderGraphBackend : public RenderGraphBackend
+{
+	unsigned int next = 0;
+public:
+	unsigned int created = 0, destroyed = 0;
+
+	void* CreateTexture(const RGTextureDesc&) override
+	{
+		created++;
+		return reinterpret_cast<void*>(static_cast<size_t>(++next));
+	}
+
+	void DestroyTexture(void*) override
+	{
+		destroyed++;
+	}
+};
+
+// Small frame graph. Passes declare what they read & write, Compile() orders them, drops the ones
+// whose results are never used and packs transient textures with matching descriptions into the same
+// physical texture when their lifetimes don't overlap. The graph is rebuilt every frame, the physical
+// textures live in a pool that survives Reset().
+class RenderGraph
+{
+public:
+	class PassBuilder
+	{
+		friend class RenderGraph;
+		RenderGraph& graph;
+		unsigned int pass;
+		PassBuilder(RenderGraph& _graph, unsigned int _pass) : graph(_graph), pass(_pass) {}
+	public:
+		void Read(RGResource r) { graph.passes[pass].reads.push_back(r); }
+		void Write(RGResource r) { graph.passes[pass].writes.push_back(r); }
+	};
+
+	typedef std::function<void(RenderGraph&)> ExecuteFn;
+
+private:
+	struct Resource
+	{
+		std::string name;
+		RGTextureDesc desc;
+		void* imported = nullptr;		// Non-null for resources owned outside the graph
+		bool output = false;			// Keeps every pass that writes it alive
+		unsigned int physical = RG_INVALID;
+		unsigned int firstUse = RG_INVALID, lastUse = 0;
+	};
+
+	struct Pass
+	{
+		std::string name;
+		std::vector<RGResource> reads, writes;
+		ExecuteFn execute;
+		bool culled = false;
+	};
+
+	struct Physical
+	{
+		RGTextureDesc desc;
+		void* handle = nullptr;
+		unsigned int busyUntil = 0;	// Position in the order of the last pass using it, compile only
+		bool used = false;
+	};
+
+	std::vector<Resource> resources;
+	std::vector<Pass> passes;
+	std::vector<unsigned int> order;
+	std::vector<Physical> pool;
+	bool compiled = false;
+
+	static bool Contains(const std::vector<RGResource>& list, RGResource r)
+	{
+		for (RGResource x : list)
+			if (x == r)
+				return true;
+		return false;
+	}
+
+	// Does the reader see what writer put in r? Readers see the writers declared before them,
+	// or every writer if none are (a pass can be declared ahead of the one that fills its input).
+	bool Produces(unsigned int writer, unsigned int reader, RGResource r) const
+	{
+		if (writer == reader || passes[writer].culled || !Contains(passes[writer].writes, r))
+			return false;
+		if (writer < reader)
+			return true;
+		for (unsigned int i = 0; i < reader; i++)
+		{
+			if (!passes[i].culled && Contains(passes[i].writes, r))
+				return false;
+		}
+		return true;
+	}
+
+	// Pass b has to run after pass a.
+	bool DependsOn(unsigned int b, unsigned int a) const
+	{
+		const Pass& pa = passes[a];
+		const Pass& pb = passes[b];
+		// Read after write
+		for (RGResource r : pb.reads)
+		{
+			if (Produces(a, b, r))
+				return true;
+		}
+		// Write after write keeps declaration order
+		for (RGResource w : pa.writes)
+		{
+			if (a < b && Contains(pb.writes, w))
+				return true;
+		}
+		// Write after read, a later version can't clobber what an earlier reader still needs
+		for (RGResource r : pa.reads)
+		{
+			if (Contains(pb.writes, r) && !Produces(b, a, r))
+				return true;
+		}
+		return false;
+	}
+
+	// Walk backwards from the outputs, anything not reached is dropped.
+	void CullPasses()
+	{
+		std::vector<bool> needed(resources.size(), false);
+		for (size_t r = 0; r < resources.size(); r++)
+			needed[r] = resources[r].output;
+
+		for (Pass& p : passes)
+			p.culled = true;
+
+		bool changed = true;
+		while (changed)
+		{
+			changed = false;
+			for (Pass& p : passes)
+			{
+				if (!p.culled)
+					continue;
+				for (RGResource w : p.writes)
+				{
+					if (needed[w])
+					{
+						p.culled = false;
+						break;
+					}
+				}
+				if (!p.culled)
+				{
+					changed = true;
+					for (RGResource r : p.reads)
+						needed[r] = true;
+				}
+			}
+		}
+	}
+
+	// Kahn's algorithm, ties go to the pass that was declared first.
+	bool SortPasses()
+	{
+		order.clear();
+		const unsigned int count = static_cast<unsigned int>(passes.size());
+		std::vector<unsigned int> incoming(count, 0);
+		std::vector<std::vector<unsigned int>> edges(count);
+		for (unsigned int a = 0; a < count; a++)
+		{
+			for (unsigned int b = 0; b < count; b++)
+			{
+				if (a == b || passes[a].culled || passes[b].culled)
+					continue;
+				if (DependsOn(b, a))
+				{
+					edges[a].push_back(b);
+					incoming[b]++;
+				}
+			}
+		}
+
+		std::vector<bool> done(count, false);
+		unsigned int live = 0;
+		for (const Pass& p : passes)
+			if (!p.culled)
+				live++;
+
+		while (order.size() < live)
+		{
+			unsigned int pick = RG_INVALID;
+			for (unsigned int i = 0; i < count; i++)
+			{
+				if (!passes[i].culled && !done[i] && incoming[i] == 0)
+				{
+					pick = i;
+					break;
+				}
+			}
+			// Cycle in the declared reads & writes.
+			if (pick == RG_INVALID)
+				return false;
+
+			done[pick] = true;
+			order.push_back(pick);
+			for (unsigned int b : edges[pick])
+				incoming[b]--;
+		}
+		return true;
+	}
+
+	// Hand every transient resource a physical texture, sharing with a resource whose lifetime already ended.
+	void AliasResources()
+	{
+		for (Resource& r : resources)
+		{
+			r.firstUse = RG_INVALID;
+			r.lastUse = 0;
+			r.physical = RG_INVALID;
+		}
+		for (unsigned int i = 0; i < order.size(); i++)
+		{
+			const Pass& p = passes[order[i]];
+			for (int rw = 0; rw < 2; rw++)
+			{
+				for (RGResource r : (rw == 0) ? p.reads : p.writes)
+				{
+					if (resources[r].firstUse == RG_INVALID)
+						resources[r].firstUse = i;
+					resources[r].lastUse = i;
+				}
+			}
+		}
+
+		for (Physical& ph : pool)
+			ph.used = false;
+
+		// Process in order of first use so a finished texture can be handed to the next one in line.
+		std::vector<RGResource> transient;
+		for (RGResource r = 0; r < resources.size(); r++)
+		{
+			if (resources[r].imported == nullptr && resources[r].firstUse != RG_INVALID)
+				transient.push_back(r);
+		}
+		for (size_t i = 1; i < transient.size(); i++)
+		{
+			for (size_t j = i; j > 0 && resources[transient[j]].firstUse < resources[transient[j - 1]].firstUse; j--)
+			{
+				RGResource tmp = transient[j];
+				transient[j] = transient[j - 1];
+				transient[j - 1] = tmp;
+			}
+		}
+
+		for (RGResource r : transient)
+		{
+			Resource& res = resources[r];
+			unsigned int slot = RG_INVALID;
+			for (unsigned int p = 0; p < pool.size(); p++)
+			{
+				if (pool[p].desc == res.desc && (!pool[p].used || pool[p].busyUntil < res.firstUse))
+				{
+					slot = p;
+					break;
+				}
+			}
+			if (slot == RG_INVALID)
+			{
+				Physical ph;
+				ph.desc = res.desc;
+				pool.push_back(ph);
+				slot = static_cast<unsigned int>(pool.size() - 1);
+			}
+			pool[slot].used = true;
+			pool[slot].busyUntil = res.lastUse;
+			res.physical = slot;
+		}
+	}
+
+public:
+	// Forget this frame's passes & resources, the physical pool is kept for the next frame.
+	void Reset()
+	{
+		resources.clear();
+		passes.clear();
+		order.clear();
+		compiled = false;
+	}
+
+	// Texture created & owned by the graph, only lives for the frame.
+	RGResource CreateTexture(const char* name, const RGTextureDesc& desc)
+	{
+		Resource r;
+		r.name = name;
+		r.desc = desc;
+		resources.push_back(r);
+		return static_cast<RGResource>(resources.size() - 1);
+	}
+
+	// Texture owned by someone else. The back buffer is an output; a persistent target that's only sampled inside
+	// the graph isn't, so its writers are dropped on frames nothing reads it.
+	RGResource ImportTexture(const char* name, void* handle, bool output = true)
+	{
+		Resource r;
+		r.name = name;
+		r.imported = handle;
+		r.output = output;
+		resources.push_back(r);
+		return static_cast<RGResource>(resources.size() - 1);
+	}
+
+	// Keep whatever writes this resource even if no pass in the graph reads it.
+	void MarkOutput(RGResource r)
+	{
+		resources[r].output = true;
+	}
+
+	unsigned int AddPass(const char* name, const std::function<void(PassBuilder&)>& setup, const ExecuteFn& execute)
+	{
+		Pass p;
+		p.name = name;
+		p.execute = execute;
+		passes.push_back(p);
+		unsigned int index = static_cast<unsigned int>(passes.size() - 1);
+		PassBuilder builder(*this, index);
+		setup(builder);
+		return index;
+	}
+
+	// Cull, order and alias. Returns false if the passes' dependencies form a cycle.
+	bool Compile()
+	{
+		CullPasses();
+		compiled = SortPasses();
+		if (compiled)
+			AliasResources();
+		return compiled;
+	}
+
+	// Create any missing physical textures and run the passes in order.
+	void Execute(RenderGraphBackend& backend)
+	{
+		if (!compiled)
+			return;
+
+		for (Physical& ph : pool)
+		{
+			if (ph.used && ph.handle == nullptr)
+				ph.handle = backend.CreateTexture(ph.desc);
+		}
+
+		for (unsigned int p : order)
+		{
+			if (passes[p].execute)
+				passes[p].execute(*this);
+		}
+	}
+
+	// Destroy pooled textures that went unused this frame (e.g. after a resize).
+	void TrimPool(RenderGraphBackend& backend)
+	{
+		for (size_t i = 0; i < pool.size();)
+		{
+			if (!pool[i].used)
+			{
+				if (pool[i].handle != nullptr)
+					backend.DestroyTexture(pool[i].handle);
+				pool.erase(pool.begin() + i);
+				// Compiled physical indices are stale past this point.
+				compiled = false;
+			}
+			else
+				i++;
+		}
+	}
+
+	// Destroy every pooled texture.
+	void ReleasePool(RenderGraphBackend& backend)
+	{
+		for (Physical& ph : pool)
+		{
+			if (ph.handle != nullptr)
+				backend.DestroyTexture(ph.handle);
+		}
+		pool.clear();
+		compiled = false;
+	}
+
+	// Backend handle for a resource, only valid while executing.
+	void* GetTexture(RGResource r) const
+	{
+		const Resource& res = resources[r];
+		if (res.imported != nullptr)
+			return res.imported;
+		if (res.physical == RG_INVALID)
+			return nullptr;
+		return pool[res.physical].handle;
+	}
+
+	// Compiled results, mostly for debugging & tools.
+	const std::vector<unsigned int>& Order() const { return order; }
+	bool IsCulled(unsigned int pass) const { return passes[pass].culled; }
+	const char* PassName(unsigned int pass) const { return passes[pass].name.c_str(); }
+	unsigned int PhysicalOf(RGResource r) const { return resources[r].physical; }
+	unsigned int PoolSize() const { return static_cast<unsigned int>(pool.size()); }
+};
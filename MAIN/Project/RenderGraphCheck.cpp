@@ -0,0 +1,193 @@
+#include "RenderGraph.h"
+
+#include <cstdio>
+
+// Checks RenderGraph's compiler on the null backend: culling, the three kinds of ordering edge, transient texture
+// aliasing and cycle detection. Needs nothing at all.
+// RenderGraphCheck   no arguments.
+
+static void* const backBuffer = reinterpret_cast<void*>(static_cast<size_t>(0x1000));
+static void* const persistent = reinterpret_cast<void*>(static_cast<size_t>(0x2000));
+
+static RGTextureDesc Desc(unsigned int format)
+{
+	RGTextureDesc d;
+	d.width = d.height = 256;
+	d.format = format;
+	d.bindFlags = 1;
+	return d;
+}
+
+// Pass that reads the first list and writes the second.
+static unsigned int Pass(RenderGraph& graph, const char* name, std::vector<RGResource> reads, std::vector<RGResource> writes)
+{
+	return graph.AddPass(name,
+		[&](RenderGraph::PassBuilder& builder)
+		{
+			for (RGResource r : reads)
+				builder.Read(r);
+			for (RGResource w : writes)
+				builder.Write(w);
+		},
+		RenderGraph::ExecuteFn());
+}
+
+// Where the pass landed in the compiled order, RG_INVALID if it isn't there.
+static unsigned int Position(const RenderGraph& graph, unsigned int pass)
+{
+	for (unsigned int i = 0; i < graph.Order().size(); i++)
+	{
+		if (graph.Order()[i] == pass)
+			return i;
+	}
+	return RG_INVALID;
+}
+
+static bool Report(const char* what, bool ok)
+{
+	printf("%-52s %s\n", what, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+static bool CheckCulling()
+{
+	RenderGraph graph;
+	RGResource bb = graph.ImportTexture("BackBuffer", backBuffer);
+	RGResource unread = graph.CreateTexture("Unread", Desc(1));
+	RGResource chained = graph.CreateTexture("Chained", Desc(1));
+	RGResource sampled = graph.ImportTexture("Persistent", persistent, false);
+	RGResource marked = graph.CreateTexture("Marked", Desc(1));
+	unsigned int lonely = Pass(graph, "Lonely", {}, { unread });
+	unsigned int producer = Pass(graph, "Producer", {}, { chained });
+	unsigned int persistentWriter = Pass(graph, "PersistentWriter", {}, { sampled });
+	unsigned int keptByMark = Pass(graph, "KeptByMark", {}, { marked });
+	unsigned int consumer = Pass(graph, "Consumer", { chained }, { bb });
+	graph.MarkOutput(marked);
+	bool ok = graph.Compile();
+	ok &= graph.IsCulled(lonely) && graph.IsCulled(persistentWriter);
+	ok &= !graph.IsCulled(producer) && !graph.IsCulled(consumer) && !graph.IsCulled(keptByMark);
+	ok &= graph.Order().size() == 3 && graph.PhysicalOf(unread) == RG_INVALID;
+	bool culled = Report("unread passes culled, read and marked ones kept", ok);
+
+	// The same persistent import, now sampled by a view, keeps its writer.
+	graph.Reset();
+	bb = graph.ImportTexture("BackBuffer", backBuffer);
+	sampled = graph.ImportTexture("Persistent", persistent, false);
+	persistentWriter = Pass(graph, "PersistentWriter", {}, { sampled });
+	consumer = Pass(graph, "View", { sampled }, { bb });
+	ok = graph.Compile() && !graph.IsCulled(persistentWriter) && Position(graph, persistentWriter) < Position(graph, consumer);
+	return Report("non-output import kept alive by a reader", ok) && culled;
+}
+
+static bool CheckOrdering()
+{
+	bool ok = true;
+
+	// Read after write, with the reader declared before its writer.
+	{
+		RenderGraph graph;
+		RGResource bb = graph.ImportTexture("BackBuffer", backBuffer);
+		RGResource t = graph.CreateTexture("T", Desc(1));
+		unsigned int reader = Pass(graph, "Reader", { t }, { bb });
+		unsigned int writer = Pass(graph, "Writer", {}, { t });
+		ok &= Report("read after write, reader declared first",
+			graph.Compile() && Position(graph, writer) < Position(graph, reader));
+	}
+
+	// Write after write keeps declaration order.
+	{
+		RenderGraph graph;
+		RGResource bb = graph.ImportTexture("BackBuffer", backBuffer);
+		RGResource t = graph.CreateTexture("T", Desc(1));
+		unsigned int first = Pass(graph, "First", { t }, { bb });
+		unsigned int second = Pass(graph, "Second", {}, { bb });
+		unsigned int feeder = Pass(graph, "Feeder", {}, { t });
+		// First waits on the later declared Feeder, Second has nothing to wait on but still has to draw over First.
+		ok &= Report("write after write keeps declaration order", graph.Compile() &&
+			Position(graph, feeder) < Position(graph, first) && Position(graph, first) < Position(graph, second));
+	}
+
+	// Write after read: Reader wants the first T, so the second writer waits for it. Reader also waits on a later
+	// declared pass, so declaration order alone would run the second writer too early.
+	{
+		RenderGraph graph;
+		RGResource bb = graph.ImportTexture("BackBuffer", backBuffer);
+		RGResource other = graph.ImportTexture("Other", persistent);
+		RGResource t = graph.CreateTexture("T", Desc(1));
+		RGResource u = graph.CreateTexture("U", Desc(2));
+		unsigned int firstWriter = Pass(graph, "FirstWriter", {}, { t });
+		unsigned int reader = Pass(graph, "Reader", { t, u }, { bb });
+		unsigned int secondWriter = Pass(graph, "SecondWriter", {}, { t, other });
+		unsigned int late = Pass(graph, "Late", {}, { u });
+		ok &= Report("write after read waits for the earlier reader", graph.Compile() &&
+			Position(graph, firstWriter) < Position(graph, reader) && Position(graph, late) < Position(graph, reader) &&
+			Position(graph, reader) < Position(graph, secondWriter));
+	}
+	return ok;
+}
+
+static bool CheckAliasing()
+{
+	// A, B and C in a chain: A is done before C starts, B overlaps both. D is also made after A is done, but
+	// in another format, so it can't take A's texture.
+	RenderGraph graph;
+	NullRenderGraphBackend backend;
+	RGResource bb = graph.ImportTexture("BackBuffer", backBuffer);
+	RGResource a = graph.CreateTexture("A", Desc(1));
+	RGResource b = graph.CreateTexture("B", Desc(1));
+	RGResource c = graph.CreateTexture("C", Desc(1));
+	RGResource d = graph.CreateTexture("D", Desc(2));
+	Pass(graph, "MakeA", {}, { a });
+	Pass(graph, "AToB", { a }, { b });
+	Pass(graph, "BToC", { b }, { c, d });
+	Pass(graph, "Final", { c, d }, { bb });
+	bool ok = graph.Compile();
+	ok &= graph.PhysicalOf(a) == graph.PhysicalOf(c) && graph.PhysicalOf(a) != graph.PhysicalOf(b);
+	ok &= graph.PhysicalOf(d) != graph.PhysicalOf(a) && graph.PhysicalOf(d) != graph.PhysicalOf(b) && graph.PoolSize() == 3;
+	graph.Execute(backend);
+	ok &= backend.created == 3 && graph.GetTexture(a) == graph.GetTexture(c) && graph.GetTexture(a) != graph.GetTexture(b);
+	ok &= graph.GetTexture(bb) == backBuffer;
+	bool aliased = Report("transients alias only when lifetimes don't overlap", ok);
+
+	// Next frame, same passes: the pool is reused and nothing new is created.
+	graph.Reset();
+	bb = graph.ImportTexture("BackBuffer", backBuffer);
+	a = graph.CreateTexture("A", Desc(1));
+	b = graph.CreateTexture("B", Desc(1));
+	Pass(graph, "MakeA", {}, { a });
+	Pass(graph, "AToB", { a }, { b });
+	Pass(graph, "Final", { b }, { bb });
+	ok = graph.Compile();
+	graph.Execute(backend);
+	graph.TrimPool(backend);
+	ok &= backend.created == 3 && backend.destroyed == 1 && graph.PoolSize() == 2;
+	graph.ReleasePool(backend);
+	ok &= backend.destroyed == 3;
+	return Report("pool kept across frames, trimmed and released", ok) && aliased;
+}
+
+static bool CheckCycle()
+{
+	RenderGraph graph;
+	NullRenderGraphBackend backend;
+	RGResource bb = graph.ImportTexture("BackBuffer", backBuffer);
+	RGResource x = graph.CreateTexture("X", Desc(1));
+	RGResource y = graph.CreateTexture("Y", Desc(1));
+	bool ran = false;
+	Pass(graph, "XToY", { x }, { y });
+	Pass(graph, "YToX", { y }, { x });
+	graph.AddPass("Final", [&](RenderGraph::PassBuilder& builder) { builder.Read(y); builder.Write(bb); },
+		[&](RenderGraph&) { ran = true; });
+	bool compiled = graph.Compile();
+	graph.Execute(backend);
+	return Report("cycle fails Compile() and nothing runs", !compiled && !ran && backend.created == 0);
+}
+
+int main()
+{
+	bool ok = CheckCulling();
+	ok &= CheckOrdering();
+	ok &= CheckAliasing();
+	ok &= CheckCycle();
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "defines.h"
+#include "RenderGraph.h"
+#include <wrl/client.h>
+
+// What the D3D11 backend hands out for every graph texture, views are only made for the bind flags asked for.
+struct D3D11GraphTexture
+{
+	Microsoft::WRL::ComPtr<ID3D11Texture2D>				texture = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		rtv = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	srv = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView>		dsv = nullptr;
+};
+
+// Creates the graph's physical textures on a D3D11 device.
+class D3D11RenderGraphBackend : public RenderGraphBackend
+{
+	Microsoft::WRL::ComPtr<ID3D11Device> device = nullptr;
+
+public:
+	void SetDevice(ID3D11Device* dev)
+	{
+		device = dev;
+	}
+
+	// The depth and shader resource formats for a typeless depth texture, false for anything else.
+	static bool DepthViewFormats(DXGI_FORMAT format, DXGI_FORMAT& dsv, DXGI_FORMAT& srv)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_R32_TYPELESS:		dsv = DXGI_FORMAT_D32_FLOAT;			srv = DXGI_FORMAT_R32_FLOAT;				return true;
+		case DXGI_FORMAT_R24G8_TYPELESS:	dsv = DXGI_FORMAT_D24_UNORM_S8_UINT;	srv = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;	return true;
+		case DXGI_FORMAT_R16_TYPELESS:		dsv = DXGI_FORMAT_D16_UNORM;			srv = DXGI_FORMAT_R16_UNORM;				return true;
+		default:							return false;
+		}
+	}
+
+	void* CreateTexture(const RGTextureDesc& desc) override
+	{
+		D3D11_TEXTURE2D_DESC textureDesc = {};
+		textureDesc.Width = desc.width;
+		textureDesc.Height = desc.height;
+		textureDesc.MipLevels = 1;
+		textureDesc.ArraySize = 1;
+		textureDesc.Format = static_cast<DXGI_FORMAT>(desc.format);
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.Usage = D3D11_USAGE_DEFAULT;
+		textureDesc.BindFlags = desc.bindFlags;
+
+		D3D11GraphTexture* tex = new D3D11GraphTexture();
+		if (FAILED(device->CreateTexture2D(&textureDesc, nullptr, tex->texture.GetAddressOf())))
+		{
+			DebugBreak();
+			delete tex;
+			return nullptr;
+		}
+
+		if ((desc.bindFlags & D3D11_BIND_RENDER_TARGET) &&
+			FAILED(device->CreateRenderTargetView(tex->texture.Get(), nullptr, tex->rtv.GetAddressOf())))
+		{
+			DebugBreak();
+		}
+
+		// Typeless depth formats need a typed format for each view, everything else can let D3D pick.
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+		bool typeless = DepthViewFormats(textureDesc.Format, dsvDesc.Format, srvDesc.Format);
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels = 1;
+		dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+
+		if ((desc.bindFlags & D3D11_BIND_SHADER_RESOURCE) &&
+			FAILED(device->CreateShaderResourceView(tex->texture.Get(), typeless ? &srvDesc : nullptr, tex->srv.GetAddressOf())))
+		{
+			DebugBreak();
+		}
+
+		if ((desc.bindFlags & D3D11_BIND_DEPTH_STENCIL) &&
+			FAILED(device->CreateDepthStencilView(tex->texture.Get(), typeless ? &dsvDesc : nullptr, tex->dsv.GetAddressOf())))
+		{
+			DebugBreak();
+		}
+
+		return tex;
+	}
+
+	void DestroyTexture(void* texture) override
+	{
+		delete static_cast<D3D11GraphTexture*>(texture);
+	}
+
+	// Typed access to a resource while the graph is executing.
+	static D3D11GraphTexture* Get(const RenderGraph& graph, RGResource r)
+	{
+		return static_cast<D3D11GraphTexture*>(graph.GetTexture(r));
+	}
+};
@@ -0,0 +1,214 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cmath>
+#include <vector>
+#include "RenderGraph.h"
+
+using namespace DirectX;
+
+// Textures that have to keep their contents from one frame to the next, which the graph's transient pool can't
+// promise. Released textures stay around for a while so a target that changes size can pick an old one back up.
+class RenderTargetPool
+{
+	struct Entry
+	{
+		RGTextureDesc desc;
+		void* handle = nullptr;
+		bool inUse = false;
+		unsigned int lastUsed = 0;	// Frame it was last acquired or released
+	};
+
+	std::vector<Entry> entries;
+	unsigned int frame = 0;
+
+public:
+	void* Acquire(RenderGraphBackend& backend, const RGTextureDesc& desc)
+	{
+		for (Entry& e : entries)
+		{
+			if (!e.inUse && e.desc == desc)
+			{
+				e.inUse = true;
+				e.lastUsed = frame;
+				return e.handle;
+			}
+		}
+		Entry e;
+		e.desc = desc;
+		e.handle = backend.CreateTexture(desc);
+		if (e.handle == nullptr)
+			return nullptr;
+		e.inUse = true;
+		e.lastUsed = frame;
+		entries.push_back(e);
+		return e.handle;
+	}
+
+	void Release(void* handle)
+	{
+		for (Entry& e : entries)
+		{
+			if (e.handle == handle)
+			{
+				e.inUse = false;
+				e.lastUsed = frame;
+				return;
+			}
+		}
+	}
+
+	// Once a frame, destroys the free textures nobody has wanted for maxIdleFrames.
+	void EndFrame(RenderGraphBackend& backend, unsigned int maxIdleFrames = 120)
+	{
+		frame++;
+		for (size_t i = 0; i < entries.size();)
+		{
+			if (!entries[i].inUse && frame - entries[i].lastUsed > maxIdleFrames)
+			{
+				backend.DestroyTexture(entries[i].handle);
+				entries.erase(entries.begin() + i);
+			}
+			else
+				i++;
+		}
+	}
+
+	void ReleaseAll(RenderGraphBackend& backend)
+	{
+		for (Entry& e : entries)
+			backend.DestroyTexture(e.handle);
+		entries.clear();
+	}
+
+	unsigned int Count() const { return static_cast<unsigned int>(entries.size()); }
+};
+
+// Widest side, in pixels, of the screen rect a box covers in a viewport. Anything crossing the camera plane
+// could be arbitrarily big on screen and gets the whole viewport.
+inline float ProjectedFootprint(FXMMATRIX viewProjection, const XMFLOAT3& center, const XMFLOAT3& extents,
+	float viewportWidth, float viewportHeight)
+{
+	float largest = fmaxf(viewportWidth, viewportHeight);
+	float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+	for (int i = 0; i < 8; i++)
+	{
+		XMVECTOR corner = XMVectorSet(center.x + ((i & 1) ? extents.x : -extents.x),
+			center.y + ((i & 2) ? extents.y : -extents.y),
+			center.z + ((i & 4) ? extents.z : -extents.z), 1.0f);
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector4Transform(corner, viewProjection));
+		if (clip.w <= 1e-4f)
+			return largest;
+		minX = fminf(minX, clip.x / clip.w);
+		maxX = fmaxf(maxX, clip.x / clip.w);
+		minY = fminf(minY, clip.y / clip.w);
+		maxY = fmaxf(maxY, clip.y / clip.w);
+	}
+	// Only the part inside the viewport is ever drawn.
+	float width = (fminf(maxX, 1.0f) - fmaxf(minX, -1.0f)) * 0.5f * viewportWidth;
+	float height = (fminf(maxY, 1.0f) - fmaxf(minY, -1.0f)) * 0.5f * viewportHeight;
+	return fminf(fmaxf(fmaxf(width, height), 0.0f), largest);
+}
+
+// A square render to texture target sized from how big the surface showing it is on screen, and only
+// redrawn every few frames. Grows straight away, but only shrinks once it has been more than twice too big
+// for a while, so a surface sitting near a size boundary doesn't flip between two textures.
+class AdaptiveRenderTarget
+{
+	unsigned int minSize = 64, maxSize = 1024;
+	unsigned int interval = 3;			// Frames between redraws when nothing forces one
+	unsigned int shrinkDelay = 30;		// Frames the target has to be too big for before it shrinks
+	unsigned int hiddenDelay = 120;		// Frames the surface has to be out of sight for before the target goes back
+	RGTextureDesc format;
+
+	void* target = nullptr;
+	unsigned int size = 0;
+	unsigned int framesSinceDraw = 0, framesTooBig = 0, framesHidden = 0;
+	bool stale = true;
+
+	static unsigned int NextPowerOfTwo(unsigned int v)
+	{
+		unsigned int p = 1;
+		while (p < v)
+			p <<= 1;
+		return p;
+	}
+
+public:
+	// desc's size is ignored, only its format and bind flags are used.
+	void Configure(const RGTextureDesc& desc, unsigned int smallest = 64, unsigned int largest = 1024, unsigned int redrawInterval = 3)
+	{
+		format = desc;
+		minSize = NextPowerOfTwo(smallest);
+		maxSize = NextPowerOfTwo(largest);
+		interval = (redrawInterval < 1) ? 1 : redrawInterval;
+		stale = true;
+	}
+
+	// Once a frame with the surface's largest footprint over every view showing it, 0 if none can see it.
+	// Returns true when the target has to be drawn this frame, because it's new, was resized, changed is set
+	// or it's been interval frames.
+	bool Update(RenderGraphBackend& backend, RenderTargetPool& pool, float footprint, bool changed)
+	{
+		if (footprint <= 0.0f)
+		{
+			if (target != nullptr && ++framesHidden > hiddenDelay)
+			{
+				pool.Release(target);
+				target = nullptr;
+				size = 0;
+			}
+			return false;
+		}
+		framesHidden = 0;
+
+		unsigned int wanted = NextPowerOfTwo(static_cast<unsigned int>(ceilf(footprint)));
+		wanted = (wanted < minSize) ? minSize : (wanted > maxSize ? maxSize : wanted);
+		unsigned int next = size;
+		if (target == nullptr || wanted > size)
+			next = wanted;
+		else if (wanted * 2 <= size)
+		{
+			if (++framesTooBig >= shrinkDelay)
+				next = wanted;
+		}
+		else
+			framesTooBig = 0;
+
+		if (target == nullptr || next != size)
+		{
+			if (target != nullptr)
+				pool.Release(target);
+			RGTextureDesc desc = format;
+			desc.width = desc.height = next;
+			target = pool.Acquire(backend, desc);
+			size = (target != nullptr) ? next : 0;
+			framesTooBig = 0;
+			stale = true;
+		}
+		if (target == nullptr)
+			return false;
+
+		bool draw = stale || changed || ++framesSinceDraw >= interval;
+		if (draw)
+		{
+			framesSinceDraw = 0;
+			stale = false;
+		}
+		return draw;
+	}
+
+	// Forces a redraw next frame, e.g. after the device's targets were recreated.
+	void Invalidate() { stale = true; }
+
+	void Release(RenderTargetPool& pool)
+	{
+		if (target != nullptr)
+			pool.Release(target);
+		target = nullptr;
+		size = 0;
+	}
+
+	void* Target() const { return target; }
+	unsigned int Size() const { return size; }
+};
@@ -0,0 +1,106 @@
+#include "RockInstancing.h"
+#include "StoneHenge.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+// Checks the rock instances against the geometry shader they replaced: for every StoneHenge vertex under a range of
+// world matrices, the old GS's scale and offset copies against ApplyRockInstance and World * RockInstanceMatrix, and
+// its below ground cut against RockClipDistance. Needs nothing but DirectXMath.
+// RockCheck [tolerance]   defaults to 1e-5.
+
+// The old GS, per emitted vertex: the world position of copy 1 to 3, scaled and moved by its hard-coded numbers.
+static XMFLOAT4 OldGSVertex(XMFLOAT4 pos, int copy)
+{
+	if (copy == 1)
+	{
+		// Scale
+		pos.x *= 0.25f;
+		pos.y *= 0.25f;
+		pos.z *= 0.25f;
+		// Movement
+		pos.x += 0.85f;
+		pos.y -= 0.2f;
+		pos.z += 0.5f;
+	}
+	else if (copy == 2)
+	{
+		pos.x *= 0.25f;
+		pos.y *= 0.25f;
+		pos.z *= 0.25f;
+		pos.x -= 0.75f;
+		pos.y -= 0.25f;
+		pos.z -= 0.5f;
+	}
+	else if (copy == 3)
+	{
+		pos.x *= 0.0625f;
+		pos.y *= 0.0625f;
+		pos.z *= 0.0625f;
+		pos.x += 0.05f;
+		pos.y += 0.27f;
+		pos.z += 0.05f;
+	}
+	return pos;
+}
+
+// The old GS restarted its strip at a rock vertex below -0.1, copy 0 (the mesh itself) it never touched.
+static bool OldGSCuts(const XMFLOAT4& pos, int copy)
+{
+	return copy > 0 && pos.y < -0.1f;
+}
+
+static float Distance(const XMFLOAT4& a, FXMVECTOR b)
+{
+	return XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat4(&a), b)));
+}
+
+static bool Check(const char* name, FXMMATRIX world, float tolerance)
+{
+	const unsigned int vertexCount = sizeof(StoneHenge_data) / sizeof(StoneHenge_data[0]);
+	std::vector<RockInstance> instances = GenerateRockInstances();
+	bool ok = instances.size() == 4;
+	float worstApply = 0.0f, worstMatrix = 0.0f;
+	unsigned int cut = 0, cutMismatches = 0;
+	for (unsigned int v = 0; v < vertexCount && ok; v++)
+	{
+		// Scaled the way ReadModel does
+		const float* p = StoneHenge_data[v].pos;
+		XMVECTOR local = XMVectorSet(p[0] * 0.1f, p[1] * 0.1f, p[2] * 0.1f, 1.0f);
+		XMFLOAT4 worldPos;
+		XMStoreFloat4(&worldPos, XMVector4Transform(local, world));
+		for (int copy = 0; copy < 4; copy++)
+		{
+			XMFLOAT4 old = OldGSVertex(worldPos, copy);
+			XMVECTOR applied = ApplyRockInstance(XMLoadFloat4(&worldPos), instances[copy]);
+			XMVECTOR matrix = XMVector4Transform(local, world * RockInstanceMatrix(instances[copy]));
+			worstApply = fmaxf(worstApply, Distance(old, applied));
+			worstMatrix = fmaxf(worstMatrix, Distance(old, matrix));
+
+			bool oldCut = OldGSCuts(old, copy);
+			cut += oldCut ? 1 : 0;
+			if (oldCut != (RockClipDistance(applied, instances[copy]) < 0.0f) || oldCut != (RockClipDistance(matrix, instances[copy]) < 0.0f))
+				cutMismatches++;
+		}
+	}
+	ok &= worstApply <= tolerance && worstMatrix <= tolerance && cutMismatches == 0;
+	printf("%-14s %u vertices x 4, worst ApplyRockInstance %.2g, World * RockInstanceMatrix %.2g, %u cut, %u cut differently: %s\n",
+		name, vertexCount, worstApply, worstMatrix, cut, cutMismatches, ok ? "matches" : "MISMATCH");
+	return ok;
+}
+
+int main(int argc, char** argv)
+{
+	float tolerance = (argc > 1) ? (float)atof(argv[1]) : 1e-5f;
+
+	// The world starts as the identity and the arrow keys turn it around Y, 0.1 a press.
+	bool ok = Check("identity", XMMatrixIdentity(), tolerance);
+	ok &= Check("turned 0.1", XMMatrixRotationY(0.1f), tolerance);
+	ok &= Check("turned -1.3", XMMatrixRotationY(-1.3f), tolerance);
+	ok &= Check("turned 3.1", XMMatrixRotationY(3.1f), tolerance);
+	XMMATRIX turned = XMMatrixIdentity();
+	for (int press = 0; press < 40; press++)
+		turned *= XMMatrixRotationY(0.1f);
+	ok &= Check("40 presses", turned, tolerance);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+
+using namespace DirectX;
+
+// One copy of the mesh, applied in world space: position * scale + offset.
+// This is exactly what the old "cheap rocks" geometry shader did per emitted vertex.
+struct RockInstance
+{
+	XMFLOAT4 offsetScale;	// xyz offset, w uniform scale
+};
+
+// Generated once at startup. Instance 0 is the mesh itself, the rest are the three rocks.
+inline std::vector<RockInstance> GenerateRockInstances()
+{
+	std::vector<RockInstance> instances;
+	instances.push_back({ XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f) });
+	// First little rock
+	instances.push_back({ XMFLOAT4(0.85f, -0.2f, 0.5f, 0.25f) });
+	// Second little rock
+	instances.push_back({ XMFLOAT4(-0.75f, -0.25f, -0.5f, 0.25f) });
+	// Third little rock
+	instances.push_back({ XMFLOAT4(0.05f, 0.27f, 0.05f, 0.0625f) });
+	return instances;
+}
+
+// CPU reference of the shader math (VSInstanced/VSDepth) for a world space position, w is left alone.
+inline XMVECTOR ApplyRockInstance(FXMVECTOR worldPos, const RockInstance& inst)
+{
+	XMVECTOR offset = XMLoadFloat4(&inst.offsetScale);
+	XMVECTOR moved = XMVectorMultiplyAdd(worldPos, XMVectorReplicate(inst.offsetScale.w), offset);
+	return XMVectorSetW(moved, XMVectorGetW(worldPos));
+}
+
+// The same transform as a matrix, to be applied after the world matrix (culling, overdraw counting).
+inline XMMATRIX RockInstanceMatrix(const RockInstance& inst)
+{
+	float s = inst.offsetScale.w;
+	return XMMatrixScaling(s, s, s) * XMMatrixTranslation(inst.offsetScale.x, inst.offsetScale.y, inst.offsetScale.z);
+}
+
+// The rocks are clipped below this world height, the old GS cut those triangles out of its strip.
+static const float rockClipHeight = -0.1f;
+
+// CPU reference of InstanceToClip's SV_ClipDistance0 for a moved world position, negative is clipped.
+inline float RockClipDistance(FXMVECTOR movedPos, const RockInstance& inst)
+{
+	return (inst.offsetScale.w < 1.0f) ? XMVectorGetY(movedPos) - rockClipHeight : 1.0f;
+}
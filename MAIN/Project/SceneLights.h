@@ -0,0 +1,68 @@
+#pragma once
+#include "LightManager.h"
+
+// The directional, point and spot lights the project starts with, in the slots the fixed shaders use (0, 1, 2).
+// Spins are how fast each one turns around the origin.
+inline void AddSceneLights(LightManager& lights)
+{
+	// Directional Lighting
+	LightDesc sun;
+	sun.type = LIGHT_DIRECTIONAL;
+	sun.direction = { -0.577f, 0.577f, -0.577f };
+	sun.color = { 0.6f, 0.6f, 0.6f };
+	sun.directionSpin = 0.2f;
+	lights.Add(sun);
+	// Positional Lighting
+	LightDesc point;
+	point.position = { 0.0f, 0.2f, -1.0f };
+	point.color = { 0.0f, 0.8f, 0.8f };
+	point.range = 3.0f;
+	point.positionSpin = -1.0f;
+	lights.Add(point);
+	// Spot Light, the fixed shader takes the direction towards the light so it's flipped on the way in.
+	LightDesc spot;
+	spot.type = LIGHT_SPOT;
+	spot.position = { 0.0f, 2.0f, -2.0f };
+	spot.direction = { 0.0f, -0.577f, 0.577f };
+	spot.color = { 1.0f, 0.0f, 0.0f };
+	spot.range = 8.0f;
+	spot.spotCos = 20.0f / 25.0f;	// The shader's cone / 25
+	spot.positionSpin = -0.1f;
+	spot.directionSpin = 2.0f;
+	lights.Add(spot);
+}
+
+// Moves the lights AddSceneLights made by one frame. Nothing but t feeds it, so the same steps always give the
+// same lights; the headless capture relies on that to match frame for frame.
+struct SceneLightAnimator
+{
+	bool doFlip = false;	// The point light is brightening back up
+
+	// t is the frame's time in Mesh::UpdateScene's units (milliseconds / 1500). holdSun stops the sun turning.
+	void Step(LightManager& lights, float t, bool holdSun)
+	{
+		// Pulse the point light's brightness
+		XMFLOAT3 pointClr = lights.Color(1);
+		if (!doFlip)
+		{
+			pointClr.y -= t;
+			pointClr.z -= t;
+
+			if (!XMVector3GreaterOrEqual(XMLoadFloat3(&pointClr), XMVectorSet(0.0f, 0.1f, 0.1f, 0.0f)))
+				doFlip = true;
+		}
+		else
+		{
+			pointClr.y += t;
+			pointClr.z += t;
+
+			if (XMVector3GreaterOrEqual(XMLoadFloat3(&pointClr), XMVectorSet(0.0f, 0.9f, 0.9f, 0.0f)))
+				doFlip = false;
+		}
+		lights.SetColor(1, pointClr);
+
+		// Turn every light by its spin
+		lights.SetSpin(0, 0.0f, holdSun ? 0.0f : 0.2f);
+		lights.Animate(t);
+	}
+};
@@ -0,0 +1,229 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// FNV-1a, plenty for telling shader sources apart. Chain calls by passing the last result back in.
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// Everything that changes the compiled output of one entry point.
+struct ShaderKey
+{
+	uint64_t sourceHash = 0;
+	std::string entry;
+	std::string profile;
+	std::string defines;	// "NAME=VALUE;" pairs, in a fixed order
+	uint32_t flags = 0;
+
+	uint64_t Hash() const
+	{
+		uint64_t hash = HashBytes(&sourceHash, sizeof(sourceHash));
+		hash = HashBytes(entry.c_str(), entry.size() + 1, hash);
+		hash = HashBytes(profile.c_str(), profile.size() + 1, hash);
+		hash = HashBytes(defines.c_str(), defines.size() + 1, hash);
+		return HashBytes(&flags, sizeof(flags), hash);
+	}
+
+	bool operator==(const ShaderKey& o) const
+	{
+		return sourceHash == o.sourceHash && flags == o.flags && entry == o.entry && profile == o.profile && defines == o.defines;
+	}
+};
+
+// Compiled shader blobs kept in memory and on disk, one file per key named after its hash.
+// Entries in memory and on disk both keep the full key, so a hash collision or stale file reads as a miss.
+// Nothing in here knows about D3D, the compiler is passed in, so it works with stub blobs anywhere.
+class ShaderCache
+{
+public:
+	// Fills blob from source for the key, returns false on a compile error.
+	typedef std::function<bool(const std::string& source, const ShaderKey& key, std::vector<uint8_t>& blob)> Compiler;
+
+private:
+	static const uint32_t fileMagic = 0x43485344;	// "DSHC"
+	static const uint32_t fileVersion = 2;
+
+	// A blob and the key it was compiled for.
+	struct Entry
+	{
+		ShaderKey key;
+		std::vector<uint8_t> blob;
+	};
+
+	std::string directory;
+	std::unordered_map<uint64_t, Entry> loaded;
+	std::atomic<unsigned int> hits{ 0 }, misses{ 0 };
+	std::mutex lock;	// Compile jobs share one cache, the compiler itself runs outside the lock
+
+	static void WriteString(std::vector<uint8_t>& out, const std::string& s)
+	{
+		uint32_t size = (uint32_t)s.size();
+		out.insert(out.end(), (const uint8_t*)&size, (const uint8_t*)&size + sizeof(size));
+		out.insert(out.end(), s.begin(), s.end());
+	}
+
+	static bool ReadBytes(const std::vector<uint8_t>& in, size_t& at, void* dst, size_t size)
+	{
+		if (at + size > in.size())
+			return false;
+		memcpy(dst, in.data() + at, size);
+		at += size;
+		return true;
+	}
+
+	static bool ReadString(const std::vector<uint8_t>& in, size_t& at, std::string& s)
+	{
+		uint32_t size = 0;
+		if (!ReadBytes(in, at, &size, sizeof(size)) || at + size > in.size())
+			return false;
+		s.assign((const char*)in.data() + at, size);
+		at += size;
+		return true;
+	}
+
+public:
+	explicit ShaderCache(const std::string& _directory) : directory(_directory) {}
+
+	static bool ReadFile(const std::string& path, std::vector<uint8_t>& data)
+	{
+		FILE* file = fopen(path.c_str(), "rb");
+		if (!file)
+			return false;
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		data.resize(size > 0 ? size : 0);
+		bool ok = data.empty() || fread(data.data(), 1, data.size(), file) == data.size();
+		fclose(file);
+		return ok;
+	}
+
+	static bool WriteFile(const std::string& path, const std::vector<uint8_t>& data)
+	{
+		FILE* file = fopen(path.c_str(), "wb");
+		if (!file)
+			return false;
+		bool ok = data.empty() || fwrite(data.data(), 1, data.size(), file) == data.size();
+		fclose(file);
+		return ok;
+	}
+
+	std::string PathOf(const ShaderKey& key) const
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)key.Hash());
+		return directory + "/" + name;
+	}
+
+	// File layout: magic, version, key, blob size, blob.
+	static std::vector<uint8_t> Serialize(const ShaderKey& key, const std::vector<uint8_t>& blob)
+	{
+		std::vector<uint8_t> out;
+		uint32_t header[2] = { fileMagic, fileVersion };
+		out.insert(out.end(), (const uint8_t*)header, (const uint8_t*)header + sizeof(header));
+		out.insert(out.end(), (const uint8_t*)&key.sourceHash, (const uint8_t*)&key.sourceHash + sizeof(key.sourceHash));
+		out.insert(out.end(), (const uint8_t*)&key.flags, (const uint8_t*)&key.flags + sizeof(key.flags));
+		WriteString(out, key.entry);
+		WriteString(out, key.profile);
+		WriteString(out, key.defines);
+		uint32_t size = (uint32_t)blob.size();
+		out.insert(out.end(), (const uint8_t*)&size, (const uint8_t*)&size + sizeof(size));
+		out.insert(out.end(), blob.begin(), blob.end());
+		return out;
+	}
+
+	// Returns false if the data is damaged, from another version, or holds a different key.
+	static bool Deserialize(const std::vector<uint8_t>& in, const ShaderKey& key, std::vector<uint8_t>& blob)
+	{
+		size_t at = 0;
+		uint32_t header[2] = {};
+		ShaderKey stored;
+		uint32_t size = 0;
+		if (!ReadBytes(in, at, header, sizeof(header)) || header[0] != fileMagic || header[1] != fileVersion)
+			return false;
+		if (!ReadBytes(in, at, &stored.sourceHash, sizeof(stored.sourceHash)) || !ReadBytes(in, at, &stored.flags, sizeof(stored.flags)) ||
+			!ReadString(in, at, stored.entry) || !ReadString(in, at, stored.profile) || !ReadString(in, at, stored.defines) ||
+			!ReadBytes(in, at, &size, sizeof(size)))
+			return false;
+		if (!(stored == key) || at + size != in.size())
+			return false;
+		blob.assign(in.begin() + at, in.end());
+		return true;
+	}
+
+	// Memory first, then disk. Never compiles.
+	bool Lookup(const ShaderKey& key, std::vector<uint8_t>& blob)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		auto found = loaded.find(key.Hash());
+		if (found != loaded.end() && found->second.key == key)
+		{
+			blob = found->second.blob;
+			return true;
+		}
+		std::vector<uint8_t> file;
+		if (!ReadFile(PathOf(key), file) || !Deserialize(file, key, blob))
+			return false;
+		loaded[key.Hash()] = { key, blob };
+		return true;
+	}
+
+	// Keeps the blob and writes it out, a failed write only costs a recompile next launch.
+	void Store(const ShaderKey& key, const std::vector<uint8_t>& blob)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		loaded[key.Hash()] = { key, blob };
+#ifdef _WIN32
+		_mkdir(directory.c_str());
+#else
+		mkdir(directory.c_str(), 0755);
+#endif
+		WriteFile(PathOf(key), Serialize(key, blob));
+	}
+
+	// Cached blob for the entry point, compiling and storing it on a miss.
+	bool Get(const std::string& source, const std::string& entry, const std::string& profile, const std::string& defines,
+		uint32_t flags, const Compiler& compile, std::vector<uint8_t>& blob)
+	{
+		ShaderKey key;
+		key.sourceHash = HashBytes(source.data(), source.size());
+		key.entry = entry;
+		key.profile = profile;
+		key.defines = defines;
+		key.flags = flags;
+
+		if (Lookup(key, blob))
+		{
+			hits++;
+			return true;
+		}
+		misses++;
+		if (!compile(source, key, blob))
+			return false;
+		Store(key, blob);
+		return true;
+	}
+
+	unsigned int Hits() const { return hits; }
+	unsigned int Misses() const { return misses; }
+};
@@ -0,0 +1,185 @@
+#include "ShaderCache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#ifdef _WIN32
+#define rmdir _rmdir
+#else
+#include <unistd.h>
+#endif
+
+// Checks ShaderCache's lookups with a stub compiler that makes blobs out of its inputs, in a folder of its own that
+// it clears before and after. Needs nothing at all.
+// ShaderCacheCheck [folder]   defaults to ShaderCacheCheck.tmp in the working folder.
+
+static const char* const source = "float4 PS() : SV_Target { return 1; }";
+
+// Counts its calls, the blob spells out everything it was compiled from.
+struct StubCompiler
+{
+	unsigned int calls = 0;
+	bool fail = false;
+
+	ShaderCache::Compiler Get()
+	{
+		return [this](const std::string& src, const ShaderKey& key, std::vector<uint8_t>& blob)
+		{
+			calls++;
+			if (fail)
+				return false;
+			std::string text = src + "|" + key.entry + "|" + key.profile + "|" + key.defines + "|" + std::to_string(key.flags);
+			blob.assign(text.begin(), text.end());
+			return true;
+		};
+	}
+};
+
+struct Request
+{
+	std::string source = ::source, entry = "PS", profile = "ps_4_0", defines = "";
+	uint32_t flags = 0;
+
+	ShaderKey Key() const
+	{
+		ShaderKey key;
+		key.sourceHash = HashBytes(source.data(), source.size());
+		key.entry = entry;
+		key.profile = profile;
+		key.defines = defines;
+		key.flags = flags;
+		return key;
+	}
+
+	bool Get(ShaderCache& cache, StubCompiler& compiler, std::vector<uint8_t>& blob) const
+	{
+		return cache.Get(source, entry, profile, defines, flags, compiler.Get(), blob);
+	}
+};
+
+static bool Report(const char* what, bool ok)
+{
+	printf("%-48s %s\n", what, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+// Gets the request from a fresh cache, so only the file on disk can make it a hit. Returns whether it compiled.
+static bool CompilesFresh(const std::string& folder, const Request& request, bool& got)
+{
+	ShaderCache cache(folder);
+	StubCompiler compiler;
+	std::vector<uint8_t> blob;
+	got = request.Get(cache, compiler, blob);
+	return compiler.calls == 1 && cache.Misses() == 1 && cache.Hits() == 0;
+}
+
+int main(int argc, char** argv)
+{
+	std::string folder = (argc > 1) ? argv[1] : "ShaderCacheCheck.tmp";
+	bool ok = true;
+
+	// Every request this makes, so their files can be cleared.
+	Request base, otherSource, otherEntry, otherProfile, otherDefines, otherFlags;
+	otherSource.source += " ";
+	otherEntry.entry = "PSSolid";
+	otherProfile.profile = "ps_5_0";
+	otherDefines.defines = "SHADOWS=1;";
+	otherFlags.flags = 1;
+	const Request* all[] = { &base, &otherSource, &otherEntry, &otherProfile, &otherDefines, &otherFlags };
+	ShaderCache paths(folder);
+	for (const Request* r : all)
+		remove(paths.PathOf(r->Key()).c_str());
+
+	// A miss compiles and stores, asking again is a hit with no compile, in memory and from disk.
+	{
+		ShaderCache cache(folder);
+		StubCompiler compiler;
+		std::vector<uint8_t> first, second;
+		bool good = base.Get(cache, compiler, first) && compiler.calls == 1 && cache.Misses() == 1 && cache.Hits() == 0;
+		good &= base.Get(cache, compiler, second) && compiler.calls == 1 && cache.Hits() == 1 && second == first;
+		ok &= Report("miss compiles, second ask is a hit", good);
+
+		ShaderCache reopened(folder);
+		StubCompiler untouched;
+		std::vector<uint8_t> fromDisk;
+		good = reopened.Lookup(base.Key(), fromDisk) && fromDisk == first;
+		good &= base.Get(reopened, untouched, fromDisk) && untouched.calls == 0 && reopened.Hits() == 1 && fromDisk == first;
+		ok &= Report("reopened cache hits from disk, no compile", good);
+	}
+
+	// Anything in the key that changes is a new compile with its own blob, and leaves the old entry alone.
+	{
+		const Request* changed[] = { &otherSource, &otherEntry, &otherProfile, &otherDefines, &otherFlags };
+		const char* names[] = { "source hash", "entry point", "profile", "defines", "flags" };
+		ShaderCache cache(folder);
+		StubCompiler compiler;
+		std::vector<uint8_t> original, blob;
+		base.Get(cache, compiler, original);
+		for (int i = 0; i < 5; i++)
+		{
+			bool got = false;
+			bool good = CompilesFresh(folder, *changed[i], got) && got;
+			good &= cache.Lookup(changed[i]->Key(), blob) && blob != original;
+			char what[64];
+			snprintf(what, sizeof(what), "changed %s misses", names[i]);
+			ok &= Report(what, good);
+		}
+		ok &= Report("original entry still a hit", base.Get(cache, compiler, blob) && blob == original && compiler.calls == 0);
+	}
+
+	// Damaged or out of date files on disk read as misses and get rewritten.
+	{
+		std::string path = paths.PathOf(base.Key());
+		std::vector<uint8_t> good;
+		ShaderCache::ReadFile(path, good);
+
+		struct Damage
+		{
+			const char* name;
+			std::vector<uint8_t> file;
+		};
+		std::vector<Damage> damaged;
+		// Another key's entry in this key's file, as after a hash collision.
+		std::vector<uint8_t> stub(3, 7);
+		damaged.push_back({ "file holding another key misses", ShaderCache::Serialize(otherEntry.Key(), stub) });
+		damaged.push_back({ "file cut short misses", std::vector<uint8_t>(good.begin(), good.end() - 3) });
+		damaged.push_back({ "file cut inside the key misses", std::vector<uint8_t>(good.begin(), good.begin() + 12) });
+		std::vector<uint8_t> longer = good;
+		longer.push_back(0);
+		damaged.push_back({ "file with bytes left over misses", longer });
+		// Version is the second word of the header.
+		std::vector<uint8_t> bumped = good;
+		bumped[4]++;
+		damaged.push_back({ "file from another version misses", bumped });
+		std::vector<uint8_t> empty;
+		damaged.push_back({ "empty file misses", empty });
+
+		for (const Damage& d : damaged)
+		{
+			ShaderCache::WriteFile(path, d.file);
+			bool got = false;
+			bool miss = CompilesFresh(folder, base, got) && got;
+			std::vector<uint8_t> rewritten;
+			ShaderCache::ReadFile(path, rewritten);
+			ok &= Report(d.name, miss && rewritten == good);
+		}
+	}
+
+	// A failed compile stores nothing, so the next ask compiles again.
+	{
+		ShaderCache cache(folder);
+		StubCompiler compiler;
+		compiler.fail = true;
+		std::vector<uint8_t> blob;
+		Request broken;
+		broken.entry = "Broken";
+		bool good = !broken.Get(cache, compiler, blob) && !broken.Get(cache, compiler, blob) && compiler.calls == 2;
+		good &= !cache.Lookup(broken.Key(), blob) && cache.Misses() == 2;
+		ok &= Report("failed compile isn't cached", good);
+		remove(cache.PathOf(broken.Key()).c_str());
+	}
+
+	for (const Request* r : all)
+		remove(paths.PathOf(r->Key()).c_str());
+	rmdir(folder.c_str());
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+#include "ShaderJobs.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Checks ShaderBatch's scheduling with a fake compiler on a small thread pool: every entry compiled once, input
+// layouts made only from their own vertex shader's finished blob, a failed compile failing the batch without hanging,
+// and join called once before Run returns. Needs nothing at all.
+// ShaderJobCheck [workers] [rounds]   defaults to 4 workers and 50 rounds.
+
+// Same shape as Gateware's GConcurrent as the project uses it: BranchSingular queues a task, Converge waits for all.
+class WorkerPool
+{
+	std::vector<std::thread> threads;
+	std::deque<std::function<void()>> queue;
+	std::mutex lock;
+	std::condition_variable wake, idle;
+	unsigned int running = 0;
+	bool stopping = false;
+
+public:
+	explicit WorkerPool(unsigned int count)
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			threads.emplace_back([this]()
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				for (;;)
+				{
+					wake.wait(guard, [this]() { return stopping || !queue.empty(); });
+					if (queue.empty())
+						return;
+					std::function<void()> task = queue.front();
+					queue.pop_front();
+					running++;
+					guard.unlock();
+					task();
+					guard.lock();
+					running--;
+					if (queue.empty() && running == 0)
+						idle.notify_all();
+				}
+			});
+		}
+	}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread& t : threads)
+			t.join();
+	}
+
+	void Branch(std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			queue.push_back(task);
+		}
+		wake.notify_one();
+	}
+
+	void Converge()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		idle.wait(guard, [this]() { return queue.empty() && running == 0; });
+	}
+};
+
+// What the fake compiler and the create steps saw, shared by the workers.
+struct Record
+{
+	std::mutex lock;
+	std::map<std::string, unsigned int> compiles, creates;
+	std::map<std::string, std::vector<uint8_t>> blobs;	// Finished blobs, by entry and defines
+	unsigned int layoutsBeforeBlob = 0;
+	unsigned int outstanding = 0;						// Tasks handed out and not finished
+};
+
+static std::string Name(const std::string& entry, const std::string& defines)
+{
+	return entry + "[" + defines + "]";
+}
+
+// The project's batch in miniature: vertex shaders with and without an input layout, pixel shader permutations.
+static void Queue(ShaderBatch& batch, Record& record, unsigned int permutations)
+{
+	for (const char* vs : { "VS", "VSDepth", "VSInstanced" })
+	{
+		std::string name = Name(vs, "");
+		batch.Add(vs, "vs_4_0", [&record, name](const std::vector<uint8_t>& blob)
+		{
+			// The input layout is checked against this vertex shader's blob, which has to be the finished one.
+			std::lock_guard<std::mutex> guard(record.lock);
+			auto found = record.blobs.find(name);
+			if (found == record.blobs.end() || found->second != blob)
+				record.layoutsBeforeBlob++;
+			record.creates[name]++;
+			return true;
+		});
+	}
+	batch.Add("GridVS", "vs_4_0", [&record](const std::vector<uint8_t>&)
+	{
+		std::lock_guard<std::mutex> guard(record.lock);
+		record.creates[Name("GridVS", "")]++;
+		return true;
+	});
+	for (unsigned int key = 0; key < permutations; key++)
+	{
+		std::string defines = "PERM=" + std::to_string(key) + ";";
+		std::string name = Name("PSPermutation", defines);
+		batch.Add("PSPermutation", "ps_4_0", [&record, name](const std::vector<uint8_t>&)
+		{
+			std::lock_guard<std::mutex> guard(record.lock);
+			record.creates[name]++;
+			return true;
+		}, defines);
+	}
+}
+
+static size_t HashName(const std::string& name)
+{
+	return std::hash<std::string>()(name);
+}
+
+// Takes a little while, and a random while, so jobs finish out of order. Fails the one entry named failing.
+static ShaderBatch::Compiler FakeCompiler(Record& record, const std::string& failing, unsigned int seed)
+{
+	return [&record, failing, seed](const std::string& entry, const std::string& profile, const std::string& defines, std::vector<uint8_t>& blob)
+	{
+		std::string name = Name(entry, defines);
+		unsigned int spin = (unsigned int)(HashName(name) ^ seed) % 200;
+		std::this_thread::sleep_for(std::chrono::microseconds(spin));
+		std::lock_guard<std::mutex> guard(record.lock);
+		record.compiles[name]++;
+		if (name == failing)
+			return false;
+		std::string text = name + profile;
+		blob.assign(text.begin(), text.end());
+		record.blobs[name] = blob;
+		return true;
+	};
+}
+
+// One Run on the pool, with a time limit so a hang is reported instead of waited on forever.
+static bool RunBatch(unsigned int workers, const std::string& failing, unsigned int seed, unsigned int permutations)
+{
+	ShaderBatch batch;
+	Record record;
+	Queue(batch, record, permutations);
+	WorkerPool pool(workers);
+	unsigned int joins = 0;
+	bool unfinishedAtReturn = false;
+
+	std::packaged_task<bool()> run([&]()
+	{
+		bool result = batch.Run(FakeCompiler(record, failing, seed),
+			[&](std::function<void()> task)
+			{
+				{
+					std::lock_guard<std::mutex> guard(record.lock);
+					record.outstanding++;
+				}
+				pool.Branch([&record, task]()
+				{
+					task();
+					std::lock_guard<std::mutex> guard(record.lock);
+					record.outstanding--;
+				});
+			},
+			[&]()
+			{
+				joins++;
+				pool.Converge();
+			});
+		std::lock_guard<std::mutex> guard(record.lock);
+		unfinishedAtReturn = record.outstanding != 0;
+		return result;
+	});
+	std::future<bool> done = run.get_future();
+	std::thread runner(std::move(run));
+	if (done.wait_for(std::chrono::seconds(20)) != std::future_status::ready)
+	{
+		printf("Run hasn't returned after 20 s, DEADLOCK\n");
+		exit(1);
+	}
+	runner.join();
+	bool result = done.get();
+
+	bool ok = joins == 1 && !unfinishedAtReturn && record.layoutsBeforeBlob == 0;
+	ok &= record.compiles.size() == batch.Size();
+	for (const auto& c : record.compiles)
+	{
+		bool created = record.creates.count(c.first) != 0;
+		ok &= c.second == 1 && created == (c.first != failing);
+		if (created)
+			ok &= record.creates[c.first] == 1;
+	}
+	std::vector<std::string> failed = batch.Failed();
+	if (failing.empty())
+		ok &= result && failed.empty();
+	else
+		ok &= !result && failed.size() == 1 && failed[0].find("compile failed") != std::string::npos;
+	return ok;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int workers = (argc > 1) ? (unsigned int)atoi(argv[1]) : 4;
+	unsigned int rounds = (argc > 2) ? (unsigned int)atoi(argv[2]) : 50;
+	const unsigned int permutations = 32;
+
+	bool clean = true, oneFailing = true;
+	for (unsigned int round = 0; round < rounds; round++)
+	{
+		clean &= RunBatch(workers, "", round, permutations);
+		// A different job fails each round, the vertex shader with the layout among them.
+		std::string failing = (round % 3 == 0) ? Name("VS", "") : Name("PSPermutation", "PERM=" + std::to_string(round % permutations) + ";");
+		oneFailing &= RunBatch(workers, failing, round, permutations);
+	}
+	printf("%u workers, %u rounds of %u jobs, all compiling:  each compiled and created once, layouts after their blob, "
+		"one join: %s\n", workers, rounds, permutations + 4, clean ? "ok" : "FAILED");
+	printf("%u workers, %u rounds of %u jobs, one failing:    batch fails naming only it, no hang, one join: %s\n",
+		workers, rounds, permutations + 4, oneFailing ? "ok" : "FAILED");
+
+	// The serial path runs in the order the jobs were added, on this thread.
+	ShaderBatch batch;
+	Record record;
+	Queue(batch, record, 4);
+	std::vector<std::string> order;
+	std::thread::id caller = std::this_thread::get_id();
+	bool sameThread = true;
+	bool serial = batch.RunSerial([&](const std::string& entry, const std::string&, const std::string& defines, std::vector<uint8_t>& blob)
+	{
+		order.push_back(Name(entry, defines));
+		sameThread &= std::this_thread::get_id() == caller;
+		blob.assign(1, 0);
+		return true;
+	});
+	serial &= sameThread && order.size() == 8 && order[0] == Name("VS", "") && order[3] == Name("GridVS", "") &&
+		order[7] == Name("PSPermutation", "PERM=3;");
+	printf("serial run in the order added, on the calling thread: %s\n", serial ? "ok" : "FAILED");
+
+	return clean && oneFailing && serial ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// A batch of shader entry points compiled as independent jobs on a worker pool.
+// Each job compiles its blob and then runs its create step on the same worker, so anything that needs
+// the blob (a vertex shader's input layout) is made as soon as it's ready instead of after the whole batch.
+// Nothing here knows about D3D or Gateware: the compiler, the dispatch, and the join are all passed in.
+class ShaderBatch
+{
+public:
+	typedef std::function<bool(const std::string& entry, const std::string& profile, const std::string& defines, std::vector<uint8_t>& blob)> Compiler;
+	typedef std::function<bool(const std::vector<uint8_t>& blob)> Creator;
+	typedef std::function<void(std::function<void()>)> Dispatcher;
+
+private:
+	struct Job
+	{
+		std::string entry;
+		std::string profile;
+		std::string defines;
+		Creator create;
+		bool compiled = false;
+		bool created = false;
+	};
+	std::vector<Job> jobs;
+
+public:
+	void Add(const std::string& entry, const std::string& profile, Creator create, const std::string& defines = "")
+	{
+		Job job;
+		job.entry = entry;
+		job.profile = profile;
+		job.defines = defines;
+		job.create = create;
+		jobs.push_back(job);
+	}
+
+	// Hands every job to dispatch, then calls join once. Jobs only write to their own slot, so no locking here.
+	// Returns true if every job compiled and created.
+	bool Run(const Compiler& compile, const Dispatcher& dispatch, const std::function<void()>& join)
+	{
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			Job* job = &jobs[i];
+			dispatch([job, &compile]()
+			{
+				std::vector<uint8_t> blob;
+				job->compiled = compile(job->entry, job->profile, job->defines, blob);
+				job->created = job->compiled && job->create(blob);
+			});
+		}
+		join();
+		return Failed().empty();
+	}
+
+	// Same thing on the calling thread, in the order the jobs were added.
+	bool RunSerial(const Compiler& compile)
+	{
+		return Run(compile, [](std::function<void()> task) { task(); }, []() {});
+	}
+
+	// Entry points that didn't make it, for the error message.
+	std::vector<std::string> Failed() const
+	{
+		std::vector<std::string> failed;
+		for (const Job& job : jobs)
+		{
+			if (!job.created)
+			{
+				std::string name = job.entry + (job.defines.empty() ? "" : " [" + job.defines + "]");
+				failed.push_back(name + " (" + job.profile + (job.compiled ? ", create failed)" : ", compile failed)"));
+			}
+		}
+		return failed;
+	}
+
+	size_t Size() const { return jobs.size(); }
+	void Clear() { jobs.clear(); }
+};
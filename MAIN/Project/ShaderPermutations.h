@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Feature bits for PSPermutation in shaders.fx, each one turns into a macro when the variant is compiled.
+// The constant buffer only has one slot per light type, so the light "counts" are 0 or 1.
+enum ShaderPermutation : uint32_t
+{
+	PERM_NORMAL_MAP		= 1 << 0,	// NORMAL_MAP
+	PERM_DIR_LIGHT		= 1 << 1,	// NUM_DIR_LIGHTS
+	PERM_POINT_LIGHT	= 1 << 2,	// NUM_POINT_LIGHTS
+	PERM_SPOT_LIGHT		= 1 << 3,	// NUM_SPOT_LIGHTS
+	PERM_REFLECTION		= 1 << 4,	// REFLECTION, skybox reflection only, ignores everything else
+	PERM_CLUSTERED		= 1 << 5,	// CLUSTERED, point and spot lights come from the light clusters instead of the fixed slots
+	PERM_SHADOWS		= 1 << 6,	// SHADOWS, the directional and spot lights are shadowed, see Shadows.h
+	PERM_BAKED			= 1 << 7,	// BAKED, ambient occlusion and sun visibility from the vertices, see LightBaker.h
+	PERM_ALL			= (1 << 8) - 1,
+
+	// What the old hand written pixel shaders were.
+	PERM_LIT			= PERM_NORMAL_MAP | PERM_DIR_LIGHT | PERM_POINT_LIGHT | PERM_SPOT_LIGHT,	// PS
+	PERM_SOLID			= PERM_REFLECTION,															// PSSolid
+	PERM_NO_LIGHTS		= 0,																		// PSNoLights
+};
+
+// Drops bits that don't change the compiled code, so equal shaders share one key.
+inline uint32_t CanonicalPermutation(uint32_t key)
+{
+	key &= PERM_ALL;
+	if (key & PERM_REFLECTION)
+		return PERM_REFLECTION;
+	if (key & PERM_CLUSTERED)
+		key &= ~(PERM_POINT_LIGHT | PERM_SPOT_LIGHT);
+	// Only the directional and spot lights have shadow maps.
+	if (!(key & (PERM_DIR_LIGHT | PERM_SPOT_LIGHT | PERM_CLUSTERED)))
+		key &= ~PERM_SHADOWS;
+	// Normal mapping only feeds the lighting.
+	if (!(key & (PERM_DIR_LIGHT | PERM_POINT_LIGHT | PERM_SPOT_LIGHT | PERM_CLUSTERED)))
+		return 0;
+	return key;
+}
+
+// Every macro is always defined, "NAME=VALUE;" pairs in a fixed order, so the string doubles as a cache key.
+inline std::string PermutationDefines(uint32_t key)
+{
+	key = CanonicalPermutation(key);
+	std::string defines;
+	defines += (key & PERM_NORMAL_MAP) ? "NORMAL_MAP=1;" : "NORMAL_MAP=0;";
+	defines += (key & PERM_DIR_LIGHT) ? "NUM_DIR_LIGHTS=1;" : "NUM_DIR_LIGHTS=0;";
+	defines += (key & PERM_POINT_LIGHT) ? "NUM_POINT_LIGHTS=1;" : "NUM_POINT_LIGHTS=0;";
+	defines += (key & PERM_SPOT_LIGHT) ? "NUM_SPOT_LIGHTS=1;" : "NUM_SPOT_LIGHTS=0;";
+	defines += (key & PERM_REFLECTION) ? "REFLECTION=1;" : "REFLECTION=0;";
+	defines += (key & PERM_CLUSTERED) ? "CLUSTERED=1;" : "CLUSTERED=0;";
+	defines += (key & PERM_SHADOWS) ? "SHADOWS=1;" : "SHADOWS=0;";
+	defines += (key & PERM_BAKED) ? "BAKED=1;" : "BAKED=0;";
+	return defines;
+}
+
+// Every distinct variant, for filling the shader cache offline.
+inline std::vector<uint32_t> AllPermutations()
+{
+	std::vector<uint32_t> keys;
+	for (uint32_t key = 0; key <= PERM_ALL; key++)
+	{
+		if (CanonicalPermutation(key) == key)
+			keys.push_back(key);
+	}
+	return keys;
+}
+
+// Splits "A=1;B=0;" back into name/value pairs for the compiler.
+inline std::vector<std::pair<std::string, std::string>> ParseDefines(const std::string& defines)
+{
+	std::vector<std::pair<std::string, std::string>> pairs;
+	size_t at = 0;
+	while (at < defines.size())
+	{
+		size_t end = defines.find(';', at);
+		if (end == std::string::npos)
+			end = defines.size();
+		std::string pair = defines.substr(at, end - at);
+		size_t eq = pair.find('=');
+		if (!pair.empty())
+			pairs.push_back(eq == std::string::npos ? std::make_pair(pair, std::string("1")) : std::make_pair(pair.substr(0, eq), pair.substr(eq + 1)));
+		at = end + 1;
+	}
+	return pairs;
+}
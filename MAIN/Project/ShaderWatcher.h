@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Watches one directory (not its sub folders) on a background thread and remembers which files changed.
+// Windows uses a change notification handle, which doesn't say which file it was, so those come back as "".
+// Linux uses inotify and reports the file name. Poll from the frame loop and react at a frame boundary.
+class ShaderWatcher
+{
+	std::thread thread;
+	std::atomic<bool> running;
+	std::mutex lock;
+	std::vector<std::string> changed;
+
+	void Changed(const std::string& file)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		for (const std::string& f : changed)
+		{
+			if (f == file)
+				return;
+		}
+		changed.push_back(file);
+	}
+
+#ifdef _WIN32
+	void Watch(std::string directory)
+	{
+		HANDLE handle = FindFirstChangeNotificationA(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+		if (handle == INVALID_HANDLE_VALUE)
+			return;
+		while (running)
+		{
+			// Wake up every so often to see if we've been stopped.
+			if (WaitForSingleObject(handle, 100) == WAIT_OBJECT_0)
+			{
+				Changed("");
+				FindNextChangeNotification(handle);
+			}
+		}
+		FindCloseChangeNotification(handle);
+	}
+#else
+	void Watch(std::string directory)
+	{
+		int fd = inotify_init1(IN_NONBLOCK);
+		if (fd < 0)
+			return;
+		// Editors either write in place or write a temp file and move it over the original.
+		if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+		{
+			close(fd);
+			return;
+		}
+		char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+		while (running)
+		{
+			pollfd p = { fd, POLLIN, 0 };
+			if (::poll(&p, 1, 100) <= 0)
+				continue;
+			ssize_t size = read(fd, buffer, sizeof(buffer));
+			for (char* at = buffer; size > 0 && at < buffer + size;)
+			{
+				const inotify_event* e = reinterpret_cast<const inotify_event*>(at);
+				if (e->len > 0)
+					Changed(e->name);
+				at += sizeof(inotify_event) + e->len;
+			}
+		}
+		close(fd);
+	}
+#endif
+
+public:
+	ShaderWatcher() : running(false) {}
+	~ShaderWatcher() { Stop(); }
+
+	void Start(const std::string& directory)
+	{
+		Stop();
+		running = true;
+		thread = std::thread(&ShaderWatcher::Watch, this, directory);
+	}
+
+	void Stop()
+	{
+		running = false;
+		if (thread.joinable())
+			thread.join();
+	}
+
+	// Files changed since the last call, empties the list.
+	std::vector<std::string> Poll()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		std::vector<std::string> files;
+		files.swap(changed);
+		return files;
+	}
+};
@@ -15,12 +15,48 @@ cbuffer ConstantBuffer : register(b0) // b for constant buffers
     float4 spotLightPos;
     float time;
     float cone;
+    float bakedSun; // How much of the baked sun visibility to use, 0 when the sun isn't where it was baked
 }
 
 cbuffer UniqueBuffer : register(b1) // Definitly unncessary use here.
 {
     float4 timePos;
 }
+
+// Clustered lights, filled by ClusteredLightBinner once per view (see ClusteredLighting.h).
+cbuffer ClusterBuffer : register(b2)
+{
+    float4 clusterScale; // Tiles in x and y, slice scale and bias for log(view z)
+    uint4 clusterDims; // Tiles in x and y, slices, light count
+}
+Buffer<float4> clusterLights : register(t3); // Three per light: position & range, color & spot cosine, spot direction
+Buffer<uint2> clusterRanges : register(t4); // Offset and count into clusterIndices, per cluster
+Buffer<uint> clusterIndices : register(t5);
+
+// Shadow maps, fitted by CascadedShadowMaps once per frame (see Shadows.h). The atlas is a 2x2 grid of tiles,
+// the directional light's cascades first and the spot light's map in the last one.
+cbuffer ShadowBuffer : register(b3)
+{
+    matrix shadowMaps[4]; // World to tile uv and depth
+    float4 shadowParams; // Atlas texel size, tile texel size, depth bias
+    uint4 shadowInfo; // Cascade count, clustered index of the shadowed spot light, spot map valid
+}
+Texture2D shadowAtlas : register(t6);
+SamplerComparisonState samShadow : register(s1);
+
+// Dynamic resolution, the frame is drawn into the top left corner of txDiffuse and stretched over the back buffer.
+cbuffer UpscaleBuffer : register(b4)
+{
+    float4 upscaleRect; // uv scale of the rendered corner, largest uv still inside it
+}
+SamplerState samClamp : register(s2);
+
+// The procedural grid's size, see ProceduralGrid.h.
+cbuffer GridBuffer : register(b5)
+{
+    uint gridResolution; // Points along each side
+    float gridSpacing; // Between neighbouring points
+}
 //--------------------------------------------------------------------------------------
 
 struct VS_INPUT
@@ -37,13 +73,52 @@ struct PS_INPUT
     float3 Norm : NORMAL;
     float3 Tang : TANGENT;
     float2 Tex : TEXCOORD1;
+    float2 Baked : TEXCOORD3; // Ambient occlusion and sun visibility, 1 where nothing was baked
+};
+
+struct SKY_PS_INPUT
+{
+    float4 Pos : SV_POSITION;
+    float4 Ray : TEXCOORD0; // Homogeneous, divided per pixel
+};
+
+// Mesh drawn instanced, the first instance is the mesh itself and the rest are the little rocks.
+struct INSTANCED_VS_INPUT
+{
+    float4 Pos : POSITION;
+    float3 Norm : NORMAL;
+    float2 Tex : TEXCOORD0;
+    float2 Baked : BAKED;
+    float4 OffsetScale : INSTANCE; // xyz offset, w scale. Applied in world space.
 };
 
-struct SKYBOX_VS_INPUT
+struct INSTANCED_PS_INPUT
 {
     float4 Pos : SV_POSITION;
+    float4 worldPos : POSITION;
     float3 Norm : NORMAL;
-    float3 Tex : TEXCOORD2;
+    float3 Tang : TANGENT;
+    float2 Tex : TEXCOORD1;
+    float2 Baked : TEXCOORD3;
+    float Clip : SV_ClipDistance0; // Last so the pixel shaders can keep taking PS_INPUT
+};
+
+struct DEPTH_VS_INPUT
+{
+    float4 Pos : POSITION;
+    float4 OffsetScale : INSTANCE;
+};
+
+struct DEPTH_PS_INPUT
+{
+    float4 Pos : SV_POSITION;
+    float Clip : SV_ClipDistance0;
+};
+
+struct FULLSCREEN_PS_INPUT
+{
+    float4 Pos : SV_POSITION;
+    float2 Tex : TEXCOORD0;
 };
 
 //--------------------------------------------------------------------------------------
@@ -59,6 +134,7 @@ PS_INPUT VS(VS_INPUT input)
     output.Norm = mul(float4(input.Norm, 1), World).xyz;
     output.Tang = mul(input.Pos, World);
     output.Tex = input.Tex;
+    output.Baked = 1.0f;
     return output;
 }
 
@@ -73,96 +149,93 @@ PS_INPUT VSWave(VS_INPUT input)
     output.Norm = mul(float4(input.Norm, 1), World).xyz;
     output.Tang = mul(input.Pos, World);
     output.Tex = input.Tex;
+    output.Baked = 1.0f;
     return output;
 }
 
-SKYBOX_VS_INPUT SKYBOX_VS(SKYBOX_VS_INPUT input)
+// Grid lines out of nothing but the vertex id, drawn as a line list with no vertex buffer. Segments along z from
+// every point but the last row come first, then along x from every point but the last column. GridVertex in
+// ProceduralGrid.h is the same thing in C++.
+PS_INPUT GridVS(uint id : SV_VertexID)
 {
-    SKYBOX_VS_INPUT output = (SKYBOX_VS_INPUT) 0;
-    output.Pos = mul(float4(input.Pos.x, input.Pos.y, input.Pos.z, 1.0f), World).xyww;
-    
-    output.Tex = input.Pos;
-    return output;
-}
-
-//--------------------------------------------------------------------------------------
-// Geometry Shaders
-//--------------------------------------------------------------------------------------
-#define triCountOut 12
-[maxvertexcount(triCountOut)]
-void GS(triangle PS_INPUT input[3], inout TriangleStream<PS_INPUT> output)
-{
-    PS_INPUT simple[triCountOut];
-    simple[0] = input[0];
-    simple[1] = input[1];
-    simple[2] = input[2];
-    
-    // Set everything other than the 'base' to the 'base'
-    for (int i = 3; i < triCountOut; i += 3)
-    {
-        simple[i] = simple[0];
-        simple[i].Pos = simple[0].worldPos; // Set the position to the world so we can make it stay stationary.
-        simple[i + 1] = simple[1];
-        simple[i + 1].Pos = simple[1].worldPos;
-        simple[i + 2] = simple[2];
-        simple[i + 2].Pos = simple[2].worldPos;
-    }
-
-    // First Little rock.
-    for (int x = 3; x < 6; x++)
-    {
-        // Scale
-        simple[x].Pos.x *= 0.25f;
-        simple[x].Pos.y *= 0.25f;
-        simple[x].Pos.z *= 0.25f;
-        // Movement
-        simple[x].Pos.x += 0.85f;
-        simple[x].Pos.y -= 0.2f;
-        simple[x].Pos.z += 0.5f;
-    }
-    
-    // Second Little rock.
-    for (int x = 6; x < 9; x++)
-    {
-        // Scale
-        simple[x].Pos.x *= 0.25f;
-        simple[x].Pos.y *= 0.25f;
-        simple[x].Pos.z *= 0.25f;
-        // Movement
-        simple[x].Pos.x -= 0.75f;
-        simple[x].Pos.y -= 0.25;
-        simple[x].Pos.z -= 0.5f;
-    }
-    
-    // Third Little rock.
-    for (int x = 9; x < 12; x++)
+    uint segment = id >> 1, end = id & 1;
+    uint alongZ = gridResolution * (gridResolution - 1);
+    uint x, z;
+    if (segment < alongZ)
     {
-        // Scale
-        simple[x].Pos.x *= 0.0625f;
-        simple[x].Pos.y *= 0.0625f;
-        simple[x].Pos.z *= 0.0625f;
-        // Movement
-        simple[x].Pos.x += 0.05f;
-        simple[x].Pos.y += 0.27f;
-        simple[x].Pos.z += 0.05f;
+        x = segment % gridResolution;
+        z = segment / gridResolution + end;
     }
-    
-    // Loop through and append everything to the stream.
-    for (int z = 0; z < triCountOut; z++)
+    else
     {
-        if(z >= 3) // Render the mesh 'normally' since we're using the mesh itself as the base, then restart the output strip and redo the points here.
-        {
-            if (fmod(z, 3) == 0 || simple[z].Pos.y < -0.1f) // Every three vertices, cut the output.
-            {
-                output.RestartStrip();
-            }
-            simple[z].Pos = mul(simple[z].Pos, View);
-            simple[z].Pos = mul(simple[z].Pos, Projection);  
-        }
-        output.Append(simple[z]);
+        segment -= alongZ;
+        x = segment % (gridResolution - 1) + end;
+        z = segment / (gridResolution - 1);
     }
+    float middle = (float) (gridResolution / 2);
+
+    VS_INPUT input = (VS_INPUT) 0;
+    input.Pos = float4(((float) x - middle) * gridSpacing, 0.0f, ((float) z - middle) * gridSpacing, 1.0f);
+    return VSWave(input);
+}
+
+// Scale & move the world position the way the old rock geometry shader did, then project.
+// Shared by VSInstanced and VSDepth so the depth pre-pass produces bit-identical depth for the EQUAL test.
+float4 InstanceToClip(float4 pos, float4 offsetScale, out float clipDist)
+{
+    float4 worldPos = mul(pos, World);
+    worldPos.xyz = worldPos.xyz * offsetScale.w + offsetScale.xyz;
+    // The rocks get cut off below the ground, the mesh itself never does.
+    clipDist = (offsetScale.w < 1.0f) ? worldPos.y + 0.1f : 1.0f;
+    worldPos = mul(worldPos, View);
+    worldPos = mul(worldPos, Projection);
+    return worldPos;
+}
+
+INSTANCED_PS_INPUT VSInstanced(INSTANCED_VS_INPUT input)
+{
+    INSTANCED_PS_INPUT output = (INSTANCED_PS_INPUT) 0;
+    output.Pos = InstanceToClip(input.Pos, input.OffsetScale, output.Clip);
+    // Lighting uses the un-moved surface, same as the copies the geometry shader made.
+    output.worldPos = mul(input.Pos, World);
+    output.Norm = mul(float4(input.Norm, 1), World).xyz;
+    output.Tang = mul(input.Pos, World);
+    output.Tex = input.Tex;
+    output.Baked = input.Baked;
+    return output;
+}
+
+// Position only, used for the depth pre-pass with no pixel shader bound.
+DEPTH_PS_INPUT VSDepth(DEPTH_VS_INPUT input)
+{
+    DEPTH_PS_INPUT output = (DEPTH_PS_INPUT) 0;
+    output.Pos = InstanceToClip(input.Pos, input.OffsetScale, output.Clip);
+    return output;
+}
+
+// The sky as one triangle on the far plane, made from SV_VertexID like FullscreenVS. World holds the inverse of
+// the view's rotation times its projection, so each corner unprojects to the direction it looks in.
+SKY_PS_INPUT SkyVS(uint id : SV_VertexID)
+{
+    SKY_PS_INPUT output;
+    float2 uv = float2((id << 1) & 2, id & 2);
+    output.Pos = float4(uv * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 1.0f, 1.0f);
+    output.Ray = mul(output.Pos, World);
+    return output;
+}
+
+// One triangle covering the whole viewport, drawn with no vertex buffer or input layout.
+FULLSCREEN_PS_INPUT FullscreenVS(uint id : SV_VertexID)
+{
+    FULLSCREEN_PS_INPUT output;
+    output.Tex = float2((id << 1) & 2, id & 2);
+    output.Pos = float4(output.Tex * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+    return output;
 }
 
+//--------------------------------------------------------------------------------------
+// Geometry Shaders
+//--------------------------------------------------------------------------------------
 [maxvertexcount(2)]
 void GSWave(line PS_INPUT input[2], inout LineStream<PS_INPUT> output) // Unused, but kept in here for reference and experimentation.
 {
@@ -188,86 +261,207 @@ worldPos;
 //--------------------------------------------------------------------------------------
 // Pixel Shaders
 //--------------------------------------------------------------------------------------
-float4 PS(PS_INPUT input) : SV_Target
+// Feature macros, set per variant by the permutation system (ShaderPermutations.h).
+// Defaults give the fully lit mesh shader when compiled on its own.
+#ifndef NORMAL_MAP
+#define NORMAL_MAP 1
+#endif
+#ifndef NUM_DIR_LIGHTS
+#define NUM_DIR_LIGHTS 1
+#endif
+#ifndef NUM_POINT_LIGHTS
+#define NUM_POINT_LIGHTS 1
+#endif
+#ifndef NUM_SPOT_LIGHTS
+#define NUM_SPOT_LIGHTS 1
+#endif
+#ifndef REFLECTION
+#define REFLECTION 0
+#endif
+#ifndef CLUSTERED
+#define CLUSTERED 0
+#endif
+#ifndef SHADOWS
+#define SHADOWS 0
+#endif
+#ifndef BAKED
+#define BAKED 0
+#endif
+
+#if SHADOWS
+#define SHADOW_SPOT_MAP 3
+
+// Where worldPos lands in shadow map i, false if it's outside the map (or too close to the edge for the filter).
+bool ShadowCoord(uint i, float4 worldPos, out float3 coord)
+{
+    float4 p = mul(worldPos, shadowMaps[i]);
+    coord = p.xyz / p.w;
+    float margin = 2.0f * shadowParams.y;
+    bool inside = all(coord.xy > margin) && all(coord.xy < 1.0f - margin) && coord.z < 1.0f && p.w > 0.0f;
+    coord.xy = (coord.xy + float2(i & 1, i >> 1)) * 0.5f;
+    return inside;
+}
+
+// 3x3 percentage closer filter, every tap is already a bilinear 2x2 compare. 1 is fully lit.
+float ShadowPCF(float3 coord)
+{
+    float lit = 0;
+    [unroll]
+    for (int y = -1; y <= 1; y++)
+    {
+        [unroll]
+        for (int x = -1; x <= 1; x++)
+            lit += shadowAtlas.SampleCmpLevelZero(samShadow, coord.xy + float2(x, y) * shadowParams.x, coord.z - shadowParams.z);
+    }
+    return lit / 9.0f;
+}
+
+// First cascade that covers the position, so any view can use the cascades fitted to the main camera.
+float CascadeShadow(float4 worldPos)
+{
+    float3 coord;
+    for (uint i = 0; i < shadowInfo.x; i++)
+    {
+        if (ShadowCoord(i, worldPos, coord))
+            return ShadowPCF(coord);
+    }
+    return 1.0f;
+}
+
+float SpotShadow(float4 worldPos)
+{
+    float3 coord;
+    if (shadowInfo.z == 0 || !ShadowCoord(SHADOW_SPOT_MAP, worldPos, coord))
+        return 1.0f;
+    return ShadowPCF(coord);
+}
+#endif
+
+#if CLUSTERED
+// Lights every clustered light that reaches the surface. The cluster is found from the lit position itself
+// rather than the pixel, so the rocks (drawn moved, lit unmoved) still look up the lights around what they light.
+float4 ClusteredLighting(float4 worldPos, float3 norm)
+{
+    float4 color = 0;
+    float4 viewPos = mul(worldPos, View);
+    float4 clipPos = mul(viewPos, Projection);
+    float2 ndc = clipPos.xy / clipPos.w;
+    int3 cell;
+    cell.xy = (int2) floor(float2(ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f) * clusterScale.xy);
+    cell.z = (int) floor(log(max(viewPos.z, 0.000001f)) * clusterScale.z + clusterScale.w);
+    cell = clamp(cell, 0, (int3) clusterDims.xyz - 1);
+    uint2 range = clusterRanges[(cell.z * clusterDims.y + cell.y) * clusterDims.x + cell.x];
+    
+    for (uint i = 0; i < range.y; i++)
+    {
+        uint light = clusterIndices[range.x + i] * 3;
+        float4 posRange = clusterLights[light];
+        float4 colorCos = clusterLights[light + 1];
+        float3 spotDir = clusterLights[light + 2].xyz;
+        
+        float3 toLight = posRange.xyz - worldPos.xyz;
+        float dist = length(toLight);
+        toLight /= max(dist, 0.0001f);
+        float atten = saturate(1.0f - dist / posRange.w);
+        atten *= atten;
+        // Point lights have a cosine of -1, the whole sphere is inside their "cone".
+        float spot = (colorCos.w <= -1.0f) ? 1.0f : smoothstep(colorCos.w, colorCos.w + 0.05f, dot(-toLight, spotDir));
+#if SHADOWS
+        if (light / 3 == shadowInfo.y && spot > 0.0f)
+            spot *= SpotShadow(worldPos);
+#endif
+        color.rgb += saturate(dot(toLight, norm)) * colorCos.rgb * atten * spot;
+    }
+    return color;
+}
+#endif
+
+// One pixel shader for the mesh, the solid reflective cubes, and the plain textured RTT cube.
+float4 PSPermutation(PS_INPUT input) : SV_Target
 {
+#if REFLECTION
+    float4 finalColor = vOutputColor;
+    float4 refColor = skybox.Sample(samLinear, input.Tang);
+    return finalColor * refColor;
+#elif (NUM_DIR_LIGHTS + NUM_POINT_LIGHTS + NUM_SPOT_LIGHTS + CLUSTERED) == 0
+    return txDiffuse.Sample(samLinear, input.Tex);
+#else
     // Have this value up to 0.075f for some ambient light.
     float4 finalColor = 0.050f;
+#if BAKED
+    // Occlusion keeps the crevices dark, so the sky can be brighter than the flat term.
+    finalColor = 0.15f * input.Baked.x;
+#endif
         
-    // Normal Map
-    if (abs(input.Norm[0]) > 0)
-    {
-        float4 normMap = nrmMap.Sample(samLinear, input.Tex);
+#if NORMAL_MAP
+    float4 normMap = nrmMap.Sample(samLinear, input.Tex);
         
-        normMap = (2.0f * normMap) - 1.0f;
+    normMap = (2.0f * normMap) - 1.0f;
         
-        input.Tang = normalize(input.Tang - dot(input.Tang, input.Norm) * input.Norm);
+    input.Tang = normalize(input.Tang - dot(input.Tang, input.Norm) * input.Norm);
         
-        float3 tan = cross(input.Norm, input.Tang);
+    float3 tan = cross(input.Norm, input.Tang);
         
-        float3x3 texSpace = float3x3(input.Tang, tan, input.Norm);
+    float3x3 texSpace = float3x3(input.Tang, tan, input.Norm);
         
-        input.Norm = normalize(mul(normMap, texSpace));
-    }
-    
+    input.Norm = normalize(mul(normMap, texSpace));
+#endif
     
-    // Apply Lighting
-    for (int i = 0; i < 3; i++)
+    // Apply Lighting, slots are fixed: 0 directional, 1 point, 2 spot.
+#if NUM_DIR_LIGHTS
+    // Directional Lighting
+    float4 sunColor = saturate(dot((float3) vLightDir[0], input.Norm) * vLightColor[0]);
+#if SHADOWS
+    sunColor *= CascadeShadow(input.worldPos);
+#elif BAKED
+    sunColor *= lerp(1.0f, input.Baked.y, bakedSun);
+#endif
+    finalColor += sunColor;
+#endif
+#if NUM_POINT_LIGHTS
+    // Point Lighting
     {
-        // Directional Lighting
-        if(i == 0)
-        {
-            finalColor += saturate(dot((float3) vLightDir[i], input.Norm) * vLightColor[i]);
-        }
-        // Point Lighting
-        else if (i == 1)
-        {
-            float4 lightDir = normalize(vLightDir[i] - input.worldPos);
-            float distance = length(lightDir);
+        float4 lightDir = normalize(vLightDir[1] - input.worldPos);
+        float distance = length(lightDir);
             
-            // Apply the point light to the color if within range.
-            if (distance <= 1.0f)
-            {
-                finalColor += saturate(dot((float3) lightDir, input.Norm) * vLightColor[i]);
-            }
-        }
-        // Spot Light
-        else if (i == 2)
+        // Apply the point light to the color if within range.
+        if (distance <= 1.0f)
         {
-            float4 lightDir = normalize(spotLightPos - input.worldPos); // Light direction.
-            float surfaceratio = saturate(dot(lightDir, vLightDir[i]));
-            float coneRatio = cone / 25.0f;
-            int spotfactor = (surfaceratio > coneRatio) ? 1 : 0; // Hardcoded cone ratio <- bad me
-            float distance = length(lightDir);
-            float lightRatio = saturate(dot((float3) lightDir, input.Norm));
+            finalColor += saturate(dot((float3) lightDir, input.Norm) * vLightColor[1]);
+        }
+    }
+#endif
+#if NUM_SPOT_LIGHTS
+    // Spot Light
+    {
+        float4 lightDir = normalize(spotLightPos - input.worldPos); // Light direction.
+        float surfaceratio = saturate(dot(lightDir, vLightDir[2]));
+        float coneRatio = cone / 25.0f;
+        int spotfactor = (surfaceratio > coneRatio) ? 1 : 0; // Hardcoded cone ratio <- bad me
+        float lightRatio = saturate(dot((float3) lightDir, input.Norm));
             
-            // For Attenuation
-            float innerConeRatio = (cone + 0.25f) / 25.0f;
-            float atten = 1.0f - saturate((innerConeRatio - surfaceratio) / (innerConeRatio - coneRatio));
+        // For Attenuation
+        float innerConeRatio = (cone + 0.25f) / 25.0f;
+        float atten = 1.0f - saturate((innerConeRatio - surfaceratio) / (innerConeRatio - coneRatio));
             
-            // Apply the spotlight color.
-            finalColor += saturate(spotfactor * lightRatio * vLightColor[i] * finalColor * atten);
-        }
+#if SHADOWS
+        if (spotfactor)
+            atten *= SpotShadow(input.worldPos);
+#endif
+
+        // Apply the spotlight color.
+        finalColor += saturate(spotfactor * lightRatio * vLightColor[2] * finalColor * atten);
     }
+#endif
+#if CLUSTERED
+    // Any number of point and spot lights, the point and spot slots above are off in these variants.
+    finalColor += ClusteredLighting(input.worldPos, input.Norm);
+#endif
     
     finalColor *= txDiffuse.Sample(samLinear, input.Tex);
     finalColor.a = 1;
     return finalColor;
-    
-    //return txDiffuse.Sample(samLinear, input.Tex) * vOutputColor;
-}
-
-float4 PSSolid(PS_INPUT input) : SV_Target
-{
-    float4 finalColor = vOutputColor;
-    float4 refColor = skybox.Sample(samLinear, input.Tang);
-    return finalColor * refColor;
-}
-
-float4 PSNoLights(PS_INPUT input) : SV_Target
-{    
-    //float2 UV = { 0.5076, .5276 };
-    float4 color = txDiffuse.Sample(samLinear, input.Tex);
-    return color;
+#endif
 }
 
 // Create a pulsation on the color w/ color change on position.
@@ -286,12 +480,14 @@ float4 PSUnique(PS_INPUT input) : SV_Target
     return color;
 }
 
-// SKYBOX PS
-float4 SKYBOX_PS(SKYBOX_VS_INPUT input) : SV_Target
-{    
-    //finalColor *= txDiffuse.Sample(samLinear, input.Tex);
-    
-    //return finalColor;
-    return vOutputColor * skybox.Sample(samLinear, input.Tex);
-    //return vOutputColor;
-}
\ No newline at end of file
+// Sky PS
+float4 SkyPS(SKY_PS_INPUT input) : SV_Target
+{
+    return vOutputColor * skybox.Sample(samLinear, input.Ray.xyz / input.Ray.w);
+}
+
+// Stretches the dynamic resolution frame over the back buffer, clamped so the filter never reaches past what was drawn.
+float4 UpscalePS(FULLSCREEN_PS_INPUT input) : SV_Target
+{
+    return txDiffuse.Sample(samClamp, min(input.Tex * upscaleRect.xy, upscaleRect.zw));
+}
@@ -0,0 +1,167 @@
+#include "Shadows.h"
+
+#include <cstdio>
+
+// Checks the CPU side of the cascaded shadow maps: the splits, that each cascade holds its whole slice of the
+// camera frustum, that cascades only move in whole texels, and that casters between the light and a cascade
+// are kept. Needs nothing but DirectXMath.
+// ShadowCheck   no arguments.
+
+static const XMVECTOR towardLight = XMVector3Normalize(XMVectorSet(-1.0f, 2.0f, -0.5f, 0.0f));
+
+static XMMATRIX CameraView(FXMVECTOR eye)
+{
+	return XMMatrixLookToLH(eye, XMVector3Normalize(XMVectorSet(0.3f, -0.35f, 1.0f, 0.0f)), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+}
+
+static XMMATRIX CameraProjection()
+{
+	return XMMatrixPerspectiveFovLH(XM_PIDIV2, 800.0f / 600.0f, 0.01f, 100.0f);
+}
+
+// Light space center of a cascade's box, from its projection.
+static XMVECTOR MapCenter(const ShadowMap& m)
+{
+	XMVECTOR det;
+	return XMVector3TransformCoord(XMVectorSet(0.0f, 0.0f, 0.5f, 1.0f), XMMatrixInverse(&det, m.projection));
+}
+
+static bool CheckSplits()
+{
+	bool ok = true;
+	const float ranges[][2] = { { 0.01f, 20.0f }, { 0.1f, 100.0f }, { 1.0f, 1000.0f } };
+	for (const float* range : ranges)
+	{
+		for (unsigned int count = 1; count <= SHADOW_MAX_CASCADES; count++)
+		{
+			for (float lambda : { 0.0f, 0.5f, 0.8f, 1.0f })
+			{
+				float splits[SHADOW_MAX_CASCADES + 1];
+				ComputeCascadeSplits(range[0], range[1], count, lambda, splits);
+				bool good = splits[0] == range[0] && splits[count] == range[1];
+				for (unsigned int i = 0; i < count; i++)
+					good &= splits[i] < splits[i + 1];
+				if (!good)
+					printf("splits  %g to %g, %u cascades, lambda %g: NOT MONOTONIC or wrong ends\n", range[0], range[1], count, lambda);
+				ok &= good;
+			}
+		}
+	}
+	printf("splits     monotonic from near to far: %s\n", ok ? "ok" : "FAILED");
+	return ok;
+}
+
+// Every corner of every slice has to be inside its cascade's sphere and box. Snapping moves the box by less than a
+// texel, so that's the slack allowed across the light; along it nothing is snapped.
+static bool CheckSlices(const CascadedShadowMaps& shadows, FXMMATRIX view, CXMMATRIX projection)
+{
+	XMFLOAT4X4 p;
+	XMStoreFloat4x4(&p, projection);
+	float tanX = 1.0f / p._11, tanY = 1.0f / p._22;
+	XMVECTOR det;
+	XMMATRIX camera = XMMatrixInverse(&det, view);
+
+	bool ok = true;
+	for (unsigned int i = 0; i < shadows.CascadeCount(); i++)
+	{
+		const ShadowMap& m = shadows.Map(i);
+		float texel = 2.0f * m.radius / shadows.TileSize();
+		XMVECTOR center = MapCenter(m);
+		float worst = 0.0f;
+		for (int c = 0; c < 8; c++)
+		{
+			float z = (c & 4) ? m.splitFar : m.splitNear;
+			XMVECTOR corner = XMVectorSet((c & 1 ? 1.0f : -1.0f) * tanX * z, (c & 2 ? 1.0f : -1.0f) * tanY * z, z, 1.0f);
+			XMVECTOR light = XMVector3TransformCoord(XMVector3TransformCoord(corner, camera), m.view);
+			float d = XMVectorGetX(XMVector3Length(XMVectorSubtract(light, center)));
+			worst = fmaxf(worst, d / m.radius);
+			XMFLOAT3 ndc;
+			XMStoreFloat3(&ndc, XMVector3TransformCoord(light, m.projection));
+			float slack = 1.0f + 2.0f / shadows.TileSize();
+			if (d > m.radius + 1.5f * texel || fabsf(ndc.x) > slack || fabsf(ndc.y) > slack || ndc.z < -1e-4f || ndc.z > 1.0001f)
+				ok = false;
+		}
+		printf("cascade %u  %6.3f to %6.3f, radius %6.3f, farthest corner %.3f of it: %s\n", i, m.splitNear, m.splitFar, m.radius,
+			worst, ok ? "inside" : "OUTSIDE");
+	}
+	return ok;
+}
+
+// Moving the camera must move every cascade by whole texels and never change its size.
+static bool CheckSnapping()
+{
+	CascadedShadowMaps shadows;
+	XMVECTOR eye = XMVectorSet(3.0f, 4.0f, -10.0f, 1.0f);
+	shadows.FitCascades(CameraView(eye), CameraProjection(), 0.01f, 100.0f, towardLight);
+	float radius[SHADOW_MAX_CASCADES];
+	XMFLOAT3 first[SHADOW_MAX_CASCADES];
+	for (unsigned int i = 0; i < shadows.CascadeCount(); i++)
+	{
+		radius[i] = shadows.Map(i).radius;
+		XMStoreFloat3(&first[i], MapCenter(shadows.Map(i)));
+	}
+
+	bool ok = true;
+	float worst = 0.0f;
+	for (int step = 1; step <= 200; step++)
+	{
+		XMVECTOR moved = XMVectorAdd(eye, XMVectorSet(0.0137f * step, -0.0071f * step, 0.0291f * step, 0.0f));
+		shadows.FitCascades(CameraView(moved), CameraProjection(), 0.01f, 100.0f, towardLight);
+		for (unsigned int i = 0; i < shadows.CascadeCount(); i++)
+		{
+			const ShadowMap& m = shadows.Map(i);
+			float texel = 2.0f * m.radius / shadows.TileSize();
+			XMFLOAT3 center;
+			XMStoreFloat3(&center, MapCenter(m));
+			float dx = (center.x - first[i].x) / texel, dy = (center.y - first[i].y) / texel;
+			float off = fmaxf(fabsf(dx - roundf(dx)), fabsf(dy - roundf(dy)));
+			worst = fmaxf(worst, off);
+			ok &= m.radius == radius[i] && off < 0.01f;
+		}
+	}
+	printf("snapping   200 camera moves, worst %.4f of a texel off the grid, sizes unchanged: %s\n", worst, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+// A caster far up toward the light, past the cascade's near plane, still shadows it; one off to the side doesn't.
+static bool CheckCasterCulling(const CascadedShadowMaps& shadows)
+{
+	const ShadowMap& m = shadows.Map(0);
+	XMVECTOR det;
+	XMMATRIX lightToWorld = XMMatrixInverse(&det, m.view);
+	XMVECTOR center = XMVector3TransformCoord(MapCenter(m), lightToWorld);
+
+	FrustumCuller casters;
+	CullSphere s;
+	s.radius = 0.5f;
+	XMStoreFloat3(&s.center, XMVectorMultiplyAdd(towardLight, XMVectorReplicate(m.radius + 50.0f), center));
+	unsigned int between = casters.AddSphere(s);
+	XMStoreFloat3(&s.center, XMVectorAdd(center, XMVector3TransformNormal(XMVectorSet(m.radius + 5.0f, 0.0f, 0.0f, 0.0f), lightToWorld)));
+	unsigned int aside = casters.AddSphere(s);
+
+	std::vector<unsigned int> visible;
+	shadows.CullCasters(casters, 0, visible);
+	bool keptBetween = false, keptAside = false;
+	for (unsigned int v : visible)
+	{
+		keptBetween |= v == between;
+		keptAside |= v == aside;
+	}
+	bool ok = keptBetween && !keptAside;
+	printf("casters    between the light and cascade 0 %s, beside it %s: %s\n", keptBetween ? "kept" : "culled",
+		keptAside ? "kept" : "culled", ok ? "ok" : "FAILED");
+	return ok;
+}
+
+int main()
+{
+	bool ok = CheckSplits();
+
+	CascadedShadowMaps shadows;
+	XMMATRIX view = CameraView(XMVectorSet(3.0f, 4.0f, -10.0f, 1.0f));
+	shadows.FitCascades(view, CameraProjection(), 0.01f, 100.0f, towardLight);
+	ok &= CheckSlices(shadows, view, CameraProjection());
+	ok &= CheckSnapping();
+	ok &= CheckCasterCulling(shadows);
+	return ok ? 0 : 1;
+}
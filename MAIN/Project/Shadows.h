@@ -0,0 +1,188 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Culling.h"
+
+using namespace DirectX;
+
+// The shadow atlas is a 2x2 grid of square tiles, the directional light's cascades then the spot light in the last one.
+static const unsigned int SHADOW_MAX_CASCADES = 3;
+static const unsigned int SHADOW_SPOT_MAP = 3;
+static const unsigned int SHADOW_MAP_COUNT = 4;
+
+// What the pixel shader needs to look up a shadow, matches ShadowBuffer in shaders.fx.
+struct ShadowConstants
+{
+	XMMATRIX maps[SHADOW_MAP_COUNT];	// World to tile uv and depth, transposed
+	XMFLOAT4 params;					// Atlas texel size, tile texel size, depth bias, unused
+	uint32_t info[4];					// Cascade count, clustered index of the shadowed spot light, spot map valid, unused
+};
+
+// One shadow map, a light's view and projection plus where it sits in the atlas.
+struct ShadowMap
+{
+	XMMATRIX view;
+	XMMATRIX projection;
+	float splitNear = 0, splitFar = 0;	// Camera view depth the cascade covers, the spot map leaves these 0
+	float radius = 0;					// Half the width of an ortho cascade in world units
+	bool valid = false;
+};
+
+// Splits the camera's depth range for count cascades, blending logarithmic and uniform splits by lambda
+// (1 is fully logarithmic). splits gets count + 1 values, from nearP to farP.
+inline void ComputeCascadeSplits(float nearP, float farP, unsigned int count, float lambda, float* splits)
+{
+	splits[0] = nearP;
+	for (unsigned int i = 1; i <= count; i++)
+	{
+		float f = (float)i / count;
+		float logSplit = nearP * powf(farP / nearP, f);
+		float uniformSplit = nearP + (farP - nearP) * f;
+		splits[i] = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+	}
+	splits[count] = farP;
+}
+
+// Fits cascaded shadow maps for a directional light around the camera and a single map for a spot light.
+// Each cascade bounds its slice of the camera frustum with a sphere, so its size never changes as the camera turns,
+// and is moved in whole shadow texels so the edges don't shimmer when the camera moves. No device needed.
+class CascadedShadowMaps
+{
+	unsigned int cascadeCount = SHADOW_MAX_CASCADES;
+	unsigned int tileSize = 1024;
+	float lambda = 0.8f;
+	float maxDistance = 20.0f;
+	float depthBias = 0.0005f;
+	float splits[SHADOW_MAX_CASCADES + 1] = {};
+	ShadowMap maps[SHADOW_MAP_COUNT];
+
+	// Maps clip space onto a tile's uv, y flipped. Applied before the divide so it works for the spot light too.
+	static XMMATRIX ClipToTile()
+	{
+		return XMMATRIX(0.5f, 0.0f, 0.0f, 0.0f,
+			0.0f, -0.5f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.5f, 0.5f, 0.0f, 1.0f);
+	}
+
+	// A look-to matrix that doesn't fall apart when the light points straight up or down.
+	static XMMATRIX LightView(FXMVECTOR eye, FXMVECTOR direction)
+	{
+		XMVECTOR up = (fabsf(XMVectorGetY(direction)) > 0.99f) ? XMVectorSet(0, 0, 1, 0) : XMVectorSet(0, 1, 0, 0);
+		return XMMatrixLookToLH(eye, direction, up);
+	}
+
+public:
+	// maxShadowDistance caps how far from the camera the cascades reach, past it nothing is shadowed.
+	void Configure(unsigned int cascades = SHADOW_MAX_CASCADES, unsigned int resolution = 1024, float splitLambda = 0.8f, float maxShadowDistance = 20.0f)
+	{
+		cascadeCount = (cascades < 1) ? 1 : (cascades > SHADOW_MAX_CASCADES ? SHADOW_MAX_CASCADES : cascades);
+		tileSize = resolution;
+		lambda = splitLambda;
+		maxDistance = maxShadowDistance;
+	}
+
+	// view and projection are the camera's, projection a symmetric perspective one. towardLight points at the light.
+	void FitCascades(FXMMATRIX view, CXMMATRIX projection, float nearP, float farP, FXMVECTOR towardLight)
+	{
+		XMFLOAT4X4 p;
+		XMStoreFloat4x4(&p, projection);
+		// Slope of the frustum's corner edge, x and y together.
+		float tanX = 1.0f / p._11, tanY = 1.0f / p._22;
+		float k2 = tanX * tanX + tanY * tanY;
+
+		XMVECTOR det;
+		XMMATRIX camera = XMMatrixInverse(&det, view);
+		XMVECTOR eye = camera.r[3];
+		XMVECTOR forward = XMVector3Normalize(camera.r[2]);
+
+		XMMATRIX lightView = LightView(XMVectorZero(), XMVectorNegate(XMVector3Normalize(towardLight)));
+		ComputeCascadeSplits(nearP, fminf(farP, maxDistance), cascadeCount, lambda, splits);
+
+		for (unsigned int i = 0; i < cascadeCount; i++)
+		{
+			float n = splits[i], f = splits[i + 1];
+			// Smallest sphere around the slice sits on the view axis, equally far from the near and far corners.
+			float c = fminf(0.5f * (1.0f + k2) * (f + n), f);
+			float radius = sqrtf(k2 * f * f + (f - c) * (f - c));
+
+			// Snap the center to the texel grid in light space, the whole map then only ever moves in whole texels.
+			XMFLOAT3 center;
+			XMStoreFloat3(&center, XMVector3TransformCoord(XMVectorMultiplyAdd(forward, XMVectorReplicate(c), eye), lightView));
+			float texel = 2.0f * radius / tileSize;
+			center.x = floorf(center.x / texel) * texel;
+			center.y = floorf(center.y / texel) * texel;
+
+			ShadowMap& m = maps[i];
+			m.view = lightView;
+			// Casters in front of the near plane get clamped onto it by the shadow rasterizer, see CullCasters.
+			m.projection = XMMatrixOrthographicOffCenterLH(center.x - radius, center.x + radius, center.y - radius, center.y + radius,
+				center.z - radius, center.z + radius);
+			m.splitNear = n;
+			m.splitFar = f;
+			m.radius = radius;
+			m.valid = true;
+		}
+		for (unsigned int i = cascadeCount; i < SHADOW_MAX_CASCADES; i++)
+			maps[i].valid = false;
+	}
+
+	// Spot light's map covers its whole cone out to its range.
+	void FitSpot(FXMVECTOR position, FXMVECTOR direction, float spotCos, float range)
+	{
+		ShadowMap& m = maps[SHADOW_SPOT_MAP];
+		float fov = 2.0f * acosf(fmaxf(fminf(spotCos, 1.0f), -1.0f));
+		m.valid = range > 0.0f && fov > 0.0f && fov < XMConvertToRadians(170.0f);
+		if (!m.valid)
+			return;
+		m.view = LightView(position, XMVector3Normalize(direction));
+		m.projection = XMMatrixPerspectiveFovLH(fov, 1.0f, fmaxf(range * 0.005f, 0.01f), range);
+		m.radius = 0;
+		m.splitNear = m.splitFar = 0;
+	}
+
+	void DisableSpot() { maps[SHADOW_SPOT_MAP].valid = false; }
+
+	// Fills visible with the casters that can land in map i. Directional cascades drop their near plane: anything
+	// between the light and the cascade still casts into it.
+	void CullCasters(const FrustumCuller& casters, unsigned int i, std::vector<unsigned int>& visible) const
+	{
+		visible.clear();
+		if (i >= SHADOW_MAP_COUNT || !maps[i].valid)
+			return;
+		Frustum f = Frustum::FromViewProjection(maps[i].view, maps[i].projection);
+		if (i != SHADOW_SPOT_MAP)
+			f.planes[4] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1e30f);
+		casters.CullSpheres(f, visible);
+	}
+
+	// Atlas pixels of map i's tile, x y width height.
+	void TileRect(unsigned int i, unsigned int rect[4]) const
+	{
+		rect[0] = (i & 1) * tileSize;
+		rect[1] = (i >> 1) * tileSize;
+		rect[2] = rect[3] = tileSize;
+	}
+
+	// spotLight is the clustered index of the spot light the spot map belongs to, or ~0u.
+	ShadowConstants Constants(uint32_t spotLight = ~0u) const
+	{
+		ShadowConstants sc;
+		for (unsigned int i = 0; i < SHADOW_MAP_COUNT; i++)
+			sc.maps[i] = XMMatrixTranspose(maps[i].valid ? maps[i].view * maps[i].projection * ClipToTile() : XMMatrixIdentity());
+		sc.params = XMFLOAT4(0.5f / tileSize, 1.0f / tileSize, depthBias, 0.0f);
+		sc.info[0] = cascadeCount;
+		sc.info[1] = spotLight;
+		sc.info[2] = maps[SHADOW_SPOT_MAP].valid ? 1 : 0;
+		sc.info[3] = 0;
+		return sc;
+	}
+
+	const ShadowMap& Map(unsigned int i) const { return maps[i]; }
+	unsigned int CascadeCount() const { return cascadeCount; }
+	unsigned int TileSize() const { return tileSize; }
+	unsigned int AtlasSize() const { return tileSize * 2; }
+	float Split(unsigned int i) const { return splits[i]; }
+};
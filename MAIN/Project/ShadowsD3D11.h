@@ -0,0 +1,76 @@
+#pragma once
+#include "defines.h"
+#include "Shadows.h"
+#include <wrl/client.h>
+
+// Everything the shadow passes and the lit pixel shaders need beyond the atlas itself, which the render graph owns.
+class D3D11ShadowResources
+{
+	Microsoft::WRL::ComPtr<ID3D11Buffer>				constants = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11SamplerState>			comparison = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11RasterizerState>		cascadeRasterizer = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11RasterizerState>		spotRasterizer = nullptr;
+
+public:
+	// The atlas is a typeless depth texture so it can be drawn into and sampled.
+	static const DXGI_FORMAT atlasFormat = DXGI_FORMAT_R32_TYPELESS;
+
+	bool Create(ID3D11Device* dev)
+	{
+		D3D11_BUFFER_DESC bd = {};
+		bd.Usage = D3D11_USAGE_DEFAULT;
+		bd.ByteWidth = sizeof(ShadowConstants);
+		bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		if (FAILED(dev->CreateBuffer(&bd, nullptr, constants.GetAddressOf())))
+			return false;
+
+		// Outside the atlas counts as lit, each tap is a bilinear 2x2 compare.
+		D3D11_SAMPLER_DESC sd = {};
+		sd.Filter = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
+		sd.AddressU = sd.AddressV = sd.AddressW = D3D11_TEXTURE_ADDRESS_BORDER;
+		sd.BorderColor[0] = sd.BorderColor[1] = sd.BorderColor[2] = sd.BorderColor[3] = 1.0f;
+		sd.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL;
+		sd.MaxLOD = D3D11_FLOAT32_MAX;
+		if (FAILED(dev->CreateSamplerState(&sd, comparison.GetAddressOf())))
+			return false;
+
+		// Slope scaled bias keeps the lit side from shadowing itself. The cascades don't clip depth, so casters
+		// between the light and the cascade's near plane get flattened onto it instead of dropped.
+		D3D11_RASTERIZER_DESC rd = {};
+		rd.FillMode = D3D11_FILL_SOLID;
+		rd.CullMode = D3D11_CULL_BACK;
+		rd.DepthBias = 100;
+		rd.SlopeScaledDepthBias = 2.0f;
+		rd.DepthClipEnable = FALSE;
+		if (FAILED(dev->CreateRasterizerState(&rd, cascadeRasterizer.GetAddressOf())))
+			return false;
+		rd.DepthClipEnable = TRUE;
+		return SUCCEEDED(dev->CreateRasterizerState(&rd, spotRasterizer.GetAddressOf()));
+	}
+
+	ID3D11RasterizerState* Rasterizer(unsigned int map) const
+	{
+		return (map == SHADOW_SPOT_MAP) ? spotRasterizer.Get() : cascadeRasterizer.Get();
+	}
+
+	// Once a frame, after the maps are fitted.
+	void Upload(ID3D11DeviceContext* con, const ShadowConstants& sc)
+	{
+		con->UpdateSubresource(constants.Get(), 0, nullptr, &sc, 0, 0);
+	}
+
+	// t6, s1 and b3 for the pixel shader, see ShadowBuffer in shaders.fx.
+	void Bind(ID3D11DeviceContext* con, ID3D11ShaderResourceView* atlas)
+	{
+		con->PSSetShaderResources(6, 1, &atlas);
+		con->PSSetSamplers(1, 1, comparison.GetAddressOf());
+		con->PSSetConstantBuffers(3, 1, constants.GetAddressOf());
+	}
+
+	// Before drawing into the atlas, so it isn't still bound for reading.
+	static void Unbind(ID3D11DeviceContext* con)
+	{
+		ID3D11ShaderResourceView* none = nullptr;
+		con->PSSetShaderResources(6, 1, &none);
+	}
+};
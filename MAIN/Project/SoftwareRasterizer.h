@@ -0,0 +1,395 @@
+#pragma once
+#include "LightingKernel.h"
+#include "ParallelFor.h"
+#include <DirectXMath.h>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace DirectX;
+
+// What a software draw is shaded with, the fields of Mesh's ConstantBuffer with the matrices untransposed.
+struct SoftwareConstants
+{
+	XMMATRIX world;
+	XMMATRIX view;
+	XMMATRIX projection;
+	XMFLOAT4 lightDir[3];	// Directional light direction, point light position, direction to the spot light
+	XMFLOAT4 lightClr[3];
+	XMFLOAT4 spotLightPos;
+	float cone = 0;
+
+	// Straight from a constant buffer laid out for the shaders (mWorld, mView, mProjection transposed).
+	template <typename ConstantBuffer>
+	static SoftwareConstants FromConstantBuffer(const ConstantBuffer& cb)
+	{
+		SoftwareConstants c;
+		c.world = XMMatrixTranspose(cb.mWorld);
+		c.view = XMMatrixTranspose(cb.mView);
+		c.projection = XMMatrixTranspose(cb.mProjection);
+		for (int i = 0; i < 3; i++)
+		{
+			c.lightDir[i] = cb.lightDir[i];
+			c.lightClr[i] = cb.lightClr[i];
+		}
+		c.spotLightPos = cb.spotLightPos;
+		c.cone = cb.cone;
+		return c;
+	}
+};
+
+// RGBA8 texture, red in the low byte like DXGI_FORMAT_R8G8B8A8_UNORM. Sampled bilinear with wrapping, like samLinear.
+struct SoftwareTexture
+{
+	unsigned int width = 0, height = 0;
+	std::vector<uint32_t> texels;
+
+	XMVECTOR Texel(int x, int y) const
+	{
+		x %= (int)width;
+		y %= (int)height;
+		uint32_t t = texels[(y < 0 ? y + height : y) * width + (x < 0 ? x + width : x)];
+		return XMVectorScale(XMVectorSet((float)(t & 0xFF), (float)((t >> 8) & 0xFF), (float)((t >> 16) & 0xFF), (float)(t >> 24)), 1.0f / 255.0f);
+	}
+
+	XMVECTOR Sample(float u, float v) const
+	{
+		if (texels.empty())
+			return XMVectorSplatOne();
+		float x = u * width - 0.5f, y = v * height - 0.5f;
+		float fx = floorf(x), fy = floorf(y);
+		int x0 = (int)fx, y0 = (int)fy;
+		XMVECTOR top = XMVectorLerp(Texel(x0, y0), Texel(x0 + 1, y0), x - fx);
+		XMVECTOR bottom = XMVectorLerp(Texel(x0, y0 + 1), Texel(x0 + 1, y0 + 1), x - fx);
+		return XMVectorLerp(top, bottom, y - fy);
+	}
+};
+
+// CPU version of drawing the mesh with the fixed three light PSPermutation, for rendering without a GPU.
+// Triangles are binned into screen tiles and the tiles shaded in parallel, 4 pixels at a time for the edge
+// functions and depth test, then lit by LightingKernel in batches. Each tile runs its triangles in submission
+// order, so the image doesn't depend on the thread count. Back faces are culled and depth tested LESS, like the
+// D3D11 defaults the mesh is drawn with.
+class SoftwareRasterizer
+{
+public:
+	static const unsigned int tileSize = 64;
+
+private:
+	// Attributes interpolated with perspective correction, stored divided by w.
+	static const unsigned int attributeCount = 8;	// World position, normal, uv
+
+	struct ClipVertex
+	{
+		XMFLOAT4 clip;
+		float attributes[attributeCount];
+	};
+
+	struct Triangle
+	{
+		XMFLOAT3 edge[3];		// a, b, c of a * x + b * y + c, one per edge, >= 0 inside and already normalized
+		bool topLeft[3];
+		XMFLOAT3 z;				// Screen space plane of depth
+		XMFLOAT3 invW;			// Plane of 1 / w
+		XMFLOAT3 attributes[attributeCount];	// Planes of attribute / w
+		int minX, minY, maxX, maxY;
+	};
+
+	unsigned int width = 0, height = 0;
+	unsigned int tilesX = 0, tilesY = 0;
+	unsigned int threadCount = 0;
+	std::vector<uint32_t> color;
+	std::vector<float> depth;
+	std::vector<ClipVertex> transformed;
+	std::vector<Triangle> triangles;
+	std::vector<std::vector<uint32_t>> bins;
+	const SoftwareTexture* diffuse = nullptr;
+	const SoftwareTexture* normalMap = nullptr;
+	bool lit = true;
+	bool referenceShading = false;
+
+	// Plane through three screen points' values, so v(x, y) = a * x + b * y + c.
+	static XMFLOAT3 Plane(const XMFLOAT3 p[3], float v0, float v1, float v2, float invArea)
+	{
+		float a = ((v1 - v0) * (p[2].y - p[0].y) - (v2 - v0) * (p[1].y - p[0].y)) * invArea;
+		float b = ((v2 - v0) * (p[1].x - p[0].x) - (v1 - v0) * (p[2].x - p[0].x)) * invArea;
+		return XMFLOAT3(a, b, v0 - a * p[0].x - b * p[0].y);
+	}
+
+	// Screen space setup of a triangle that is entirely in front of the near plane, false if it's culled.
+	bool Setup(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, Triangle& tri) const
+	{
+		const ClipVertex* v[3] = { &v0, &v1, &v2 };
+		XMFLOAT3 p[3];
+		float invW[3];
+		for (int i = 0; i < 3; i++)
+		{
+			invW[i] = 1.0f / v[i]->clip.w;
+			p[i].x = (v[i]->clip.x * invW[i] * 0.5f + 0.5f) * width;
+			p[i].y = (0.5f - v[i]->clip.y * invW[i] * 0.5f) * height;
+			p[i].z = v[i]->clip.z * invW[i];
+		}
+
+		// Clockwise on screen is front facing, which comes out positive with y pointing down.
+		float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+		if (!(area > 0.0f))
+			return false;
+
+		float minX = fminf(p[0].x, fminf(p[1].x, p[2].x)), maxX = fmaxf(p[0].x, fmaxf(p[1].x, p[2].x));
+		float minY = fminf(p[0].y, fminf(p[1].y, p[2].y)), maxY = fmaxf(p[0].y, fmaxf(p[1].y, p[2].y));
+		tri.minX = minX < 0.0f ? 0 : (int)minX;
+		tri.minY = minY < 0.0f ? 0 : (int)minY;
+		tri.maxX = maxX > width - 1.0f ? (int)width - 1 : (int)maxX;
+		tri.maxY = maxY > height - 1.0f ? (int)height - 1 : (int)maxY;
+		if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+			return false;
+
+		// Edge i is opposite vertex i, divided by the area so the three give the barycentrics.
+		float invArea = 1.0f / area;
+		for (int i = 0; i < 3; i++)
+		{
+			const XMFLOAT3& a = p[(i + 1) % 3];
+			const XMFLOAT3& b = p[(i + 2) % 3];
+			float dx = b.x - a.x, dy = b.y - a.y;
+			tri.edge[i] = XMFLOAT3(-dy * invArea, dx * invArea, (dy * a.x - dx * a.y) * invArea);
+			// Pixels exactly on an edge belong to the triangle on its top or left side only.
+			tri.topLeft[i] = dy < 0.0f || (dy == 0.0f && dx > 0.0f);
+		}
+
+		tri.z = Plane(p, p[0].z, p[1].z, p[2].z, invArea);
+		tri.invW = Plane(p, invW[0], invW[1], invW[2], invArea);
+		for (unsigned int a = 0; a < attributeCount; a++)
+			tri.attributes[a] = Plane(p, v0.attributes[a] * invW[0], v1.attributes[a] * invW[1], v2.attributes[a] * invW[2], invArea);
+		return true;
+	}
+
+	// The part of a triangle in front of the near plane (z >= 0) as a fan of up to four vertices.
+	static unsigned int ClipNear(const ClipVertex* in[3], ClipVertex out[4])
+	{
+		unsigned int count = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			const ClipVertex& a = *in[i];
+			const ClipVertex& b = *in[(i + 1) % 3];
+			bool aIn = a.clip.z >= 0.0f, bIn = b.clip.z >= 0.0f;
+			if (aIn)
+				out[count++] = a;
+			if (aIn != bIn)
+			{
+				float t = a.clip.z / (a.clip.z - b.clip.z);
+				ClipVertex& c = out[count++];
+				XMStoreFloat4(&c.clip, XMVectorLerp(XMLoadFloat4(&a.clip), XMLoadFloat4(&b.clip), t));
+				for (unsigned int k = 0; k < attributeCount; k++)
+					c.attributes[k] = a.attributes[k] + (b.attributes[k] - a.attributes[k]) * t;
+			}
+		}
+		return count;
+	}
+
+	static uint32_t Pack(FXMVECTOR color)
+	{
+		XMFLOAT4 c;
+		XMStoreFloat4(&c, XMVectorAdd(XMVectorScale(XMVectorSaturate(color), 255.0f), XMVectorReplicate(0.5f)));
+		return (uint32_t)c.x | ((uint32_t)c.y << 8) | ((uint32_t)c.z << 16) | ((uint32_t)c.w << 24);
+	}
+
+	// Every triangle binned to tile t, in order, against the tile's color and depth.
+	void RasterTile(unsigned int t, const LightingParams& lights)
+	{
+		// Lit pixels are shaded in batches, the depth test has already been passed when they are added.
+		LightingFragments batch;
+		unsigned int pixels[LightingFragments::size];
+		unsigned int count = 0;
+		auto flush = [&]()
+		{
+			if (count == 0)
+				return;
+			if (referenceShading)
+				LightingKernel::ShadeReference(lights, batch, count, normalMap != nullptr);
+			else
+				LightingKernel::Shade(lights, batch, count, normalMap != nullptr);
+			for (unsigned int i = 0; i < count; i++)
+				color[pixels[i]] = Pack(XMVectorSet(batch.r[i], batch.g[i], batch.b[i], 1.0f));
+			count = 0;
+		};
+
+		int tileX0 = (int)((t % tilesX) * tileSize), tileY0 = (int)((t / tilesX) * tileSize);
+		int tileX1 = (int)fminf((float)(tileX0 + tileSize), (float)width) - 1;
+		int tileY1 = (int)fminf((float)(tileY0 + tileSize), (float)height) - 1;
+		const XMVECTOR laneOffsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+		const XMVECTOR zero = XMVectorZero();
+
+		for (uint32_t index : bins[t])
+		{
+			const Triangle& tri = triangles[index];
+			int x0 = tri.minX > tileX0 ? tri.minX : tileX0;
+			int x1 = tri.maxX < tileX1 ? tri.maxX : tileX1;
+			int y0 = tri.minY > tileY0 ? tri.minY : tileY0;
+			int y1 = tri.maxY < tileY1 ? tri.maxY : tileY1;
+
+			for (int y = y0; y <= y1; y++)
+			{
+				float py = y + 0.5f;
+				for (int x = x0; x <= x1; x += 4)
+				{
+					XMVECTOR px = XMVectorAdd(XMVectorReplicate((float)x), laneOffsets);
+
+					// Four pixels' edge functions at once, each lane has to be inside all three.
+					XMVECTOR inside = XMVectorTrueInt();
+					XMVECTOR w[3];
+					for (int e = 0; e < 3; e++)
+					{
+						w[e] = XMVectorMultiplyAdd(px, XMVectorReplicate(tri.edge[e].x), XMVectorReplicate(tri.edge[e].y * py + tri.edge[e].z));
+						inside = XMVectorAndInt(inside, tri.topLeft[e] ? XMVectorGreaterOrEqual(w[e], zero) : XMVectorGreater(w[e], zero));
+					}
+					XMVECTOR z = XMVectorMultiplyAdd(px, XMVectorReplicate(tri.z.x), XMVectorReplicate(tri.z.y * py + tri.z.z));
+					inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(z, zero));
+					inside = XMVectorAndInt(inside, XMVectorLessOrEqual(z, XMVectorSplatOne()));
+
+					uint32_t mask[4];
+					XMStoreInt4(mask, inside);
+					XMFLOAT4 zs;
+					XMStoreFloat4(&zs, z);
+					const float* zLane = &zs.x;
+					for (int lane = 0; lane < 4 && x + lane <= x1; lane++)
+					{
+						unsigned int pixel = y * width + x + lane;
+						if (!mask[lane] || !(zLane[lane] < depth[pixel]))
+							continue;
+						depth[pixel] = zLane[lane];
+
+						float fx = x + lane + 0.5f;
+						float w = 1.0f / (tri.invW.x * fx + tri.invW.y * py + tri.invW.z);
+						float attributes[attributeCount];
+						for (unsigned int a = 0; a < attributeCount; a++)
+							attributes[a] = (tri.attributes[a].x * fx + tri.attributes[a].y * py + tri.attributes[a].z) * w;
+						XMVECTOR texColor = diffuse ? diffuse->Sample(attributes[6], attributes[7]) : XMVectorSplatOne();
+						if (!lit)
+						{
+							color[pixel] = Pack(texColor);
+							continue;
+						}
+
+						XMFLOAT4 albedo, map = {};
+						XMStoreFloat4(&albedo, texColor);
+						if (normalMap)
+							XMStoreFloat4(&map, normalMap->Sample(attributes[6], attributes[7]));
+						// The vertex shader hands the world position over as the tangent.
+						batch.posX[count] = batch.tangX[count] = attributes[0];
+						batch.posY[count] = batch.tangY[count] = attributes[1];
+						batch.posZ[count] = batch.tangZ[count] = attributes[2];
+						batch.normX[count] = attributes[3];
+						batch.normY[count] = attributes[4];
+						batch.normZ[count] = attributes[5];
+						batch.mapX[count] = map.x;
+						batch.mapY[count] = map.y;
+						batch.mapZ[count] = map.z;
+						batch.albedoR[count] = albedo.x;
+						batch.albedoG[count] = albedo.y;
+						batch.albedoB[count] = albedo.z;
+						pixels[count++] = pixel;
+						if (count == LightingFragments::size)
+							flush();
+					}
+				}
+			}
+			// A later triangle may cover the same pixels, so its batch can't be shared with this one.
+			flush();
+		}
+	}
+
+public:
+	// threads 0 uses every hardware thread.
+	void Resize(unsigned int _width, unsigned int _height, unsigned int threads = 0)
+	{
+		width = _width;
+		height = _height;
+		threadCount = threads;
+		tilesX = (width + tileSize - 1) / tileSize;
+		tilesY = (height + tileSize - 1) / tileSize;
+		color.assign(width * height, 0);
+		depth.assign(width * height, 1.0f);
+		bins.assign(tilesX * tilesY, std::vector<uint32_t>());
+	}
+
+	void Clear(const float rgba[4])
+	{
+		uint32_t packed = Pack(XMVectorSet(rgba[0], rgba[1], rgba[2], rgba[3]));
+		for (uint32_t& c : color)
+			c = packed;
+		for (float& d : depth)
+			d = 1.0f;
+	}
+
+	// Textures are only pointed at, they have to outlive the draws. Null normalMap is the no normal map variant.
+	void SetTextures(const SoftwareTexture* diffuseTexture, const SoftwareTexture* normalTexture)
+	{
+		diffuse = diffuseTexture;
+		normalMap = normalTexture;
+	}
+
+	// Off gives the unlit texture only variant.
+	void SetLit(bool on) { lit = on; }
+
+	// Shades with LightingKernel's scalar reference instead of the SIMD version, to compare the two.
+	void SetReferenceShading(bool on) { referenceShading = on; }
+
+	// Draws indexed triangles of any vertex with Pos (XMFLOAT4), Normal and UV members, e.g. Mesh::SimpleVertex.
+	template <typename Vertex>
+	void DrawIndexed(const Vertex* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount,
+		const SoftwareConstants& c)
+	{
+		// Vertex stage, the same outputs as the VS entry point.
+		transformed.resize(vertexCount);
+		XMMATRIX viewProjection = c.view * c.projection;
+		ParallelFor(threadCount, vertexCount, 256, [&](unsigned int i)
+		{
+			XMVECTOR world = XMVector4Transform(XMLoadFloat4(&vertices[i].Pos), c.world);
+			XMVECTOR norm = XMVector4Transform(XMVectorSetW(XMLoadFloat3(&vertices[i].Normal), 1.0f), c.world);
+			ClipVertex& out = transformed[i];
+			XMStoreFloat4(&out.clip, XMVector4Transform(world, viewProjection));
+			XMFLOAT3 w, n;
+			XMStoreFloat3(&w, world);
+			XMStoreFloat3(&n, norm);
+			float attributes[attributeCount] = { w.x, w.y, w.z, n.x, n.y, n.z, vertices[i].UV.x, vertices[i].UV.y };
+			for (unsigned int a = 0; a < attributeCount; a++)
+				out.attributes[a] = attributes[a];
+		});
+
+		// Setup and binning stay in submission order.
+		triangles.clear();
+		for (std::vector<uint32_t>& bin : bins)
+			bin.clear();
+		for (unsigned int t = 0; t + 2 < indexCount; t += 3)
+		{
+			const ClipVertex* in[3] = { &transformed[indices[t]], &transformed[indices[t + 1]], &transformed[indices[t + 2]] };
+			ClipVertex clipped[4];
+			unsigned int count = ClipNear(in, clipped);
+			for (unsigned int f = 1; f + 1 < count; f++)
+			{
+				Triangle tri;
+				if (!Setup(clipped[0], clipped[f], clipped[f + 1], tri))
+					continue;
+				uint32_t index = (uint32_t)triangles.size();
+				triangles.push_back(tri);
+				for (unsigned int ty = tri.minY / tileSize; ty <= tri.maxY / tileSize; ty++)
+					for (unsigned int tx = tri.minX / tileSize; tx <= tri.maxX / tileSize; tx++)
+						bins[ty * tilesX + tx].push_back(index);
+			}
+		}
+
+		LightingParams lights = LightingParams::FromConstants(c);
+		ParallelFor(threadCount, tilesX * tilesY, 1, [&](unsigned int t)
+		{
+			RasterTile(t, lights);
+		});
+	}
+
+	unsigned int Width() const { return width; }
+	unsigned int Height() const { return height; }
+
+	// RGBA8 rows top to bottom, red in the low byte.
+	const std::vector<uint32_t>& Color() const { return color; }
+	const std::vector<float>& Depth() const { return depth; }
+};
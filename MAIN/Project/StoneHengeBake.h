@@ -0,0 +1,1466 @@
+// File generated by LightBake (LightBake.cpp), rerun it after changing StoneHenge.h.
+// Per vertex of StoneHenge_data: ambient occlusion, then how much of the sun reaches it from StoneHenge_bakeSunDir.
+#ifndef _StoneHenge_bake_
+const float StoneHenge_bakeSunDir[3] = { -0.577000f, 0.577000f, -0.577000f };
+const float StoneHenge_bake[1457][2] =
+{
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.945312f, 1.000000f },
+	{ 0.886719f, 1.000000f },
+	{ 0.828125f, 0.000000f },
+	{ 0.546875f, 0.000000f },
+	{ 0.957031f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.929688f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.957031f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.937500f, 1.000000f },
+	{ 0.984375f, 1.000000f },
+	{ 0.812500f, 1.000000f },
+	{ 0.949219f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.953125f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.925781f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.894531f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.898438f, 1.000000f },
+	{ 0.914062f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.964844f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.957031f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.851562f, 1.000000f },
+	{ 0.773438f, 1.000000f },
+	{ 0.976562f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.902344f, 1.000000f },
+	{ 0.132812f, 0.000000f },
+	{ 0.773438f, 1.000000f },
+	{ 0.941406f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.921875f, 1.000000f },
+	{ 0.132812f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.960938f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.972656f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.984375f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.542969f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.757812f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.031250f, 0.000000f },
+	{ 0.050781f, 0.000000f },
+	{ 0.890625f, 0.000000f },
+	{ 0.976562f, 0.527778f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.988281f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.527344f, 0.000000f },
+	{ 0.500000f, 0.000000f },
+	{ 0.683594f, 0.000000f },
+	{ 0.746094f, 0.000000f },
+	{ 0.566406f, 0.000000f },
+	{ 0.636719f, 0.000000f },
+	{ 0.445312f, 0.416667f },
+	{ 0.695312f, 0.666667f },
+	{ 0.714844f, 0.000000f },
+	{ 0.902344f, 0.000000f },
+	{ 0.753906f, 0.638889f },
+	{ 0.984375f, 0.527778f },
+	{ 0.554688f, 0.000000f },
+	{ 0.710938f, 0.000000f },
+	{ 0.449219f, 0.000000f },
+	{ 0.710938f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.753906f, 0.000000f },
+	{ 0.750000f, 0.000000f },
+	{ 0.519531f, 0.000000f },
+	{ 0.730469f, 0.000000f },
+	{ 0.484375f, 0.000000f },
+	{ 0.722656f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.750000f, 0.000000f },
+	{ 0.765625f, 0.027778f },
+	{ 0.015625f, 0.000000f },
+	{ 0.929688f, 0.000000f },
+	{ 0.015625f, 0.000000f },
+	{ 0.976562f, 0.000000f },
+	{ 0.738281f, 0.000000f },
+	{ 0.750000f, 0.000000f },
+	{ 0.960938f, 0.000000f },
+	{ 0.984375f, 0.000000f },
+	{ 0.621094f, 0.000000f },
+	{ 0.097656f, 0.000000f },
+	{ 0.792969f, 0.000000f },
+	{ 0.089844f, 0.000000f },
+	{ 0.988281f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.558594f, 0.000000f },
+	{ 0.613281f, 0.000000f },
+	{ 0.375000f, 0.000000f },
+	{ 0.562500f, 0.000000f },
+	{ 0.632812f, 0.000000f },
+	{ 0.785156f, 0.000000f },
+	{ 0.582031f, 0.000000f },
+	{ 0.648438f, 0.000000f },
+	{ 0.714844f, 0.000000f },
+	{ 0.726562f, 0.000000f },
+	{ 0.472656f, 0.000000f },
+	{ 0.546875f, 0.000000f },
+	{ 0.746094f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.769531f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.988281f, 0.555556f },
+	{ 0.000000f, 0.000000f },
+	{ 0.988281f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.558594f, 0.000000f },
+	{ 0.390625f, 0.000000f },
+	{ 0.632812f, 0.000000f },
+	{ 0.527344f, 0.000000f },
+	{ 0.757812f, 0.694444f },
+	{ 0.753906f, 0.000000f },
+	{ 0.511719f, 0.472222f },
+	{ 0.503906f, 0.000000f },
+	{ 0.992188f, 0.500000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.734375f, 0.638889f },
+	{ 0.726562f, 0.000000f },
+	{ 0.691406f, 0.000000f },
+	{ 0.828125f, 0.000000f },
+	{ 0.074219f, 0.000000f },
+	{ 0.062500f, 0.000000f },
+	{ 0.558594f, 0.000000f },
+	{ 0.644531f, 0.000000f },
+	{ 0.675781f, 0.000000f },
+	{ 0.835938f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.843750f, 1.000000f },
+	{ 0.871094f, 1.000000f },
+	{ 0.085938f, 0.000000f },
+	{ 0.804688f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.750000f, 0.000000f },
+	{ 0.078125f, 0.000000f },
+	{ 0.730469f, 0.000000f },
+	{ 0.714844f, 0.000000f },
+	{ 0.066406f, 0.000000f },
+	{ 0.078125f, 0.000000f },
+	{ 0.761719f, 0.000000f },
+	{ 0.816406f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.613281f, 0.888889f },
+	{ 0.835938f, 1.000000f },
+	{ 0.074219f, 0.000000f },
+	{ 0.847656f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.746094f, 0.000000f },
+	{ 0.074219f, 0.000000f },
+	{ 0.800781f, 0.000000f },
+	{ 0.750000f, 0.000000f },
+	{ 0.753906f, 0.000000f },
+	{ 0.679688f, 0.888889f },
+	{ 0.066406f, 0.000000f },
+	{ 0.078125f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.957031f, 1.000000f },
+	{ 0.964844f, 1.000000f },
+	{ 0.062500f, 0.000000f },
+	{ 0.070312f, 0.000000f },
+	{ 0.785156f, 0.000000f },
+	{ 0.675781f, 0.000000f },
+	{ 0.058594f, 0.000000f },
+	{ 0.042969f, 0.000000f },
+	{ 0.875000f, 0.000000f },
+	{ 0.968750f, 1.000000f },
+	{ 0.464844f, 1.000000f },
+	{ 0.460938f, 1.000000f },
+	{ 0.738281f, 1.000000f },
+	{ 0.714844f, 1.000000f },
+	{ 0.605469f, 0.000000f },
+	{ 0.660156f, 1.000000f },
+	{ 0.406250f, 1.000000f },
+	{ 0.652344f, 1.000000f },
+	{ 0.777344f, 1.000000f },
+	{ 0.968750f, 1.000000f },
+	{ 0.773438f, 1.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.535156f, 0.000000f },
+	{ 0.621094f, 0.000000f },
+	{ 0.394531f, 0.000000f },
+	{ 0.574219f, 0.000000f },
+	{ 0.644531f, 0.000000f },
+	{ 0.777344f, 0.000000f },
+	{ 0.566406f, 0.000000f },
+	{ 0.683594f, 0.000000f },
+	{ 0.511719f, 0.000000f },
+	{ 0.664062f, 0.000000f },
+	{ 0.496094f, 1.000000f },
+	{ 0.742188f, 1.000000f },
+	{ 0.687500f, 0.000000f },
+	{ 0.863281f, 0.000000f },
+	{ 0.753906f, 1.000000f },
+	{ 0.968750f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.984375f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.757812f, 1.000000f },
+	{ 0.742188f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.949219f, 1.000000f },
+	{ 0.949219f, 1.000000f },
+	{ 0.683594f, 0.000000f },
+	{ 0.082031f, 0.000000f },
+	{ 0.800781f, 0.000000f },
+	{ 0.078125f, 0.000000f },
+	{ 0.710938f, 1.000000f },
+	{ 0.703125f, 1.000000f },
+	{ 0.457031f, 1.000000f },
+	{ 0.562500f, 0.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.964844f, 1.000000f },
+	{ 0.761719f, 1.000000f },
+	{ 0.730469f, 1.000000f },
+	{ 0.574219f, 0.000000f },
+	{ 0.621094f, 0.000000f },
+	{ 0.347656f, 0.000000f },
+	{ 0.546875f, 0.000000f },
+	{ 0.707031f, 0.000000f },
+	{ 0.816406f, 0.000000f },
+	{ 0.625000f, 0.000000f },
+	{ 0.695312f, 0.000000f },
+	{ 0.949219f, 1.000000f },
+	{ 0.046875f, 0.000000f },
+	{ 0.835938f, 0.000000f },
+	{ 0.035156f, 0.000000f },
+	{ 0.449219f, 1.000000f },
+	{ 0.460938f, 1.000000f },
+	{ 0.695312f, 1.000000f },
+	{ 0.714844f, 1.000000f },
+	{ 0.699219f, 1.000000f },
+	{ 0.664062f, 0.000000f },
+	{ 0.496094f, 1.000000f },
+	{ 0.554688f, 0.000000f },
+	{ 0.757812f, 1.000000f },
+	{ 0.945312f, 1.000000f },
+	{ 0.683594f, 0.000000f },
+	{ 0.824219f, 0.000000f },
+	{ 0.960938f, 1.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.972656f, 1.000000f },
+	{ 0.746094f, 1.000000f },
+	{ 0.980469f, 1.000000f },
+	{ 0.753906f, 1.000000f },
+	{ 0.960938f, 0.000000f },
+	{ 0.042969f, 0.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.027344f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.550781f, 0.000000f },
+	{ 0.449219f, 1.000000f },
+	{ 0.804688f, 0.000000f },
+	{ 0.777344f, 1.000000f },
+	{ 0.519531f, 0.000000f },
+	{ 0.789062f, 0.000000f },
+	{ 0.492188f, 1.000000f },
+	{ 0.789062f, 1.000000f },
+	{ 0.800781f, 0.000000f },
+	{ 0.968750f, 0.000000f },
+	{ 0.816406f, 1.000000f },
+	{ 0.972656f, 1.000000f },
+	{ 0.582031f, 0.000000f },
+	{ 0.796875f, 1.000000f },
+	{ 0.480469f, 1.000000f },
+	{ 0.769531f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.824219f, 1.000000f },
+	{ 0.828125f, 1.000000f },
+	{ 0.546875f, 0.000000f },
+	{ 0.796875f, 1.000000f },
+	{ 0.476562f, 1.000000f },
+	{ 0.796875f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.847656f, 1.000000f },
+	{ 0.816406f, 1.000000f },
+	{ 0.074219f, 0.000000f },
+	{ 0.933594f, 0.000000f },
+	{ 0.054688f, 0.000000f },
+	{ 0.968750f, 1.000000f },
+	{ 0.957031f, 0.000000f },
+	{ 0.812500f, 0.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.828125f, 1.000000f },
+	{ 0.718750f, 0.000000f },
+	{ 0.148438f, 0.000000f },
+	{ 0.886719f, 0.000000f },
+	{ 0.148438f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.714844f, 0.000000f },
+	{ 0.765625f, 0.000000f },
+	{ 0.445312f, 0.000000f },
+	{ 0.562500f, 0.000000f },
+	{ 0.710938f, 0.000000f },
+	{ 0.769531f, 0.000000f },
+	{ 0.804688f, 0.000000f },
+	{ 0.933594f, 0.000000f },
+	{ 0.812500f, 1.000000f },
+	{ 0.792969f, 1.000000f },
+	{ 0.476562f, 1.000000f },
+	{ 0.554688f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.832031f, 1.000000f },
+	{ 0.820312f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.687500f, 0.000000f },
+	{ 0.441406f, 0.000000f },
+	{ 0.789062f, 0.000000f },
+	{ 0.550781f, 0.000000f },
+	{ 0.781250f, 1.000000f },
+	{ 0.792969f, 1.000000f },
+	{ 0.476562f, 1.000000f },
+	{ 0.574219f, 0.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.812500f, 1.000000f },
+	{ 0.812500f, 1.000000f },
+	{ 0.730469f, 0.000000f },
+	{ 0.906250f, 0.000000f },
+	{ 0.164062f, 0.000000f },
+	{ 0.156250f, 0.000000f },
+	{ 0.691406f, 0.000000f },
+	{ 0.824219f, 0.000000f },
+	{ 0.761719f, 0.000000f },
+	{ 0.902344f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.867188f, 0.000000f },
+	{ 0.875000f, 0.000000f },
+	{ 0.125000f, 0.000000f },
+	{ 0.667969f, 0.000000f },
+	{ 0.988281f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.734375f, 1.000000f },
+	{ 0.125000f, 0.000000f },
+	{ 0.796875f, 1.000000f },
+	{ 0.734375f, 0.000000f },
+	{ 0.113281f, 0.000000f },
+	{ 0.734375f, 0.000000f },
+	{ 0.117188f, 0.000000f },
+	{ 0.765625f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.601562f, 0.000000f },
+	{ 0.882812f, 0.000000f },
+	{ 0.125000f, 0.000000f },
+	{ 0.851562f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.746094f, 0.138889f },
+	{ 0.128906f, 0.000000f },
+	{ 0.792969f, 1.000000f },
+	{ 0.730469f, 1.000000f },
+	{ 0.773438f, 0.111111f },
+	{ 0.644531f, 0.000000f },
+	{ 0.121094f, 0.000000f },
+	{ 0.117188f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.984375f, 0.361111f },
+	{ 0.988281f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.976562f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.984375f, 0.000000f },
+	{ 0.984375f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.972656f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.988281f, 0.333333f },
+	{ 1.000000f, 1.000000f },
+	{ 0.968750f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.964844f, 0.000000f },
+	{ 0.980469f, 0.000000f },
+	{ 0.882812f, 0.000000f },
+	{ 0.156250f, 0.000000f },
+	{ 0.726562f, 0.000000f },
+	{ 0.179688f, 0.000000f },
+	{ 0.070312f, 0.000000f },
+	{ 0.050781f, 0.000000f },
+	{ 0.941406f, 0.000000f },
+	{ 0.972656f, 1.000000f },
+	{ 0.523438f, 0.000000f },
+	{ 0.507812f, 1.000000f },
+	{ 0.832031f, 0.000000f },
+	{ 0.839844f, 1.000000f },
+	{ 0.558594f, 0.000000f },
+	{ 0.785156f, 0.000000f },
+	{ 0.472656f, 0.000000f },
+	{ 0.781250f, 0.000000f },
+	{ 0.972656f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.824219f, 0.000000f },
+	{ 0.824219f, 0.000000f },
+	{ 0.558594f, 0.000000f },
+	{ 0.777344f, 0.000000f },
+	{ 0.550781f, 0.000000f },
+	{ 0.671875f, 0.000000f },
+	{ 0.921875f, 0.000000f },
+	{ 0.761719f, 0.000000f },
+	{ 0.792969f, 0.000000f },
+	{ 0.703125f, 0.000000f },
+	{ 0.558594f, 0.000000f },
+	{ 0.777344f, 0.861111f },
+	{ 0.460938f, 1.000000f },
+	{ 0.785156f, 1.000000f },
+	{ 0.816406f, 0.861111f },
+	{ 0.953125f, 0.000000f },
+	{ 0.835938f, 1.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.972656f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.792969f, 0.000000f },
+	{ 0.808594f, 1.000000f },
+	{ 0.984375f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.960938f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.964844f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.714844f, 0.000000f },
+	{ 0.144531f, 0.000000f },
+	{ 0.910156f, 0.000000f },
+	{ 0.121094f, 0.000000f },
+	{ 0.785156f, 0.000000f },
+	{ 0.785156f, 0.000000f },
+	{ 0.453125f, 0.000000f },
+	{ 0.542969f, 0.000000f },
+	{ 0.980469f, 0.000000f },
+	{ 0.976562f, 0.000000f },
+	{ 0.820312f, 0.000000f },
+	{ 0.816406f, 0.000000f },
+	{ 0.542969f, 0.000000f },
+	{ 0.679688f, 0.000000f },
+	{ 0.566406f, 0.000000f },
+	{ 0.773438f, 0.777778f },
+	{ 0.722656f, 0.000000f },
+	{ 0.906250f, 0.000000f },
+	{ 0.718750f, 0.000000f },
+	{ 0.824219f, 0.833333f },
+	{ 0.976562f, 0.000000f },
+	{ 0.050781f, 0.000000f },
+	{ 0.945312f, 0.000000f },
+	{ 0.050781f, 0.000000f },
+	{ 0.820312f, 0.000000f },
+	{ 0.500000f, 0.000000f },
+	{ 0.828125f, 0.000000f },
+	{ 0.523438f, 0.000000f },
+	{ 0.789062f, 0.000000f },
+	{ 0.781250f, 0.000000f },
+	{ 0.472656f, 0.000000f },
+	{ 0.566406f, 0.000000f },
+	{ 0.984375f, 0.000000f },
+	{ 0.957031f, 0.000000f },
+	{ 0.812500f, 0.000000f },
+	{ 0.816406f, 0.000000f },
+	{ 0.957031f, 0.000000f },
+	{ 0.968750f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.796875f, 0.000000f },
+	{ 0.816406f, 0.000000f },
+	{ 0.984375f, 0.000000f },
+	{ 0.980469f, 0.000000f },
+	{ 0.050781f, 0.000000f },
+	{ 0.027344f, 0.000000f },
+	{ 0.937500f, 1.000000f },
+	{ 0.972656f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.746094f, 0.000000f },
+	{ 0.437500f, 0.000000f },
+	{ 0.746094f, 0.000000f },
+	{ 0.437500f, 0.000000f },
+	{ 0.542969f, 0.000000f },
+	{ 0.742188f, 1.000000f },
+	{ 0.464844f, 1.000000f },
+	{ 0.777344f, 1.000000f },
+	{ 0.800781f, 1.000000f },
+	{ 0.937500f, 1.000000f },
+	{ 0.820312f, 1.000000f },
+	{ 0.964844f, 1.000000f },
+	{ 0.542969f, 0.000000f },
+	{ 0.769531f, 1.000000f },
+	{ 0.472656f, 1.000000f },
+	{ 0.757812f, 1.000000f },
+	{ 0.828125f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.828125f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.464844f, 0.000000f },
+	{ 0.781250f, 0.000000f },
+	{ 0.472656f, 0.000000f },
+	{ 0.765625f, 0.000000f },
+	{ 0.800781f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.804688f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.933594f, 0.000000f },
+	{ 0.957031f, 0.000000f },
+	{ 0.058594f, 0.000000f },
+	{ 0.046875f, 0.000000f },
+	{ 0.796875f, 0.000000f },
+	{ 0.820312f, 0.000000f },
+	{ 0.937500f, 0.000000f },
+	{ 0.960938f, 0.000000f },
+	{ 0.730469f, 1.000000f },
+	{ 0.121094f, 0.000000f },
+	{ 0.867188f, 1.000000f },
+	{ 0.113281f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.664062f, 1.000000f },
+	{ 0.734375f, 1.000000f },
+	{ 0.421875f, 1.000000f },
+	{ 0.550781f, 0.000000f },
+	{ 0.722656f, 1.000000f },
+	{ 0.871094f, 1.000000f },
+	{ 0.679688f, 1.000000f },
+	{ 0.781250f, 1.000000f },
+	{ 0.765625f, 1.000000f },
+	{ 0.742188f, 0.000000f },
+	{ 0.476562f, 1.000000f },
+	{ 0.468750f, 0.000000f },
+	{ 0.800781f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.800781f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.625000f, 1.000000f },
+	{ 0.406250f, 1.000000f },
+	{ 0.722656f, 0.000000f },
+	{ 0.437500f, 0.000000f },
+	{ 0.742188f, 1.000000f },
+	{ 0.742188f, 1.000000f },
+	{ 0.445312f, 1.000000f },
+	{ 0.585938f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.824219f, 1.000000f },
+	{ 0.839844f, 1.000000f },
+	{ 0.710938f, 1.000000f },
+	{ 0.863281f, 0.000000f },
+	{ 0.132812f, 0.000000f },
+	{ 0.109375f, 0.000000f },
+	{ 0.714844f, 1.000000f },
+	{ 0.671875f, 1.000000f },
+	{ 0.867188f, 0.000000f },
+	{ 0.777344f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.851562f, 0.000000f },
+	{ 0.871094f, 1.000000f },
+	{ 0.097656f, 0.000000f },
+	{ 0.710938f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.730469f, 1.000000f },
+	{ 0.097656f, 0.000000f },
+	{ 0.757812f, 1.000000f },
+	{ 0.750000f, 1.000000f },
+	{ 0.093750f, 0.000000f },
+	{ 0.105469f, 0.000000f },
+	{ 0.773438f, 1.000000f },
+	{ 0.738281f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.601562f, 0.000000f },
+	{ 0.890625f, 0.000000f },
+	{ 0.097656f, 0.000000f },
+	{ 0.835938f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.765625f, 0.000000f },
+	{ 0.117188f, 0.000000f },
+	{ 0.820312f, 0.000000f },
+	{ 0.718750f, 1.000000f },
+	{ 0.652344f, 0.000000f },
+	{ 0.105469f, 0.000000f },
+	{ 0.808594f, 0.000000f },
+	{ 0.093750f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.984375f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.949219f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.945312f, 0.000000f },
+	{ 0.984375f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.687500f, 0.000000f },
+	{ 0.968750f, 1.000000f },
+	{ 0.964844f, 1.000000f },
+	{ 0.882812f, 1.000000f },
+	{ 0.109375f, 0.000000f },
+	{ 0.707031f, 1.000000f },
+	{ 0.117188f, 0.000000f },
+	{ 0.058594f, 0.000000f },
+	{ 0.035156f, 0.000000f },
+	{ 0.933594f, 0.000000f },
+	{ 0.968750f, 0.000000f },
+	{ 0.757812f, 0.000000f },
+	{ 0.566406f, 0.000000f },
+	{ 0.750000f, 0.000000f },
+	{ 0.539062f, 0.000000f },
+	{ 0.550781f, 0.000000f },
+	{ 0.781250f, 1.000000f },
+	{ 0.484375f, 1.000000f },
+	{ 0.765625f, 1.000000f },
+	{ 0.984375f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.777344f, 1.000000f },
+	{ 0.769531f, 1.000000f },
+	{ 0.570312f, 0.000000f },
+	{ 0.742188f, 1.000000f },
+	{ 0.406250f, 1.000000f },
+	{ 0.636719f, 1.000000f },
+	{ 0.789062f, 1.000000f },
+	{ 0.894531f, 1.000000f },
+	{ 0.660156f, 1.000000f },
+	{ 0.753906f, 1.000000f },
+	{ 0.570312f, 0.000000f },
+	{ 0.730469f, 0.000000f },
+	{ 0.554688f, 0.000000f },
+	{ 0.742188f, 0.000000f },
+	{ 0.937500f, 0.000000f },
+	{ 0.976562f, 0.000000f },
+	{ 0.761719f, 0.000000f },
+	{ 0.789062f, 0.000000f },
+	{ 0.988281f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.761719f, 0.000000f },
+	{ 0.773438f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.968750f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.968750f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.738281f, 1.000000f },
+	{ 0.128906f, 0.000000f },
+	{ 0.875000f, 0.000000f },
+	{ 0.125000f, 0.000000f },
+	{ 0.769531f, 1.000000f },
+	{ 0.757812f, 1.000000f },
+	{ 0.523438f, 0.000000f },
+	{ 0.550781f, 0.000000f },
+	{ 0.785156f, 1.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.781250f, 1.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.644531f, 1.000000f },
+	{ 0.722656f, 0.000000f },
+	{ 0.406250f, 1.000000f },
+	{ 0.558594f, 0.000000f },
+	{ 0.699219f, 1.000000f },
+	{ 0.871094f, 0.000000f },
+	{ 0.671875f, 1.000000f },
+	{ 0.769531f, 0.000000f },
+	{ 0.957031f, 1.000000f },
+	{ 0.671875f, 0.000000f },
+	{ 0.933594f, 1.000000f },
+	{ 0.066406f, 0.000000f },
+	{ 0.765625f, 1.000000f },
+	{ 0.558594f, 0.000000f },
+	{ 0.738281f, 0.000000f },
+	{ 0.566406f, 0.000000f },
+	{ 0.753906f, 1.000000f },
+	{ 0.750000f, 1.000000f },
+	{ 0.457031f, 1.000000f },
+	{ 0.570312f, 0.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.964844f, 1.000000f },
+	{ 0.796875f, 1.000000f },
+	{ 0.792969f, 1.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.972656f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.980469f, 1.000000f },
+	{ 0.769531f, 1.000000f },
+	{ 0.988281f, 0.000000f },
+	{ 0.761719f, 0.000000f },
+	{ 0.062500f, 0.000000f },
+	{ 0.042969f, 0.000000f },
+	{ 0.886719f, 0.000000f },
+	{ 0.968750f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.984375f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.417969f, 1.000000f },
+	{ 0.472656f, 1.000000f },
+	{ 0.703125f, 1.000000f },
+	{ 0.730469f, 1.000000f },
+	{ 0.476562f, 0.000000f },
+	{ 0.722656f, 0.000000f },
+	{ 0.519531f, 0.000000f },
+	{ 0.769531f, 0.000000f },
+	{ 0.757812f, 0.000000f },
+	{ 0.902344f, 0.000000f },
+	{ 0.781250f, 0.000000f },
+	{ 0.980469f, 0.000000f },
+	{ 0.738281f, 0.000000f },
+	{ 0.738281f, 1.000000f },
+	{ 0.468750f, 0.000000f },
+	{ 0.468750f, 1.000000f },
+	{ 0.785156f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.804688f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.457031f, 1.000000f },
+	{ 0.738281f, 1.000000f },
+	{ 0.472656f, 1.000000f },
+	{ 0.734375f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.769531f, 1.000000f },
+	{ 0.765625f, 1.000000f },
+	{ 0.042969f, 0.000000f },
+	{ 0.917969f, 1.000000f },
+	{ 0.046875f, 0.000000f },
+	{ 0.968750f, 1.000000f },
+	{ 0.769531f, 1.000000f },
+	{ 0.785156f, 1.000000f },
+	{ 0.941406f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.667969f, 1.000000f },
+	{ 0.113281f, 0.000000f },
+	{ 0.820312f, 0.000000f },
+	{ 0.097656f, 0.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.613281f, 1.000000f },
+	{ 0.699219f, 0.000000f },
+	{ 0.390625f, 1.000000f },
+	{ 0.460938f, 0.000000f },
+	{ 0.703125f, 1.000000f },
+	{ 0.839844f, 0.000000f },
+	{ 0.636719f, 1.000000f },
+	{ 0.726562f, 0.000000f },
+	{ 0.785156f, 1.000000f },
+	{ 0.792969f, 1.000000f },
+	{ 0.500000f, 1.000000f },
+	{ 0.472656f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.804688f, 1.000000f },
+	{ 0.789062f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.593750f, 1.000000f },
+	{ 0.402344f, 1.000000f },
+	{ 0.699219f, 1.000000f },
+	{ 0.449219f, 1.000000f },
+	{ 0.753906f, 0.000000f },
+	{ 0.753906f, 0.000000f },
+	{ 0.492188f, 0.000000f },
+	{ 0.460938f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.796875f, 0.000000f },
+	{ 0.777344f, 0.000000f },
+	{ 0.664062f, 1.000000f },
+	{ 0.828125f, 1.000000f },
+	{ 0.097656f, 0.000000f },
+	{ 0.097656f, 0.000000f },
+	{ 0.648438f, 1.000000f },
+	{ 0.714844f, 1.000000f },
+	{ 0.695312f, 1.000000f },
+	{ 0.855469f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.835938f, 1.000000f },
+	{ 0.875000f, 0.000000f },
+	{ 0.082031f, 0.000000f },
+	{ 0.734375f, 0.000000f },
+	{ 0.996094f, 0.833333f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.726562f, 1.000000f },
+	{ 0.105469f, 0.000000f },
+	{ 0.781250f, 0.000000f },
+	{ 0.710938f, 0.000000f },
+	{ 0.089844f, 0.000000f },
+	{ 0.085938f, 0.000000f },
+	{ 0.781250f, 0.000000f },
+	{ 0.781250f, 0.000000f },
+	{ 0.988281f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.664062f, 1.000000f },
+	{ 0.859375f, 1.000000f },
+	{ 0.097656f, 0.000000f },
+	{ 0.832031f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.753906f, 1.000000f },
+	{ 0.082031f, 0.000000f },
+	{ 0.769531f, 1.000000f },
+	{ 0.722656f, 1.000000f },
+	{ 0.792969f, 1.000000f },
+	{ 0.707031f, 1.000000f },
+	{ 0.089844f, 0.000000f },
+	{ 0.093750f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.944444f },
+	{ 0.992188f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.805556f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 0.988281f, 0.000000f },
+	{ 0.996094f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 1.000000f, 0.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.996094f, 1.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.972656f, 0.000000f },
+	{ 0.976562f, 0.000000f },
+	{ 0.093750f, 0.000000f },
+	{ 0.128906f, 0.000000f },
+	{ 0.816406f, 0.000000f },
+	{ 0.664062f, 1.000000f },
+	{ 0.050781f, 0.000000f },
+	{ 0.046875f, 0.000000f },
+	{ 0.894531f, 1.000000f },
+	{ 0.964844f, 1.000000f },
+	{ 0.480469f, 1.000000f },
+	{ 0.503906f, 1.000000f },
+	{ 0.773438f, 1.000000f },
+	{ 0.773438f, 1.000000f },
+	{ 0.453125f, 0.000000f },
+	{ 0.753906f, 0.000000f },
+	{ 0.472656f, 0.000000f },
+	{ 0.753906f, 0.000000f },
+	{ 0.773438f, 0.000000f },
+	{ 0.992188f, 0.000000f },
+	{ 0.808594f, 0.000000f },
+	{ 0.988281f, 0.000000f },
+	{ 0.472656f, 0.000000f },
+	{ 0.703125f, 0.000000f },
+	{ 0.421875f, 1.000000f },
+	{ 0.613281f, 1.000000f },
+	{ 0.718750f, 0.000000f },
+	{ 0.824219f, 0.000000f },
+	{ 0.617188f, 1.000000f },
+	{ 0.691406f, 1.000000f },
+	{ 0.718750f, 1.000000f },
+	{ 0.765625f, 1.000000f },
+	{ 0.468750f, 1.000000f },
+	{ 0.500000f, 1.000000f },
+	{ 0.707031f, 1.000000f },
+	{ 0.906250f, 1.000000f },
+	{ 0.777344f, 1.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.984375f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.992188f, 1.000000f },
+	{ 0.789062f, 1.000000f },
+	{ 0.789062f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.968750f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.968750f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.718750f, 1.000000f },
+	{ 0.085938f, 0.000000f },
+	{ 0.839844f, 1.000000f },
+	{ 0.093750f, 0.000000f },
+	{ 0.765625f, 1.000000f },
+	{ 0.746094f, 0.000000f },
+	{ 0.492188f, 1.000000f },
+	{ 0.445312f, 0.000000f },
+	{ 0.789062f, 1.000000f },
+	{ 0.968750f, 1.000000f },
+	{ 0.796875f, 0.000000f },
+	{ 0.972656f, 0.000000f },
+	{ 0.628906f, 1.000000f },
+	{ 0.679688f, 1.000000f },
+	{ 0.421875f, 1.000000f },
+	{ 0.453125f, 1.000000f },
+	{ 0.628906f, 1.000000f },
+	{ 0.718750f, 1.000000f },
+	{ 0.722656f, 1.000000f },
+	{ 0.832031f, 1.000000f },
+	{ 0.964844f, 0.000000f },
+	{ 0.027344f, 0.000000f },
+	{ 0.921875f, 0.000000f },
+	{ 0.050781f, 0.000000f },
+	{ 0.722656f, 1.000000f },
+	{ 0.468750f, 1.000000f },
+	{ 0.738281f, 1.000000f },
+	{ 0.425781f, 1.000000f },
+	{ 0.496094f, 0.000000f },
+	{ 0.777344f, 0.000000f },
+	{ 0.488281f, 0.000000f },
+	{ 0.742188f, 0.000000f },
+	{ 0.980469f, 0.000000f },
+	{ 0.945312f, 0.000000f },
+	{ 0.781250f, 0.000000f },
+	{ 0.761719f, 0.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.000000f, 0.000000f },
+	{ 0.976562f, 1.000000f },
+	{ 0.796875f, 1.000000f },
+	{ 0.988281f, 1.000000f },
+	{ 0.796875f, 1.000000f },
+	{ 0.683594f, 0.000000f },
+	{ 0.644531f, 0.000000f },
+	{ 0.792969f, 0.805556f },
+	{ 0.781250f, 0.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.898438f, 0.250000f },
+	{ 0.851562f, 1.000000f },
+	{ 0.753906f, 0.000000f },
+	{ 0.703125f, 0.000000f },
+	{ 0.664062f, 0.000000f },
+	{ 0.691406f, 0.000000f },
+	{ 0.820312f, 0.000000f },
+	{ 0.816406f, 0.000000f },
+	{ 0.644531f, 0.000000f },
+	{ 0.636719f, 0.000000f },
+	{ 0.789062f, 0.000000f },
+	{ 0.757812f, 0.000000f },
+	{ 0.636719f, 0.000000f },
+	{ 0.781250f, 0.000000f },
+	{ 0.652344f, 0.000000f },
+	{ 0.785156f, 0.000000f },
+	{ 0.683594f, 0.000000f },
+	{ 0.839844f, 1.000000f },
+	{ 0.718750f, 0.000000f },
+	{ 0.878906f, 1.000000f },
+	{ 0.871094f, 1.000000f },
+	{ 0.890625f, 1.000000f },
+	{ 0.753906f, 0.000000f },
+	{ 0.773438f, 0.888889f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 0.250000f },
+	{ 1.000000f, 1.000000f },
+	{ 1.000000f, 1.000000f },
+	{ 0.828125f, 1.000000f },
+	{ 0.820312f, 1.000000f },
+	{ 0.683594f, 0.000000f },
+	{ 0.667969f, 1.000000f },
+	{ 0.625000f, 0.055556f },
+	{ 0.667969f, 0.000000f },
+	{ 0.789062f, 1.000000f },
+	{ 0.808594f, 0.000000f },
+	{ 0.691406f, 0.000000f },
+	{ 0.824219f, 0.000000f },
+	{ 0.687500f, 0.000000f },
+	{ 0.796875f, 0.000000f },
+	{ 0.679688f, 0.055556f },
+	{ 0.820312f, 1.000000f },
+	{ 0.691406f, 0.000000f },
+	{ 0.812500f, 0.000000f },
+	{ 0.867188f, 1.000000f },
+	{ 0.843750f, 1.000000f },
+	{ 0.738281f, 1.000000f },
+	{ 0.664062f, 0.000000f },
+	{ 0.820312f, 1.000000f },
+	{ 0.855469f, 1.000000f },
+	{ 0.695312f, 0.000000f },
+	{ 0.761719f, 0.000000f },
+	{ 0.625000f, 0.000000f },
+	{ 0.785156f, 0.833333f },
+	{ 0.621094f, 0.000000f },
+	{ 0.765625f, 0.000000f },
+	{ 0.660156f, 0.750000f },
+	{ 0.812500f, 1.000000f },
+	{ 0.656250f, 0.000000f },
+	{ 0.800781f, 1.000000f },
+	{ 0.796875f, 1.000000f },
+	{ 0.828125f, 0.222222f },
+	{ 0.660156f, 0.000000f },
+	{ 0.679688f, 0.000000f },
+};
+#define _StoneHenge_bake_
+#endif
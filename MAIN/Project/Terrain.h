@@ -0,0 +1,446 @@
+#pragma once
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Culling.h"
+
+using namespace DirectX;
+
+// Sizes of the terrain. It's a quadtree of square chunks: a lod 0 chunk is chunkSize across, every level up doubles
+// that, and the roots (lod levels - 1) tile the world in a window that follows the camera. Every chunk has the same
+// number of vertices whatever its size, so how many get drawn and cached doesn't depend on where the camera is.
+struct TerrainDesc
+{
+	unsigned int resolution = 32;		// Quads along a chunk side
+	float chunkSize = 4.0f;				// Width of a lod 0 chunk
+	unsigned int levels = 6;			// Roots are chunkSize << (levels - 1) across
+	unsigned int rootRadius = 1;		// Roots drawn on each side of the one the camera is over
+	float splitDistance = 1.0f;			// A chunk splits when the camera is closer than this many of its widths
+	float baseHeight = -3.0f;			// Height of the flat ground around the scene
+	float amplitude = 6.0f;				// Tallest the hills get above and below baseHeight
+	float flatRadius = 12.0f;			// Ground within this distance of the origin stays flat, so the scene stands on it
+	unsigned int cacheChunks = 256;		// Chunks kept at once, CPU and GPU
+	unsigned int workers = 2;			// Threads generating chunks
+	unsigned int acceptPerFrame = 8;	// Finished chunks taken into the cache (and so uploaded) per Update
+
+	float ChunkWidth(unsigned int lod) const { return chunkSize * (float)(1u << lod); }
+	float RootWidth() const { return ChunkWidth(levels - 1); }
+	unsigned int GridVertices() const { return (resolution + 1) * (resolution + 1); }
+	// The grid, then a skirt along each edge hanging down to hide the cracks between chunks of different lods.
+	unsigned int VerticesPerChunk() const { return GridVertices() + 4 * (resolution + 1); }
+	unsigned int TrianglesPerChunk() const { return 2 * resolution * resolution + 4 * 2 * resolution; }
+	unsigned int IndicesPerChunk() const { return 3 * TrianglesPerChunk(); }
+};
+
+// Laid out like Mesh::SimpleVertex so the terrain draws with the mesh's vertex shader and input layout.
+struct TerrainVertex
+{
+	XMFLOAT4 pos;
+	XMFLOAT3 normal;
+	XMFLOAT2 uv;
+	XMFLOAT2 baked;
+};
+
+// Which chunk: lod, and where it is counted in chunks of that lod from the origin.
+struct TerrainKey
+{
+	int32_t x = 0, z = 0;
+	uint32_t lod = 0;
+
+	uint64_t Packed() const { return ((uint64_t)lod << 56) | ((uint64_t)((uint32_t)x & 0xFFFFFFF) << 28) | ((uint32_t)z & 0xFFFFFFF); }
+};
+
+struct TerrainChunk
+{
+	TerrainKey key;
+	std::vector<TerrainVertex> vertices;	// In world space
+	CullAABB bounds;
+	unsigned int slot = 0;					// Where it lives in the cache, and in the vertex buffer on the GPU
+};
+
+// Value noise lattice, the same every run.
+inline float TerrainLattice(int32_t x, int32_t z)
+{
+	uint32_t h = (uint32_t)x * 374761393u + (uint32_t)z * 668265263u;
+	h = (h ^ (h >> 13)) * 1274126177u;
+	h ^= h >> 16;
+	return (float)(h & 0xFFFFFF) / (float)0xFFFFFF * 2.0f - 1.0f;
+}
+
+inline float TerrainNoise(float x, float z)
+{
+	float fx = floorf(x), fz = floorf(z);
+	int32_t ix = (int32_t)fx, iz = (int32_t)fz;
+	float tx = x - fx, tz = z - fz;
+	tx = tx * tx * (3.0f - 2.0f * tx);
+	tz = tz * tz * (3.0f - 2.0f * tz);
+	float a = TerrainLattice(ix, iz) + (TerrainLattice(ix + 1, iz) - TerrainLattice(ix, iz)) * tx;
+	float b = TerrainLattice(ix, iz + 1) + (TerrainLattice(ix + 1, iz + 1) - TerrainLattice(ix, iz + 1)) * tx;
+	return a + (b - a) * tz;
+}
+
+// Ground height at x, z: five octaves of noise, faded out toward the flat middle.
+inline float TerrainHeight(const TerrainDesc& desc, float x, float z)
+{
+	float h = 0.0f, scale = 1.0f / 48.0f, weight = 0.5f;
+	for (int octave = 0; octave < 5; octave++)
+	{
+		h += weight * TerrainNoise(x * scale, z * scale);
+		scale *= 2.0f;
+		weight *= 0.5f;
+	}
+	float d = sqrtf(x * x + z * z);
+	float fade = std::min(std::max((d - desc.flatRadius) / (2.0f * desc.flatRadius), 0.0f), 1.0f);
+	return desc.baseHeight + desc.amplitude * h * fade * fade * (3.0f - 2.0f * fade);
+}
+
+// Grid vertex index for vertex i along edge 0..3 (south, east, north, west), walked so the skirt faces out.
+inline unsigned int TerrainEdgeVertex(const TerrainDesc& desc, unsigned int edge, unsigned int i)
+{
+	unsigned int n = desc.resolution, row = n + 1;
+	switch (edge)
+	{
+	case 0: return i;						// z = 0, +x
+	case 1: return i * row + n;				// x = n, +z
+	case 2: return n * row + (n - i);		// z = n, -x
+	default: return (n - i) * row;			// x = 0, -z
+	}
+}
+
+// The index list every chunk shares, indexing from its own first vertex. Clockwise from above for the grid, and
+// from outside for the skirts.
+inline std::vector<uint16_t> BuildTerrainIndices(const TerrainDesc& desc)
+{
+	unsigned int n = desc.resolution, row = n + 1;
+	std::vector<uint16_t> indices;
+	indices.reserve(desc.IndicesPerChunk());
+	for (unsigned int z = 0; z < n; z++)
+	{
+		for (unsigned int x = 0; x < n; x++)
+		{
+			uint16_t a = (uint16_t)(z * row + x), b = (uint16_t)(a + row), c = (uint16_t)(a + 1), d = (uint16_t)(b + 1);
+			indices.insert(indices.end(), { a, b, c, c, b, d });
+		}
+	}
+	for (unsigned int edge = 0; edge < 4; edge++)
+	{
+		uint16_t skirt = (uint16_t)(desc.GridVertices() + edge * row);
+		for (unsigned int i = 0; i < n; i++)
+		{
+			uint16_t t0 = (uint16_t)TerrainEdgeVertex(desc, edge, i), t1 = (uint16_t)TerrainEdgeVertex(desc, edge, i + 1);
+			uint16_t s0 = (uint16_t)(skirt + i), s1 = (uint16_t)(s0 + 1);
+			indices.insert(indices.end(), { t0, t1, s0, s0, t1, s1 });
+		}
+	}
+	return indices;
+}
+
+// Fills chunk with the heightfield for key. Vertex positions are whole multiples of a power of two step, so chunks
+// side by side at the same lod get bit for bit the same edges.
+inline void BuildTerrainChunk(const TerrainDesc& desc, const TerrainKey& key, TerrainChunk& chunk)
+{
+	unsigned int n = desc.resolution, row = n + 1;
+	float step = desc.ChunkWidth(key.lod) / (float)n;
+	int64_t x0 = (int64_t)key.x * n, z0 = (int64_t)key.z * n;
+
+	chunk.key = key;
+	chunk.vertices.resize(desc.VerticesPerChunk());
+	float low = FLT_MAX, high = -FLT_MAX;
+	for (unsigned int j = 0; j <= n; j++)
+	{
+		for (unsigned int i = 0; i <= n; i++)
+		{
+			float x = (float)(x0 + i) * step, z = (float)(z0 + j) * step;
+			float y = TerrainHeight(desc, x, z);
+			XMFLOAT3 normal(TerrainHeight(desc, x - step, z) - TerrainHeight(desc, x + step, z), 2.0f * step,
+				TerrainHeight(desc, x, z - step) - TerrainHeight(desc, x, z + step));
+			XMStoreFloat3(&normal, XMVector3Normalize(XMLoadFloat3(&normal)));
+
+			TerrainVertex& v = chunk.vertices[j * row + i];
+			v.pos = XMFLOAT4(x, y, z, 1.0f);
+			v.normal = normal;
+			v.uv = XMFLOAT2(x * 0.25f, z * 0.25f);
+			v.baked = XMFLOAT2(1.0f, 1.0f);
+			low = std::min(low, y);
+			high = std::max(high, y);
+		}
+	}
+
+	// Skirts drop a few steps, more than any crack to a coarser neighbour can open up.
+	float skirtDepth = 4.0f * step;
+	for (unsigned int edge = 0; edge < 4; edge++)
+	{
+		for (unsigned int i = 0; i <= n; i++)
+		{
+			TerrainVertex& v = chunk.vertices[desc.GridVertices() + edge * row + i];
+			v = chunk.vertices[TerrainEdgeVertex(desc, edge, i)];
+			v.pos.y -= skirtDepth;
+		}
+	}
+	low -= skirtDepth;
+
+	float width = desc.ChunkWidth(key.lod);
+	chunk.bounds.center = XMFLOAT3(((float)key.x + 0.5f) * width, 0.5f * (low + high), ((float)key.z + 0.5f) * width);
+	chunk.bounds.extents = XMFLOAT3(0.5f * width, 0.5f * (high - low), 0.5f * width);
+}
+
+// Keeps the terrain around a moving camera. Update picks the chunks to draw from the quadtree: a chunk splits into
+// its four children when the camera is near enough, but only once all four are ready, until then the chunk itself
+// is drawn, so there are never holes or overlaps. Missing chunks are generated on worker threads, nearest and
+// coarsest first, and the cache throws out whatever was drawn least recently when it's full.
+// Update and everything reading chunks are for one thread; the workers only ever see their own chunk.
+class TerrainStreamer
+{
+	struct Entry
+	{
+		std::unique_ptr<TerrainChunk> chunk;
+		std::list<uint64_t>::iterator recent;
+		uint64_t used = 0;		// Last Update that drew or walked through it
+	};
+
+	TerrainDesc desc;
+	std::unordered_map<uint64_t, Entry> cache;
+	std::list<uint64_t> recent;				// Most recently used first
+	std::vector<unsigned int> freeSlots;
+	std::vector<const TerrainChunk*> selected;
+	std::vector<std::pair<float, TerrainKey>> wanted;
+	std::unordered_set<uint64_t> inFlight;	// Queued or being generated
+	XMFLOAT3 eye = { 0.0f, 0.0f, 0.0f };
+	uint64_t frame = 0;
+
+	// Shared with the workers.
+	std::mutex lock;
+	std::condition_variable work, idle;
+	std::deque<TerrainKey> queue;
+	std::vector<std::unique_ptr<TerrainChunk>> done;
+	unsigned int busy = 0;
+	bool stopping = false;
+	std::vector<std::thread> workers;
+
+	uint64_t generated = 0, evicted = 0, dropped = 0;
+
+	// Distance from the camera to the chunk's square, at the height of the flat ground.
+	float Distance(const TerrainKey& key) const
+	{
+		float width = desc.ChunkWidth(key.lod);
+		float x0 = (float)key.x * width, z0 = (float)key.z * width;
+		float dx = std::max(std::max(x0 - eye.x, eye.x - (x0 + width)), 0.0f);
+		float dz = std::max(std::max(z0 - eye.z, eye.z - (z0 + width)), 0.0f);
+		float dy = eye.y - desc.baseHeight;
+		return sqrtf(dx * dx + dy * dy + dz * dz);
+	}
+
+	const TerrainChunk* Use(const TerrainKey& key)
+	{
+		auto it = cache.find(key.Packed());
+		if (it == cache.end())
+			return nullptr;
+		recent.splice(recent.begin(), recent, it->second.recent);
+		it->second.used = frame;
+		return it->second.chunk.get();
+	}
+
+	void Want(const TerrainKey& key)
+	{
+		wanted.push_back(std::make_pair(Distance(key), key));
+	}
+
+	void Select(const TerrainKey& key)
+	{
+		const TerrainChunk* chunk = Use(key);
+		if (chunk == nullptr)
+		{
+			Want(key);
+			return;
+		}
+		if (key.lod > 0 && Distance(key) < desc.splitDistance * desc.ChunkWidth(key.lod))
+		{
+			TerrainKey children[4];
+			bool ready = true;
+			for (int c = 0; c < 4; c++)
+			{
+				children[c].x = 2 * key.x + (c & 1);
+				children[c].z = 2 * key.z + (c >> 1);
+				children[c].lod = key.lod - 1;
+				if (cache.find(children[c].Packed()) == cache.end())
+				{
+					Want(children[c]);
+					ready = false;
+				}
+			}
+			if (ready)
+			{
+				for (int c = 0; c < 4; c++)
+					Select(children[c]);
+				return;
+			}
+		}
+		selected.push_back(chunk);
+	}
+
+	// Throws out the least recently used chunk not used this Update, if there is one.
+	bool Evict()
+	{
+		if (recent.empty())
+			return false;
+		auto it = cache.find(recent.back());
+		if (it->second.used == frame)
+			return false;
+		freeSlots.push_back(it->second.chunk->slot);
+		recent.pop_back();
+		cache.erase(it);
+		evicted++;
+		return true;
+	}
+
+	void Accept(std::unique_ptr<TerrainChunk> chunk)
+	{
+		uint64_t packed = chunk->key.Packed();
+		inFlight.erase(packed);
+		if (freeSlots.empty() && !Evict())
+		{
+			dropped++;		// Everything cached is in use, it'll be asked for again
+			return;
+		}
+		chunk->slot = freeSlots.back();
+		freeSlots.pop_back();
+		recent.push_front(packed);
+		Entry& entry = cache[packed];
+		entry.recent = recent.begin();
+		entry.chunk = std::move(chunk);
+		generated++;
+	}
+
+	void Worker()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		for (;;)
+		{
+			work.wait(guard, [this] { return stopping || !queue.empty(); });
+			if (stopping)
+				return;
+			TerrainKey key = queue.front();
+			queue.pop_front();
+			busy++;
+			guard.unlock();
+
+			std::unique_ptr<TerrainChunk> chunk(new TerrainChunk);
+			BuildTerrainChunk(desc, key, *chunk);
+
+			guard.lock();
+			done.push_back(std::move(chunk));
+			busy--;
+			if (queue.empty() && busy == 0)
+				idle.notify_all();
+		}
+	}
+
+public:
+	explicit TerrainStreamer(const TerrainDesc& terrainDesc = TerrainDesc()) : desc(terrainDesc)
+	{
+		for (unsigned int slot = desc.cacheChunks; slot > 0; slot--)
+			freeSlots.push_back(slot - 1);
+	}
+
+	~TerrainStreamer() { Stop(); }
+
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stopping = true;
+		}
+		work.notify_all();
+		for (std::thread& t : workers)
+			t.join();
+		workers.clear();
+		stopping = false;
+	}
+
+	// Takes in finished chunks, picks what to draw from camera, and queues what's missing. Workers start on the first call.
+	void Update(const XMFLOAT3& camera)
+	{
+		if (workers.empty())
+		{
+			for (unsigned int i = 0; i < std::max(desc.workers, 1u); i++)
+				workers.emplace_back([this] { Worker(); });
+		}
+		frame++;
+		eye = camera;
+
+		std::vector<std::unique_ptr<TerrainChunk>> finished;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			unsigned int take = std::min((unsigned int)done.size(), desc.acceptPerFrame);
+			for (unsigned int i = 0; i < take; i++)
+				finished.push_back(std::move(done[i]));
+			done.erase(done.begin(), done.begin() + take);
+		}
+		for (std::unique_ptr<TerrainChunk>& chunk : finished)
+			Accept(std::move(chunk));
+
+		selected.clear();
+		wanted.clear();
+		float root = desc.RootWidth();
+		int32_t cx = (int32_t)floorf(eye.x / root), cz = (int32_t)floorf(eye.z / root);
+		int32_t r = (int32_t)desc.rootRadius;
+		for (int32_t z = cz - r; z <= cz + r; z++)
+		{
+			for (int32_t x = cx - r; x <= cx + r; x++)
+			{
+				TerrainKey key;
+				key.x = x;
+				key.z = z;
+				key.lod = desc.levels - 1;
+				Select(key);
+			}
+		}
+
+		// Coarse before fine so there's always something to draw, then nearest first. Whatever was queued and not
+		// started yet but isn't wanted any more is dropped.
+		std::sort(wanted.begin(), wanted.end(), [](const std::pair<float, TerrainKey>& a, const std::pair<float, TerrainKey>& b)
+			{
+				return a.second.lod != b.second.lod ? a.second.lod > b.second.lod : a.first < b.first;
+			});
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			for (const TerrainKey& key : queue)
+				inFlight.erase(key.Packed());
+			queue.clear();
+			for (const std::pair<float, TerrainKey>& w : wanted)
+			{
+				if (inFlight.insert(w.second.Packed()).second)
+					queue.push_back(w.second);
+			}
+		}
+		work.notify_all();
+	}
+
+	// Blocks until the workers have nothing left to do, for tools that want every chunk there.
+	void WaitIdle()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		idle.wait(guard, [this] { return queue.empty() && busy == 0; });
+	}
+
+	const TerrainDesc& Desc() const { return desc; }
+	// Chunks to draw this frame, they tile the root window once each.
+	const std::vector<const TerrainChunk*>& Selected() const { return selected; }
+	unsigned int Triangles() const { return (unsigned int)selected.size() * desc.TrianglesPerChunk(); }
+	size_t Cached() const { return cache.size(); }
+	size_t Missing() const { return wanted.size(); }
+	uint64_t Generated() const { return generated; }
+	uint64_t Evicted() const { return evicted; }
+	uint64_t Dropped() const { return dropped; }
+	size_t CacheBytes() const { return (size_t)desc.cacheChunks * desc.VerticesPerChunk() * sizeof(TerrainVertex); }
+};
@@ -0,0 +1,147 @@
+#include "Terrain.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Flies a camera across the terrain the way Mesh streams it, one Update a frame, and checks what comes out: the
+// chunks drawn cover the window around the camera exactly once, chunks side by side share their edges, the cache
+// never grows past its size, and the triangle count stays put however far the camera goes. Needs nothing but
+// DirectXMath.
+// TerrainBench [frames] [units per frame]   defaults to 5000 frames at 2 units, 10 km.
+
+// Every lod 0 cell of the root window has to be covered by exactly one drawn chunk.
+static bool CheckCoverage(const TerrainStreamer& terrain, const XMFLOAT3& eye)
+{
+	const TerrainDesc& desc = terrain.Desc();
+	int32_t perRoot = 1 << (desc.levels - 1);
+	int32_t roots = 2 * (int32_t)desc.rootRadius + 1;
+	int32_t side = roots * perRoot;
+	int32_t cx = (int32_t)floorf(eye.x / desc.RootWidth()) - (int32_t)desc.rootRadius;
+	int32_t cz = (int32_t)floorf(eye.z / desc.RootWidth()) - (int32_t)desc.rootRadius;
+	std::vector<uint8_t> cells((size_t)side * side, 0);
+	for (const TerrainChunk* chunk : terrain.Selected())
+	{
+		int32_t span = 1 << chunk->key.lod;
+		int32_t x0 = chunk->key.x * span - cx * perRoot, z0 = chunk->key.z * span - cz * perRoot;
+		for (int32_t z = z0; z < z0 + span; z++)
+		{
+			for (int32_t x = x0; x < x0 + span; x++)
+			{
+				if (x < 0 || z < 0 || x >= side || z >= side || cells[(size_t)z * side + x]++)
+					return false;
+			}
+		}
+	}
+	for (uint8_t c : cells)
+	{
+		if (c != 1)
+			return false;
+	}
+	return true;
+}
+
+// Drawn chunks of the same lod that touch must have exactly the same vertices along the shared edge.
+static bool CheckSeams(const TerrainStreamer& terrain)
+{
+	const TerrainDesc& desc = terrain.Desc();
+	unsigned int n = desc.resolution, row = n + 1;
+	std::unordered_map<uint64_t, const TerrainChunk*> byKey;
+	for (const TerrainChunk* chunk : terrain.Selected())
+		byKey[chunk->key.Packed()] = chunk;
+	for (const TerrainChunk* chunk : terrain.Selected())
+	{
+		TerrainKey east = chunk->key, north = chunk->key;
+		east.x++;
+		north.z++;
+		auto e = byKey.find(east.Packed()), no = byKey.find(north.Packed());
+		for (unsigned int i = 0; i <= n; i++)
+		{
+			if (e != byKey.end() && memcmp(&chunk->vertices[i * row + n].pos, &e->second->vertices[i * row].pos, sizeof(XMFLOAT4)) != 0)
+				return false;
+			if (no != byKey.end() && memcmp(&chunk->vertices[n * row + i].pos, &no->second->vertices[i].pos, sizeof(XMFLOAT4)) != 0)
+				return false;
+		}
+	}
+	return true;
+}
+
+// Updates until nothing is missing, with the workers finishing everything in between.
+static void Settle(TerrainStreamer& terrain, const XMFLOAT3& eye)
+{
+	do
+	{
+		terrain.Update(eye);
+		terrain.WaitIdle();
+	} while (terrain.Missing() > 0);
+	terrain.Update(eye);
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int frames = (argc > 1) ? (unsigned int)atoi(argv[1]) : 5000;
+	float speed = (argc > 2) ? (float)atof(argv[2]) : 2.0f;
+
+	TerrainDesc desc;
+	TerrainStreamer terrain(desc);
+	bool ok = true;
+
+	// Standing still with everything generated: full coverage, no seams.
+	XMFLOAT3 eye(0.0f, 2.0f, -10.0f);
+	auto start = std::chrono::high_resolution_clock::now();
+	Settle(terrain, eye);
+	double settleMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	bool covered = CheckCoverage(terrain, eye), seams = CheckSeams(terrain);
+	ok &= covered && seams;
+	printf("start     %zu chunks, %u triangles, %llu generated in %.1f ms, %s, %s\n", terrain.Selected().size(), terrain.Triangles(),
+		(unsigned long long)terrain.Generated(), settleMs, covered ? "covered once" : "COVERAGE WRONG", seams ? "seams match" : "SEAMS DIFFER");
+
+	// The same chunk built twice is the same, so anything evicted comes back unchanged.
+	TerrainChunk a, b;
+	TerrainKey key;
+	key.x = -7;
+	key.z = 3;
+	key.lod = 2;
+	BuildTerrainChunk(desc, key, a);
+	BuildTerrainChunk(desc, key, b);
+	ok &= memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(TerrainVertex)) == 0;
+
+	// Fly off diagonally, climbing and dropping, one Update a frame without waiting on the workers. A millisecond's
+	// sleep stands in for the rest of the frame, which the workers get to use.
+	size_t maxSelected = 0, maxCached = 0;
+	unsigned int maxTriangles = 0, framesMissing = 0;
+	double updateMs = 0.0, worstMs = 0.0;
+	for (unsigned int f = 0; f < frames; f++)
+	{
+		eye.x += speed * 0.8f;
+		eye.z += speed * 0.6f;
+		eye.y = 2.0f + 20.0f * (0.5f + 0.5f * sinf(f * 0.01f));
+		auto t = std::chrono::high_resolution_clock::now();
+		terrain.Update(eye);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t).count();
+		updateMs += ms;
+		worstMs = std::max(worstMs, ms);
+		maxSelected = std::max(maxSelected, terrain.Selected().size());
+		maxTriangles = std::max(maxTriangles, terrain.Triangles());
+		maxCached = std::max(maxCached, terrain.Cached());
+		framesMissing += terrain.Missing() > 0 ? 1 : 0;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ok &= maxCached <= desc.cacheChunks;
+	printf("flight    %u frames, %.0f units: update %.3f ms avg, %.3f ms worst, %u frames still streaming\n",
+		frames, frames * speed, updateMs / std::max(frames, 1u), worstMs, framesMissing);
+	printf("bounded   at most %zu chunks and %u triangles drawn, %zu of %u cached (%.1f MB), %llu generated, %llu evicted, %llu dropped, %s\n",
+		maxSelected, maxTriangles, maxCached, desc.cacheChunks, terrain.CacheBytes() / (1024.0 * 1024.0),
+		(unsigned long long)terrain.Generated(), (unsigned long long)terrain.Evicted(), (unsigned long long)terrain.Dropped(),
+		maxCached <= desc.cacheChunks ? "within the cache" : "OVER THE CACHE");
+
+	// Far away, once it's caught up, it's just as whole as at the start.
+	Settle(terrain, eye);
+	covered = CheckCoverage(terrain, eye);
+	seams = CheckSeams(terrain);
+	ok &= covered && seams;
+	printf("end       at %.0f, %.0f: %zu chunks, %u triangles, %s, %s\n", eye.x, eye.z, terrain.Selected().size(), terrain.Triangles(),
+		covered ? "covered once" : "COVERAGE WRONG", seams ? "seams match" : "SEAMS DIFFER");
+	return ok ? 0 : 1;
+}
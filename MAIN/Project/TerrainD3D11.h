@@ -0,0 +1,72 @@
+#pragma once
+#include "defines.h"
+#include "Terrain.h"
+#include <wrl/client.h>
+
+// One vertex buffer with a slot for every chunk the cache can hold, made once, so the terrain's GPU memory is fixed
+// from the start. A chunk is copied into its slot the first time it's drawn there; every chunk shares one index list.
+class D3D11TerrainResources
+{
+	Microsoft::WRL::ComPtr<ID3D11Buffer>		vertices = nullptr;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>		indices = nullptr;
+	std::vector<uint64_t>						inSlot;		// Packed key of the chunk each slot holds
+	unsigned int								verticesPerChunk = 0;
+	unsigned int								indexCount = 0;
+	static const uint64_t						emptySlot = ~0ull;
+
+public:
+	bool Create(ID3D11Device* dev, const TerrainDesc& desc)
+	{
+		verticesPerChunk = desc.VerticesPerChunk();
+		inSlot.assign(desc.cacheChunks, emptySlot);
+
+		D3D11_BUFFER_DESC bd = {};
+		bd.Usage = D3D11_USAGE_DEFAULT;
+		bd.ByteWidth = sizeof(TerrainVertex) * verticesPerChunk * desc.cacheChunks;
+		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		if (FAILED(dev->CreateBuffer(&bd, nullptr, vertices.GetAddressOf())))
+			return false;
+
+		std::vector<uint16_t> list = BuildTerrainIndices(desc);
+		indexCount = (unsigned int)list.size();
+		bd.Usage = D3D11_USAGE_IMMUTABLE;
+		bd.ByteWidth = sizeof(uint16_t) * indexCount;
+		bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		D3D11_SUBRESOURCE_DATA InitData = {};
+		InitData.pSysMem = list.data();
+		return SUCCEEDED(dev->CreateBuffer(&bd, &InitData, indices.GetAddressOf()));
+	}
+
+	// Copies in the chunks whose slot holds something else. Returns how many were copied.
+	unsigned int Upload(ID3D11DeviceContext* con, const std::vector<const TerrainChunk*>& chunks)
+	{
+		unsigned int copied = 0;
+		for (const TerrainChunk* chunk : chunks)
+		{
+			uint64_t key = chunk->key.Packed();
+			if (inSlot[chunk->slot] == key)
+				continue;
+			UINT bytes = sizeof(TerrainVertex) * verticesPerChunk;
+			D3D11_BOX box = { chunk->slot * bytes, 0, 0, (chunk->slot + 1) * bytes, 1, 1 };
+			con->UpdateSubresource(vertices.Get(), 0, &box, chunk->vertices.data(), 0, 0);
+			inSlot[chunk->slot] = key;
+			copied++;
+		}
+		return copied;
+	}
+
+	void Bind(ID3D11DeviceContext* con)
+	{
+		const UINT stride[] = { sizeof(TerrainVertex) };
+		const UINT offset[] = { 0 };
+		ID3D11Buffer* const buffs[] = { vertices.Get() };
+		con->IASetVertexBuffers(0, 1, buffs, stride, offset);
+		con->IASetIndexBuffer(indices.Get(), DXGI_FORMAT_R16_UINT, 0);
+	}
+
+	// The chunk has to have been uploaded this frame or before.
+	void Draw(ID3D11DeviceContext* con, const TerrainChunk& chunk)
+	{
+		con->DrawIndexed(indexCount, 0, chunk.slot * verticesPerChunk);
+	}
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Hands the newest T from one writer thread to one reader thread, neither one ever waits on the other. Of the
+// three slots the writer fills its back one and swaps it for the middle one, and the reader swaps its front one
+// for the middle one when something newer is there. Anything the reader didn't get to in time is skipped.
+template <typename T>
+class TripleBuffer
+{
+	static const uint32_t fresh = 4;	// Set on middle while it holds a slot the reader hasn't seen
+
+	T slots[3];
+	std::atomic<uint32_t> middle{ 1 };
+	uint32_t back = 0;					// Only touched by the writer
+	uint32_t front = 2;					// Only touched by the reader
+
+public:
+	// Writer: the slot to fill. It still holds whatever was in it last time round, so containers keep their memory.
+	T& Back() { return slots[back]; }
+
+	// Writer: hands the back slot to the reader and takes another one to fill.
+	void Publish()
+	{
+		back = middle.exchange(back | fresh, std::memory_order_acq_rel) & 3;
+	}
+
+	// Reader: moves on to the newest published slot, false if nothing's been published since the last time.
+	bool Acquire()
+	{
+		if (!(middle.load(std::memory_order_relaxed) & fresh))
+			return false;
+		front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+		return true;
+	}
+
+	// Reader: the slot it's on, default constructed until the first Acquire.
+	const T& Front() const { return slots[front]; }
+};
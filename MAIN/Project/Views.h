@@ -0,0 +1,78 @@
+#pragma once
+#include "defines.h"
+#include "RenderGraph.h"
+#include "ClusteredLighting.h"
+
+// Which parts of the scene a view wants submitted.
+enum ViewDrawFlags : unsigned int
+{
+	VIEW_DRAW_MESH		= 1 << 0,
+	VIEW_DRAW_ROCKS		= 1 << 1,	// The instanced rock copies of the mesh
+	VIEW_DRAW_LIGHTS	= 1 << 2,
+	VIEW_DRAW_SKYBOX	= 1 << 3,
+	VIEW_DRAW_GRID		= 1 << 4,
+	VIEW_DRAW_RTT_CUBE	= 1 << 5,
+	VIEW_DRAW_ALL		= 0xFFFFFFFF
+};
+
+// Everything that gets animated once per frame, every view of that frame draws from the same copy.
+struct SceneSnapshot
+{
+	XMMATRIX world;
+	XMFLOAT4 lightDir[3];
+	XMFLOAT4 lightClr[3];
+	XMFLOAT4 spotlightPos;
+	float cone = 0;
+	float time = 0;		// Drives the grid wave
+	float pulse = 0;	// Drives the unique pixel shader, 0 -> 1
+};
+
+// The lights and times alpha of the way from a to b, for drawing between two simulation steps. The times jump
+// straight to b's when they wrapped around in between. The world matrix is b's.
+inline SceneSnapshot BlendSnapshots(const SceneSnapshot& a, const SceneSnapshot& b, float alpha)
+{
+	SceneSnapshot s = b;
+	for (int i = 0; i < 3; i++)
+	{
+		XMStoreFloat4(&s.lightDir[i], XMVectorLerp(XMLoadFloat4(&a.lightDir[i]), XMLoadFloat4(&b.lightDir[i]), alpha));
+		XMStoreFloat4(&s.lightClr[i], XMVectorLerp(XMLoadFloat4(&a.lightClr[i]), XMLoadFloat4(&b.lightClr[i]), alpha));
+	}
+	XMStoreFloat4(&s.spotlightPos, XMVectorLerp(XMLoadFloat4(&a.spotlightPos), XMLoadFloat4(&b.spotlightPos), alpha));
+	s.cone = a.cone + (b.cone - a.cone) * alpha;
+	if (b.time >= a.time)
+		s.time = a.time + (b.time - a.time) * alpha;
+	if (b.pulse >= a.pulse)
+		s.pulse = a.pulse + (b.pulse - a.pulse) * alpha;
+	return s;
+}
+
+// Everything one frame draws that the update thread moves, see Mesh::Simulate. It's built in a TripleBuffer slot
+// and only read by the render thread once it's been handed over.
+struct FrameSnapshot
+{
+	uint64_t number = 0;		// Counts up by one per snapshot, 0 until the first one
+	SceneSnapshot scene;
+	XMMATRIX camera;			// The camera's world matrix, the view matrix is its inverse
+	XMMATRIX projection;
+	float nearP = 0.01f, farP = 100.0f;
+	std::vector<ClusterLight> lights;							// LightManager::Packed()
+	std::vector<std::pair<uint32_t, uint32_t>> lightRuns;		// Slots that changed since the snapshot before
+	int32_t spotSlot = -1;		// The spot light's index into lights
+};
+
+// A single camera into the scene snapshot, every view becomes a pass in the frame's render graph.
+struct RenderView
+{
+	const char* name = "View";
+	D3D11_VIEWPORT viewport = {};
+	XMMATRIX view;
+	XMMATRIX projection;
+	RGResource target = RG_INVALID;		// Graph texture the view draws into
+	RGResource depth = RG_INVALID;		// Graph depth texture, RG_INVALID for the swap chain's
+	RGResource sampled = RG_INVALID;	// Graph texture shown on the RTT cube, if the cube is visible
+	bool clearTarget = false;
+	float clearColor[4] = { 0, 0, 0, 1 };
+	bool clearDepth = false;
+	unsigned int drawFlags = VIEW_DRAW_ALL;
+	unsigned int visibleMask = 0;		// Culling results for this view, one bit per scene object
+};
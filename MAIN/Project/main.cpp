@@ -2,6 +2,7 @@
 
 #include "DrawClass.h"
 #include "StoneHenge.h"
+#include "StoneHengeBake.h"
 
 using namespace GW;
 using namespace CORE;
@@ -36,6 +37,10 @@ void ReadModel(Mesh::SimpleMesh& mesh)
 			(StoneHenge_data[i].nrm[1]),
 			(StoneHenge_data[i].nrm[2]) };
 
+		// Ambient occlusion & sun visibility, made by LightBake
+		vert.Baked = { StoneHenge_bake[i][0],
+			StoneHenge_bake[i][1] };
+
 		// Push the Vertex Back into the mesh.
 		mesh.vertexList.push_back(vert);
 	}
@@ -45,6 +50,9 @@ void ReadModel(Mesh::SimpleMesh& mesh)
 	{
 		mesh.indicesList.push_back(StoneHenge_indicies[i]);
 	}
+
+	mesh.baked = true;
+	mesh.bakedSunDir = { StoneHenge_bakeSunDir[0], StoneHenge_bakeSunDir[1], StoneHenge_bakeSunDir[2] };
 }
 
 void PrintInstructions()
@@ -61,12 +69,43 @@ void PrintInstructions()
 		<< "(HOLD) T\\G - Controls Near Plane [T moves it outwards, G inwards.]\n"
 		<< "(HOLD) Y\\H - Controls Far Plane [Y moves it inwards, H outwards.]\n\t[While holding Y, press 6 to instantly set to 10.0f if farP > 10.0f, a MSG will print out.]\n"
 		<< "R - Resets Zoom & Clipping Planes\n"
+		<< "P - Toggles the depth pre-pass\n"
+		<< "O - Prints the mesh's overdraw from the main camera\n"
+		<< "N - Toggles normal mapping on the mesh\n"
+		<< "I - Toggles the mesh's baked ambient occlusion & sun visibility\n"
+		<< "K - Cycles clustered lighting on the mesh (off, 64, 256, 1024 extra lights)\n"
+		<< "B - Toggles shadows from the directional and spot lights\n"
+		<< "U - Toggles dynamic resolution, the main view renders smaller when frames run long\n"
+		<< "X - Toggles recording the shadow maps on worker threads\n"
+		<< "[\\] - Halves and doubles the grid's resolution\n"
+		<< "V - Swaps the wave grid for the streamed terrain\n"
+		<< "F - Pauses the animation, . steps it once while paused\n"
+		<< "-\\= - Halves and doubles the animation speed\n"
 		<< "~~~~~~~~~~ERRORS BELOW THIS LINE~~~~~~~~~~\n\n";
 }
 
 // lets pop a window and use D3D11 to clear to a green screen
-int main()
+int main(int argc, char** argv)
 {
+	// Offline step, fills Shaders/Cache so the next launch doesn't have to compile anything.
+	// -record <file> saves every frame's length on exit, -replay <file> times the frames from one of those,
+	// so the animation runs exactly the same steps again. -serial animates on the render thread between frames
+	// instead of on its own thread during them.
+	const char* recordPath = nullptr;
+	const char* replayPath = nullptr;
+	bool serial = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-buildshadercache") == 0)
+			return DrawClass::BuildShaderCache() ? 0 : 1;
+		if (strcmp(argv[i], "-record") == 0 && i + 1 < argc)
+			recordPath = argv[++i];
+		else if (strcmp(argv[i], "-replay") == 0 && i + 1 < argc)
+			replayPath = argv[++i];
+		else if (strcmp(argv[i], "-serial") == 0)
+			serial = true;
+	}
+
 	if (+win.Create(0, 0, 800, 600, GWindowStyle::WINDOWEDBORDERED))
 	{
 		win.SetWindowName("DEV4_Project");
@@ -109,6 +148,12 @@ int main()
 
 			//Triangle tri(d3d11, win);
 			Mesh stoneHenge(d3d11, win, &mesh, L"Textures\\StoneHenge.dds", L"Textures\\StoneHengeNM.dds");
+			if (recordPath != nullptr)
+				stoneHenge.Clock().StartRecording();
+			if (replayPath != nullptr && !stoneHenge.Clock().LoadReplay(replayPath))
+				std::cout << "Couldn't read frame times from " << replayPath << "\n";
+			if (!serial)
+				stoneHenge.StartUpdateThread();
 
 			while (+win.ProcessWindowEvents())
 			{
@@ -135,6 +180,10 @@ int main()
 					swap->Release();
 				}
 			}
+
+			stoneHenge.StopUpdateThread();
+			if (recordPath != nullptr && !stoneHenge.Clock().SaveRecording(recordPath))
+				std::cout << "Couldn't save frame times to " << recordPath << "\n";
 		}
 	}
 	return 0;